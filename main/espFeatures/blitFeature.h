@@ -0,0 +1,98 @@
+#pragma once
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+#include <jac/machine/values.h>
+
+#include "../util/blitter.h"
+
+#include <string>
+
+
+template<class Next>
+class BlitFeature : public Next {
+    Blitter _blitter;
+
+    BlitImage imageFromObject(jac::ObjectWeak obj, const char* name) {
+        auto buffer = obj.get<jac::Value>("buffer");
+        size_t size;
+        uint8_t* raw = JS_GetArrayBuffer(this->context(), &size, buffer.getVal());
+        if (!raw) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, std::string("blit: ") + name + ".buffer must be an ArrayBuffer");
+        }
+
+        BlitImage image{
+            raw,
+            obj.get<int>("width"),
+            obj.get<int>("height"),
+            obj.hasProperty("format") ? obj.get<int>("format") : 10
+        };
+
+        size_t bytesPerPixel = packedColorSize(image.format);
+        if (image.width <= 0 || image.height <= 0 || bytesPerPixel == 0
+            || static_cast<size_t>(image.width) * image.height * bytesPerPixel > size) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, std::string("blit: ") + name + " buffer too small or invalid format");
+        }
+        return image;
+    }
+
+    static BlitOptions optionsFromObject(jac::ObjectWeak obj) {
+        BlitOptions opts;
+        auto optInt = [&](const char* key, int& out) {
+            if (obj.hasProperty(key)) {
+                out = obj.get<int>(key);
+            }
+        };
+        optInt("sx", opts.sx);
+        optInt("sy", opts.sy);
+        optInt("sw", opts.sw);
+        optInt("sh", opts.sh);
+        optInt("x", opts.dx);
+        optInt("y", opts.dy);
+        optInt("width", opts.dw);
+        optInt("height", opts.dh);
+        optInt("scale", opts.scale);
+        optInt("rotation", opts.rotation);
+        if (obj.hasProperty("flipX")) {
+            opts.flipX = obj.get<bool>("flipX");
+        }
+        if (obj.hasProperty("flipY")) {
+            opts.flipY = obj.get<bool>("flipY");
+        }
+        if (obj.hasProperty("colorKey")) {
+            auto key = obj.get<uint32_t>("colorKey");
+            opts.useColorKey = true;
+            opts.colorKey = DisplayColor{
+                static_cast<uint8_t>((key >> 16) & 0xFF),
+                static_cast<uint8_t>((key >> 8) & 0xFF),
+                static_cast<uint8_t>(key & 0xFF),
+                255
+            };
+        }
+        return opts;
+    }
+
+public:
+    void initialize() {
+        Next::initialize();
+
+        jac::FunctionFactory ff(this->context());
+        jac::Module& mod = this->newModule("blit");
+
+        mod.addExport("blit", ff.newFunctionVariadic([this](std::vector<jac::ValueWeak> args) {
+            if (args.size() < 2) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "blit: Expected at least 2 arguments (dst, src, [options])");
+            }
+
+            BlitImage dst = imageFromObject(args[0].to<jac::ObjectWeak>(), "dst");
+            BlitImage src = imageFromObject(args[1].to<jac::ObjectWeak>(), "src");
+            BlitOptions opts;
+            if (args.size() > 2 && !args[2].isUndefined()) {
+                opts = optionsFromObject(args[2].to<jac::ObjectWeak>());
+            }
+
+            return static_cast<int>(_blitter.blit(dst, src, opts));
+        }));
+    }
+};
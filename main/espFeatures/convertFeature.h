@@ -8,6 +8,7 @@
 template<class Next>
 class ConvertFeature : public Next {
     std::optional<jac::Function> toStdVectorConvertor;
+    std::optional<jac::Function> toFloat64Convertor;
     std::optional<jac::Function> toArrayBufferConvertor;
 
 public:
@@ -16,6 +17,11 @@ public:
         return toStdVectorConvertor->call<jac::Value>(res);
     }
 
+    jac::Value toFloat64Array(const std::vector<double>& data) {
+        auto res = jac::ArrayBuffer::create(this->context(), std::span(data));
+        return toFloat64Convertor->call<jac::Value>(res);
+    }
+
     std::vector<uint8_t> toStdVector(jac::Value data) {
         std::vector<uint8_t> dataVec;
         if (JS_IsString(data.getVal())) {
@@ -33,6 +39,7 @@ public:
     void initialize() {
         Next::initialize();
         toStdVectorConvertor.emplace(jac::Function::from(this->context(), this->eval("(b) => new Uint8Array(b)", "<util::toUint8Array>")));
+        toFloat64Convertor.emplace(jac::Function::from(this->context(), this->eval("(b) => new Float64Array(b)", "<util::toFloat64Array>")));
         toArrayBufferConvertor.emplace(jac::Function::from(this->context(), this->eval(
         "(d) => {"
             "if (d instanceof ArrayBuffer) return d;"
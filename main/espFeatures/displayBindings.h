@@ -2,16 +2,32 @@
 #include "../util/iDisplayHolder.h"
 #include "jac/device/logger.h"
 #include "jac/machine/internal/declarations.h"
-#include "renderer/rendererFeature.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <format>
+#include <string>
+#include <unordered_map>
 #include <jac/machine/class.h>
 #include <jac/machine/functionFactory.h>
 #include <vector>
 
 template <typename THolder> class DisplayProtoBindings {
+    // Delta mode state of each display object, the shadow frame lives here
+    // rather than in the holder as only the bindings diff frames
+    static inline std::unordered_map<const IDisplayHolder *, FrameDelta>
+        _deltas;
+
   public:
+    static FrameDelta &frameDelta(const IDisplayHolder *holder) {
+        return _deltas[holder];
+    }
+
+    // Called from destroyOpaque before the holder is deleted
+    static void release(const IDisplayHolder *holder) {
+        _deltas.erase(holder);
+    }
+
     static void addCommonProperties(jac::ContextRef ctx, jac::Object proto) {
         jac::FunctionFactory ff(ctx);
 
@@ -21,8 +37,10 @@ template <typename THolder> class DisplayProtoBindings {
                 auto *holder = static_cast<IDisplayHolder *>(
                     jac::ProtoBuilder::Opaque<THolder>::getOpaque(ctx,
                                                                   thisVal));
-                if (holder)
+                if (holder) {
                     holder->clear();
+                    frameDelta(holder).reset();
+                }
             }),
             jac::PropFlags::Enumerable);
 
@@ -51,6 +69,25 @@ template <typename THolder> class DisplayProtoBindings {
                 }),
             jac::PropFlags::Enumerable);
 
+        proto.defineProperty(
+            "getLayout",
+            ff.newFunctionThis(
+                [](jac::ContextRef ctx, jac::ValueWeak thisVal) -> jac::Value {
+                    auto *holder = static_cast<IDisplayHolder *>(
+                        jac::ProtoBuilder::Opaque<THolder>::getOpaque(ctx,
+                                                                      thisVal));
+                    if (!holder)
+                        return jac::Value::undefined(ctx);
+                    DisplayLayout layout = holder->nativeLayout();
+                    auto obj = jac::Object::create(ctx);
+                    obj.set("width", layout.width);
+                    obj.set("height", layout.height);
+                    obj.set("format", layout.format);
+                    obj.set("stride", static_cast<int>(layout.stride));
+                    return obj;
+                }),
+            jac::PropFlags::Enumerable);
+
         proto.defineProperty(
             "setBuffer",
             ff.newFunctionThisVariadic([](jac::ContextRef ctx,
@@ -81,10 +118,48 @@ template <typename THolder> class DisplayProtoBindings {
                 size_t readSize =
                     (size >= 0 && size <= maxBytes) ? size : maxBytes;
 
+                DisplayLayout layout = holder->nativeLayout();
+                size_t pixelSize = packedColorSize(format);
+                size_t stride = pixelSize * layout.width;
+                FrameDelta &delta = frameDelta(holder);
+                if (delta.enabled() && pixelSize > 0 &&
+                    readSize >= stride * layout.height) {
+                    bool full = delta.diff(raw, layout.width, layout.height,
+                                           format, pixelSize);
+                    if (!full) {
+                        holder->setRegions(raw, stride, format,
+                                           delta.regions());
+                        return;
+                    }
+                } else {
+                    delta.reset();
+                }
+
                 holder->setBuffer(raw, readSize, format, clearPrev);
             }),
             jac::PropFlags::Enumerable);
 
+        proto.defineProperty(
+            "setDeltaMode",
+            ff.newFunctionThisVariadic([](jac::ContextRef ctx,
+                                          jac::ValueWeak thisVal,
+                                          std::vector<jac::ValueWeak> args) {
+                auto *holder = static_cast<IDisplayHolder *>(
+                    jac::ProtoBuilder::Opaque<THolder>::getOpaque(ctx,
+                                                                  thisVal));
+                if (!holder || args.empty())
+                    return;
+
+                FrameDelta &delta = frameDelta(holder);
+                delta.setEnabled(args[0].to<bool>());
+                if (args.size() > 1 && !args[1].isUndefined()) {
+                    float threshold = args[1].to<double>();
+                    delta.fullFrameThreshold =
+                        std::clamp(threshold, 0.0f, 1.0f);
+                }
+            }),
+            jac::PropFlags::Enumerable);
+
         proto.defineProperty(
             "setBufferRaw",
             ff.newFunctionThisVariadic([](jac::ContextRef ctx,
@@ -126,8 +201,67 @@ template <typename THolder> class DisplayProtoBindings {
                     parsedPixels.push_back({x, y, color});
                 }
 
+                frameDelta(holder).reset();
                 holder->setBufferFromRaw(parsedPixels, clearPrev);
             }),
             jac::PropFlags::Enumerable);
+
+        proto.defineProperty(
+            "setPixels",
+            ff.newFunctionThisVariadic([](jac::ContextRef ctx,
+                                          jac::ValueWeak thisVal,
+                                          std::vector<jac::ValueWeak> args) {
+                auto *holder = static_cast<IDisplayHolder *>(
+                    jac::ProtoBuilder::Opaque<THolder>::getOpaque(ctx,
+                                                                  thisVal));
+                if (!holder || args.empty())
+                    return;
+
+                // Uint32Array views are read in place, a plain ArrayBuffer
+                // is taken whole
+                size_t offset = 0;
+                size_t length = 0;
+                size_t elementSize = 4;
+                uint8_t *raw = nullptr;
+                JSValue bufferVal = JS_GetTypedArrayBuffer(
+                    ctx, args[0].getVal(), &offset, &length, &elementSize);
+                if (JS_IsException(bufferVal)) {
+                    JS_FreeValue(ctx, JS_GetException(ctx));
+                    raw = JS_GetArrayBuffer(ctx, &length, args[0].getVal());
+                } else {
+                    jac::Value buffer(ctx, bufferVal);
+                    size_t size;
+                    raw = JS_GetArrayBuffer(ctx, &size, buffer.getVal());
+                }
+                if (!raw)
+                    JS_FreeValue(ctx, JS_GetException(ctx));
+                if (!raw || elementSize != 4 || offset % 4 != 0) {
+                    jac::Logger::error(
+                        "Display: setPixels expects a Uint32Array");
+                    return;
+                }
+
+                PixelRecordLayout layout = PixelRecordLayout::Index;
+                if (args.size() > 1 && !args[1].isUndefined()) {
+                    auto name = args[1].to<std::string>();
+                    if (name == "xy") {
+                        layout = PixelRecordLayout::XY;
+                    } else if (name != "index") {
+                        jac::Logger::error(std::format(
+                            "Display: Unknown pixel record layout '{}'",
+                            name));
+                        return;
+                    }
+                }
+                bool clearPrev = (args.size() > 2) ? args[2].to<bool>() : true;
+
+                size_t count =
+                    length / (4 * DisplayUtils::recordWords(layout));
+                frameDelta(holder).reset();
+                holder->setPixels(
+                    reinterpret_cast<const uint32_t *>(raw + offset), count,
+                    layout, clearPrev);
+            }),
+            jac::PropFlags::Enumerable);
     }
 };
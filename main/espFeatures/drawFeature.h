@@ -0,0 +1,516 @@
+#pragma once
+
+#include "rendererFeature.h"
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+#include <jac/machine/values.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+
+/**
+ * Immediate-mode drawing on a packed framebuffer in any format supported by packedColorSize.
+ *
+ * Colors are packed once per call and the inner loops only copy the packed bytes,
+ * so no intermediate RGBA grid is involved. All primitives are clipped to the clip rectangle.
+ */
+class Surface {
+    uint8_t* m_data = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+    int m_format = 0;
+    size_t m_bpp = 0;
+
+    // Clip rectangle, right and bottom edges are exclusive
+    int m_clipX0 = 0;
+    int m_clipY0 = 0;
+    int m_clipX1 = 0;
+    int m_clipY1 = 0;
+
+    struct Packed {
+        uint8_t bytes[4];
+    };
+
+    Packed pack(Color color) const {
+        Packed packed{};
+        writePixelBytes(packed.bytes, m_format, color);
+        return packed;
+    }
+
+    uint8_t* at(int x, int y) const {
+        return m_data + (static_cast<size_t>(y) * m_width + x) * m_bpp;
+    }
+
+    /**
+     * @brief Call op with the pixel size as a compile-time constant
+     */
+    template<typename Op>
+    void withBpp(Op op) const {
+        switch (m_bpp) {
+        case 1: op.template operator()<1>(); break;
+        case 2: op.template operator()<2>(); break;
+        case 3: op.template operator()<3>(); break;
+        case 4: op.template operator()<4>(); break;
+        }
+    }
+
+    template<size_t BPP>
+    static void fillSpan(uint8_t* dst, int count, const Packed& px) {
+        if constexpr (BPP == 1) {
+            std::memset(dst, px.bytes[0], count);
+        } else {
+            // Seed one pixel and keep doubling the filled prefix
+            size_t total = static_cast<size_t>(count) * BPP;
+            std::memcpy(dst, px.bytes, BPP);
+            size_t filled = BPP;
+            while (filled < total) {
+                size_t n = std::min(filled, total - filled);
+                std::memcpy(dst + filled, dst, n);
+                filled += n;
+            }
+        }
+    }
+
+    void fillClipped(int x, int y, int w, int h, const Packed& px) {
+        int x0 = std::max(x, m_clipX0);
+        int y0 = std::max(y, m_clipY0);
+        int x1 = std::min(x + w, m_clipX1);
+        int y1 = std::min(y + h, m_clipY1);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+
+        withBpp([&]<size_t BPP>() {
+            uint8_t* row = at(x0, y0);
+            size_t stride = static_cast<size_t>(m_width) * BPP;
+            fillSpan<BPP>(row, x1 - x0, px);
+            // Further rows copy the first one instead of refilling it
+            size_t rowBytes = static_cast<size_t>(x1 - x0) * BPP;
+            for (int yy = y0 + 1; yy < y1; ++yy) {
+                std::memcpy(row + stride * (yy - y0), row, rowBytes);
+            }
+        });
+    }
+
+    bool inClip(int x, int y) const {
+        return x >= m_clipX0 && x < m_clipX1 && y >= m_clipY0 && y < m_clipY1;
+    }
+
+public:
+    Surface() = default;
+
+    Surface(uint8_t* data, int width, int height, int format):
+        m_data(data), m_width(width), m_height(height), m_format(format), m_bpp(packedColorSize(format))
+    {
+        resetClip();
+    }
+
+    bool valid() const { return m_data != nullptr && m_bpp != 0 && m_width > 0 && m_height > 0; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int format() const { return m_format; }
+    size_t bytesPerPixel() const { return m_bpp; }
+    size_t frameBytes() const { return static_cast<size_t>(m_width) * m_height * m_bpp; }
+    uint8_t* data() const { return m_data; }
+
+    void setClip(int x, int y, int w, int h) {
+        m_clipX0 = std::clamp(x, 0, m_width);
+        m_clipY0 = std::clamp(y, 0, m_height);
+        m_clipX1 = std::clamp(x + w, m_clipX0, m_width);
+        m_clipY1 = std::clamp(y + h, m_clipY0, m_height);
+    }
+
+    void resetClip() {
+        m_clipX0 = 0;
+        m_clipY0 = 0;
+        m_clipX1 = m_width;
+        m_clipY1 = m_height;
+    }
+
+    void clear(Color color) {
+        fillClipped(0, 0, m_width, m_height, pack(color));
+    }
+
+    void pixel(int x, int y, Color color) {
+        if (!inClip(x, y))
+            return;
+        Packed px = pack(color);
+        std::memcpy(at(x, y), px.bytes, m_bpp);
+    }
+
+    void fillRect(int x, int y, int w, int h, Color color) {
+        fillClipped(x, y, w, h, pack(color));
+    }
+
+    void rect(int x, int y, int w, int h, Color color) {
+        if (w <= 0 || h <= 0)
+            return;
+        Packed px = pack(color);
+        fillClipped(x, y, w, 1, px);
+        fillClipped(x, y + h - 1, w, 1, px);
+        fillClipped(x, y + 1, 1, h - 2, px);
+        fillClipped(x + w - 1, y + 1, 1, h - 2, px);
+    }
+
+    void hline(int x, int y, int length, Color color) {
+        fillClipped(x, y, length, 1, pack(color));
+    }
+
+    void vline(int x, int y, int length, Color color) {
+        fillClipped(x, y, 1, length, pack(color));
+    }
+
+    void line(int x0, int y0, int x1, int y1, Color color) {
+        if (y0 == y1) {
+            fillClipped(std::min(x0, x1), y0, std::abs(x1 - x0) + 1, 1, pack(color));
+            return;
+        }
+        if (x0 == x1) {
+            fillClipped(x0, std::min(y0, y1), 1, std::abs(y1 - y0) + 1, pack(color));
+            return;
+        }
+
+        Packed px = pack(color);
+        withBpp([&]<size_t BPP>() {
+            int dx = std::abs(x1 - x0);
+            int dy = -std::abs(y1 - y0);
+            int sx = x0 < x1 ? 1 : -1;
+            int sy = y0 < y1 ? 1 : -1;
+            int err = dx + dy;
+
+            while (true) {
+                if (inClip(x0, y0)) {
+                    std::memcpy(at(x0, y0), px.bytes, BPP);
+                }
+                if (x0 == x1 && y0 == y1)
+                    break;
+                int e2 = 2 * err;
+                if (e2 >= dy) {
+                    err += dy;
+                    x0 += sx;
+                }
+                if (e2 <= dx) {
+                    err += dx;
+                    y0 += sy;
+                }
+            }
+        });
+    }
+
+    void circle(int cx, int cy, int radius, Color color, bool fill) {
+        if (radius < 0)
+            return;
+
+        Packed px = pack(color);
+        int x = radius;
+        int y = 0;
+        int err = 1 - radius;
+
+        // Midpoint circle, filled circles are drawn as horizontal spans
+        while (x >= y) {
+            if (fill) {
+                fillClipped(cx - x, cy + y, 2 * x + 1, 1, px);
+                fillClipped(cx - x, cy - y, 2 * x + 1, 1, px);
+                fillClipped(cx - y, cy + x, 2 * y + 1, 1, px);
+                fillClipped(cx - y, cy - x, 2 * y + 1, 1, px);
+            } else {
+                const int points[8][2] = {
+                    { cx + x, cy + y }, { cx - x, cy + y }, { cx + x, cy - y }, { cx - x, cy - y },
+                    { cx + y, cy + x }, { cx - y, cy + x }, { cx + y, cy - x }, { cx - y, cy - x },
+                };
+                for (auto& p : points) {
+                    if (inClip(p[0], p[1])) {
+                        std::memcpy(at(p[0], p[1]), px.bytes, m_bpp);
+                    }
+                }
+            }
+
+            y++;
+            if (err < 0) {
+                err += 2 * y + 1;
+            } else {
+                x--;
+                err += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Copy a rectangle from a source buffer in the same format
+     * @param src Source pixels
+     * @param srcWidth Width of the source buffer in pixels
+     * @param srcHeight Height of the source buffer in pixels
+     * @param sx Left edge of the source rectangle
+     * @param sy Top edge of the source rectangle
+     * @param w Width of the copied rectangle
+     * @param h Height of the copied rectangle
+     * @param dx Destination x
+     * @param dy Destination y
+     */
+    void blit(const uint8_t* src, int srcWidth, int srcHeight, int sx, int sy, int w, int h, int dx, int dy) {
+        // Clip against the source
+        if (sx < 0) { dx -= sx; w += sx; sx = 0; }
+        if (sy < 0) { dy -= sy; h += sy; sy = 0; }
+        w = std::min(w, srcWidth - sx);
+        h = std::min(h, srcHeight - sy);
+
+        // Clip against the destination
+        if (dx < m_clipX0) { sx += m_clipX0 - dx; w -= m_clipX0 - dx; dx = m_clipX0; }
+        if (dy < m_clipY0) { sy += m_clipY0 - dy; h -= m_clipY0 - dy; dy = m_clipY0; }
+        w = std::min(w, m_clipX1 - dx);
+        h = std::min(h, m_clipY1 - dy);
+        if (w <= 0 || h <= 0)
+            return;
+
+        size_t rowBytes = static_cast<size_t>(w) * m_bpp;
+        size_t srcStride = static_cast<size_t>(srcWidth) * m_bpp;
+        const uint8_t* srcRow = src + (static_cast<size_t>(sy) * srcWidth + sx) * m_bpp;
+        // Moving down within one buffer must start at the bottom so no source row is overwritten before it is read
+        if (at(dx, dy) > srcRow) {
+            for (int y = h - 1; y >= 0; --y) {
+                std::memmove(at(dx, dy + y), srcRow + srcStride * y, rowBytes);
+            }
+            return;
+        }
+        for (int y = 0; y < h; ++y) {
+            std::memmove(at(dx, dy + y), srcRow, rowBytes);
+            srcRow += srcStride;
+        }
+    }
+
+    template<typename DrawText>
+    void text(DrawText drawText, Color color) {
+        Packed px = pack(color);
+        drawText([&](int x, int y) {
+            if (inClip(x, y)) {
+                std::memcpy(at(x, y), px.bytes, m_bpp);
+            }
+        });
+    }
+};
+
+
+class Canvas {
+    jac::Value m_buffer;
+    int m_width;
+    int m_height;
+    int m_format;
+    std::unique_ptr<::Renderer> m_textRenderer;
+
+    // Clip rectangle kept across calls, the surface itself is rebuilt each call
+    int m_clip[4];
+    bool m_clipped = false;
+
+public:
+    Canvas(jac::Value buffer, int width, int height, int format):
+        m_buffer(std::move(buffer)), m_width(width), m_height(height), m_format(format), m_clip{ 0, 0, width, height }
+    {}
+
+    /**
+     * @brief Get a surface over the current buffer contents
+     *
+     * The data pointer is looked up on every call, so a detached buffer is caught
+     * instead of being written through a stale pointer.
+     */
+    Surface surface(jac::ContextRef ctx) {
+        size_t size;
+        uint8_t* raw = JS_GetArrayBuffer(ctx, &size, m_buffer.getVal());
+        Surface surface(raw, m_width, m_height, m_format);
+        if (!raw || !surface.valid() || surface.frameBytes() > size) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "Canvas: ArrayBuffer too small or invalid format");
+        }
+        if (m_clipped) {
+            surface.setClip(m_clip[0], m_clip[1], m_clip[2], m_clip[3]);
+        }
+        return surface;
+    }
+
+    void setClip(int x, int y, int w, int h) {
+        m_clip[0] = x;
+        m_clip[1] = y;
+        m_clip[2] = w;
+        m_clip[3] = h;
+        m_clipped = true;
+    }
+
+    void resetClip() {
+        m_clipped = false;
+    }
+
+    /**
+     * @brief Renderer used only to lay out glyphs
+     *
+     * drawText reports every glyph pixel through its callback and needs the width only for wrapping,
+     * so the renderer keeps a single-row grid.
+     */
+    ::Renderer* textRenderer() {
+        if (!m_textRenderer) {
+            m_textRenderer = std::make_unique<::Renderer>(m_width, 1);
+        }
+        return m_textRenderer.get();
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int format() const { return m_format; }
+};
+
+
+class CanvasProtoBuilder : public jac::ProtoBuilder::Opaque<Canvas>, public jac::ProtoBuilder::Properties {
+public:
+    static Canvas* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        if (args.size() < 3) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "Expected at least 3 arguments (buffer, width, height, [format])");
+        }
+
+        int width = args[1].to<int>();
+        int height = args[2].to<int>();
+        int format = (args.size() > 3 && !args[3].isUndefined()) ? args[3].to<int>() : 10;
+
+        size_t size;
+        uint8_t* raw = JS_GetArrayBuffer(ctx, &size, args[0].getVal());
+        size_t bytesPerPixel = packedColorSize(format);
+        if (!raw) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "Canvas: Invalid ArrayBuffer passed");
+        }
+        if (width <= 0 || height <= 0 || bytesPerPixel == 0 || static_cast<size_t>(width) * height * bytesPerPixel > size) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "Canvas: ArrayBuffer too small or invalid format");
+        }
+
+        return new Canvas(args[0], width, height, format);
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("clear", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).clear(color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("pixel", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).pixel(x, y, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("fillRect", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, int w, int h, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).fillRect(x, y, w, h, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("rect", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, int w, int h, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).rect(x, y, w, h, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("hline", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, int length, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).hline(x, y, length, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("vline", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, int length, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).vline(x, y, length, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("line", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x0, int y0, int x1, int y1, Color color) {
+            getOpaque(ctx, thisVal)->surface(ctx).line(x0, y0, x1, y1, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("circle", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.size() < 4) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Canvas.circle: Missing arguments (x, y, radius, color, [fill])");
+            }
+            bool fill = args.size() > 4 && args[4].to<bool>();
+            getOpaque(ctx, thisVal)->surface(ctx).circle(args[0].to<int>(), args[1].to<int>(), args[2].to<int>(), jac::fromValue<Color>(ctx, args[3]), fill);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("blit", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.size() < 5) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Canvas.blit: Missing arguments (src, srcWidth, srcHeight, x, y, [sx, sy, sw, sh])");
+            }
+
+            Surface surface = getOpaque(ctx, thisVal)->surface(ctx);
+
+            size_t srcSize;
+            uint8_t* src = JS_GetArrayBuffer(ctx, &srcSize, args[0].getVal());
+            int srcWidth = args[1].to<int>();
+            int srcHeight = args[2].to<int>();
+            if (!src || srcWidth <= 0 || srcHeight <= 0 || static_cast<size_t>(srcWidth) * srcHeight * surface.bytesPerPixel() > srcSize) {
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "Canvas.blit: Source ArrayBuffer too small");
+            }
+
+            auto optInt = [&](size_t i, int def) {
+                return (args.size() > i && !args[i].isUndefined()) ? args[i].to<int>() : def;
+            };
+            int sx = optInt(5, 0);
+            int sy = optInt(6, 0);
+            int sw = optInt(7, srcWidth);
+            int sh = optInt(8, srcHeight);
+
+            surface.blit(src, srcWidth, srcHeight, sx, sy, sw, sh, args[3].to<int>(), args[4].to<int>());
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("text", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.size() < 5) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Canvas.text: Missing arguments (text, x, y, font, color, [wrap])");
+            }
+
+            Canvas* self = getOpaque(ctx, thisVal);
+            Surface surface = self->surface(ctx);
+
+            std::string text = args[0].to<std::string>();
+            int x = args[1].to<int>();
+            int y = args[2].to<int>();
+            Font* fontPtr = args[3].isUndefined() ? nullptr : FontProtoBuilder::unwrap(ctx, args[3]);
+            const Font& font = (fontPtr != nullptr) ? *fontPtr : defaultFont;
+            Color color = jac::fromValue<Color>(ctx, args[4]);
+            bool wrap = args.size() > 5 && args[5].to<bool>();
+
+            ::Renderer* renderer = self->textRenderer();
+            surface.text([&](auto put) {
+                renderer->drawText(text, x, y, font, color, wrap, 0, [&](int px, int py, const Color&) {
+                    put(px, py);
+                });
+            }, color);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setClip", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y, int w, int h) {
+            getOpaque(ctx, thisVal)->setClip(x, y, w, h);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("resetClip", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            getOpaque(ctx, thisVal)->resetClip();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getWidth", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return jac::Value::from(ctx, getOpaque(ctx, thisVal)->width());
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getHeight", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return jac::Value::from(ctx, getOpaque(ctx, thisVal)->height());
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getFormat", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return jac::Value::from(ctx, getOpaque(ctx, thisVal)->format());
+        }), jac::PropFlags::Enumerable);
+    }
+};
+
+
+template<class Next>
+class DrawFeature : public Next {
+public:
+    using CanvasClass = jac::Class<CanvasProtoBuilder>;
+
+    DrawFeature() {
+        CanvasClass::init("Canvas");
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        jac::Module& mod = this->newModule("draw");
+        mod.addExport("Canvas", CanvasClass::getConstructor(this->context()));
+    }
+};
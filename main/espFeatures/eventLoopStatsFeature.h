@@ -0,0 +1,83 @@
+#pragma once
+
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+#include <jac/machine/values.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "quickjs.h"
+
+#include "freeRTOSEventQueue.h"
+
+
+template<class Next>
+class EventLoopStatsFeature : public Next {
+public:
+    void initialize() {
+        Next::initialize();
+
+        using Stats = typename Next::EventStats;
+
+        jac::FunctionFactory ff(this->context());
+        jac::Module& mod = this->newModule("eventloop");
+
+        mod.addExport("getStats", ff.newFunctionVariadic([this](std::vector<jac::ValueWeak> args) -> jac::Value {
+            std::array<uint32_t, Stats::SIZE> snapshot;
+            this->eventStats().snapshot(snapshot.data());
+
+            // Reuse the caller's buffer when given, so polling does not allocate
+            if (!args.empty() && !args[0].isUndefined()) {
+                size_t size;
+                uint8_t* raw = JS_GetArrayBuffer(this->context(), &size, args[0].getVal());
+                if (!raw || size < sizeof(snapshot)) {
+                    throw jac::Exception::create(jac::Exception::Type::TypeError, "getStats: ArrayBuffer too small");
+                }
+                std::memcpy(raw, snapshot.data(), sizeof(snapshot));
+                return jac::Value(this->context(), JS_DupValue(this->context(), args[0].getVal()));
+            }
+            return jac::ArrayBuffer::create(this->context(), std::span<uint32_t>(snapshot));
+        }));
+
+        mod.addExport("getStatSources", ff.newFunction([this]() {
+            auto names = EventSource::statNames();
+            jac::Array arr = jac::Array::create(this->context());
+            for (size_t i = 0; i < names.size(); ++i) {
+                arr.set(i, std::string(names[i]));
+            }
+            return arr;
+        }));
+
+        mod.addExport("resetStats", ff.newFunction([this]() {
+            this->eventStats().reset();
+        }));
+
+        mod.addExport("streamStats", ff.newFunction([this](int intervalMs) {
+            this->streamEventStats(std::chrono::milliseconds(std::max(intervalMs, 0)));
+        }));
+
+        // Indices into the Uint32Array view of getStats()
+        auto laneIndex = [](EventLane lane) { return static_cast<int>(1 + static_cast<size_t>(lane) * Stats::LANE_FIELDS); };
+        jac::Object statObj = jac::Object::create(this->context());
+        statObj.set("EVENTS", 0);
+        statObj.set("REALTIME", laneIndex(EventLane::RealTime));
+        statObj.set("TIMER", laneIndex(EventLane::Timer));
+        statObj.set("NORMAL", laneIndex(EventLane::Normal));
+        statObj.set("BULK", laneIndex(EventLane::Bulk));
+        statObj.set("LANE_FIELDS", static_cast<int>(Stats::LANE_FIELDS));
+        statObj.set("BUCKETS", static_cast<int>(Stats::BUCKETS));
+        statObj.set("SOURCES", static_cast<int>(Stats::SOURCE_OFFSET));
+        statObj.set("SOURCE_FIELDS", static_cast<int>(Stats::SOURCE_FIELDS));
+        statObj.set("SOURCE_COUNT", static_cast<int>(Stats::SOURCES));
+        statObj.set("SLOW", static_cast<int>(Stats::SLOW_OFFSET));
+        statObj.set("SLOW_FIELDS", static_cast<int>(Stats::SLOW_FIELDS));
+        statObj.set("SIZE", static_cast<int>(Stats::SIZE));
+        mod.addExport("EventStat", statObj);
+    }
+};
@@ -0,0 +1,582 @@
+#pragma once
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+#include <jac/machine/values.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spiFeature.h"
+#include "../util/displayTypes.h"
+
+
+namespace hub75bridge {
+
+    // Framing expected by the RP2040 HUB75 bridge, see ts-examples/src/renderer/spiSender.ts
+    static constexpr uint16_t SYNC_WORDS[] = {
+        0xac92, 0x3bca, 0x41bf, 0x393d, 0xa74a, 0xae01, 0x155d, 0xfb70,
+        0xf681, 0x2f6d, 0x4931, 0x0fa3, 0x77bf, 0xd756, 0x26f9, 0x4eb6,
+    };
+    static constexpr uint8_t MODE_MAGIC = 0xfb;
+
+    inline std::vector<uint8_t> buildSync() {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(sizeof(SYNC_WORDS));
+        for (auto word : SYNC_WORDS) {
+            buffer.push_back(word & 0xFF);
+            buffer.push_back(word >> 8);
+        }
+        return buffer;
+    }
+
+    inline std::array<uint8_t, 8> buildModeset(int width, int format, int brightness) {
+        return {
+            MODE_MAGIC, 0, static_cast<uint8_t>(format), static_cast<uint8_t>(brightness),
+            static_cast<uint8_t>(width & 0xFF), static_cast<uint8_t>(width >> 8), 0, 0
+        };
+    }
+
+} // namespace hub75bridge
+
+
+enum class PresenterFraming {
+    Raw,
+    Hub75Bridge,
+};
+
+struct PresenterOptions {
+    int cs;
+    int width;
+    int height;
+    int format;
+    int buffers;
+    bool qio;
+    bool dropStale;
+    int brightness;
+    PresenterFraming framing;
+    std::chrono::microseconds minInterval;
+};
+
+struct PresenterStats {
+    uint32_t presented = 0;
+    uint32_t transmitted = 0;
+    uint32_t dropped = 0;
+    uint32_t errors = 0;
+    int64_t lastTxUs = 0;
+    int64_t maxTxUs = 0;
+    int64_t totalTxUs = 0;
+    int64_t lastIntervalUs = 0;
+    int64_t maxIntervalUs = 0;
+};
+
+
+template<class Feature>
+class FramePresenter {
+    enum class BufferState {
+        Free,
+        Acquired,
+        Queued,
+        Sending,
+    };
+
+    struct Buffer {
+        jac::Value js;
+        uint8_t* data;
+        size_t size;
+        size_t used;
+        BufferState state;
+    };
+
+    struct PendingAcquire {
+        jac::Function resolve;
+        jac::Function reject;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    Feature* _feature;
+    SPI* _spi;
+    jac::Value _spiRef;
+    PresenterOptions _options;
+    std::vector<uint8_t> _sync;
+    std::atomic<int> _brightness;
+
+    std::vector<Buffer> _buffers;
+    std::deque<int> _txQueue;
+    std::deque<PendingAcquire> _pendingAcquire;
+    PresenterStats _stats;
+    Clock::time_point _lastTxStart{};
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::atomic<bool> _open = false;
+    std::thread _txThread;
+
+    // Events queued by the tx thread may run after the presenter is freed, they hold a weak reference to this
+    std::shared_ptr<FramePresenter*> _alive = std::make_shared<FramePresenter*>(this);
+
+    int findBuffer(const uint8_t* data) {
+        for (size_t i = 0; i < _buffers.size(); ++i) {
+            if (_buffers[i].data == data) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void transmit(const Buffer& buffer) {
+        if (_options.framing == PresenterFraming::Hub75Bridge) {
+            auto modeset = hub75bridge::buildModeset(_options.width, _options.format, _brightness);
+            _spi->write(_sync, _options.cs, _options.qio);
+            _spi->write(modeset, _options.cs, _options.qio);
+        }
+        _spi->write(std::span<const uint8_t>(buffer.data, buffer.used), _options.cs, _options.qio);
+    }
+
+    void txLoop() {
+        while (true) {
+            int idx;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [this]() { return !_open || !_txQueue.empty(); });
+                if (!_open) {
+                    return;
+                }
+                idx = _txQueue.front();
+                _txQueue.pop_front();
+                _buffers[idx].state = BufferState::Sending;
+            }
+
+            if (_options.minInterval.count() > 0) {
+                std::this_thread::sleep_until(_lastTxStart + _options.minInterval);
+            }
+
+            auto start = Clock::now();
+            bool ok = true;
+            try {
+                transmit(_buffers[idx]);
+            }
+            catch (std::exception&) {
+                ok = false;
+            }
+            auto end = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                int64_t txUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+                if (ok) {
+                    _stats.transmitted++;
+                    _stats.lastTxUs = txUs;
+                    _stats.maxTxUs = std::max(_stats.maxTxUs, txUs);
+                    _stats.totalTxUs += txUs;
+                }
+                else {
+                    _stats.errors++;
+                }
+
+                if (_lastTxStart != Clock::time_point{}) {
+                    int64_t intervalUs = std::chrono::duration_cast<std::chrono::microseconds>(start - _lastTxStart).count();
+                    _stats.lastIntervalUs = intervalUs;
+                    _stats.maxIntervalUs = std::max(_stats.maxIntervalUs, intervalUs);
+                }
+                _lastTxStart = start;
+                _buffers[idx].state = BufferState::Free;
+            }
+
+            _feature->scheduleEvent([alive = std::weak_ptr<FramePresenter*>(_alive)]() {
+                if (auto self = alive.lock()) {
+                    (*self)->dispatchFree();
+                }
+            });
+        }
+    }
+
+    void dispatchFree() {
+        while (true) {
+            std::optional<jac::Function> resolve;
+            std::optional<jac::Value> buffer;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_pendingAcquire.empty()) {
+                    return;
+                }
+
+                auto it = std::find_if(_buffers.begin(), _buffers.end(), [](const Buffer& b) { return b.state == BufferState::Free; });
+                if (it == _buffers.end()) {
+                    return;
+                }
+
+                it->state = BufferState::Acquired;
+                buffer.emplace(it->js);
+                resolve.emplace(std::move(_pendingAcquire.front().resolve));
+                _pendingAcquire.pop_front();
+            }
+            resolve->template call<void>(*buffer);
+        }
+    }
+
+public:
+    FramePresenter(Feature* feature, jac::ContextRef ctx, jac::Value spiRef, SPI* spi, PresenterOptions options):
+        _feature(feature),
+        _spi(spi),
+        _spiRef(std::move(spiRef)),
+        _options(options),
+        _brightness(options.brightness)
+    {
+        size_t bytesPerPixel = packedColorSize(_options.format);
+        if (bytesPerPixel == 0) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "Invalid color format");
+        }
+        size_t frameBytes = static_cast<size_t>(_options.width) * _options.height * bytesPerPixel;
+
+        std::vector<uint8_t> zeroes(frameBytes, 0);
+        for (int i = 0; i < _options.buffers; ++i) {
+            jac::Value js = jac::ArrayBuffer::create(ctx, std::span(zeroes));
+            size_t size;
+            uint8_t* data = JS_GetArrayBuffer(ctx, &size, js.getVal());
+            _buffers.push_back(Buffer{ std::move(js), data, size, size, BufferState::Free });
+        }
+
+        if (_options.framing == PresenterFraming::Hub75Bridge) {
+            _sync = hub75bridge::buildSync();
+        }
+
+        _open = true;
+        _txThread = std::thread([this]() noexcept {
+            txLoop();
+        });
+    }
+
+    FramePresenter(const FramePresenter&) = delete;
+    FramePresenter& operator=(const FramePresenter&) = delete;
+
+    /**
+     * @brief Get a back buffer to render into, waiting for one to be released if all are in flight
+     */
+    jac::Promise acquire(jac::ContextRef ctx) {
+        if (!_open) {
+            throw jac::Exception::create(jac::Exception::Type::Error, "Presenter is closed");
+        }
+
+        auto [promise, resolve, reject] = jac::Promise::create(ctx);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pendingAcquire.push_back(PendingAcquire{
+                .resolve = std::move(resolve),
+                .reject = std::move(reject),
+            });
+        }
+        dispatchFree();
+
+        return promise;
+    }
+
+    /**
+     * @brief Queue an acquired buffer for transmission
+     * @param data Start of the buffer returned by acquire
+     * @param size Number of bytes to send, the whole frame if 0
+     */
+    void present(const uint8_t* data, size_t size) {
+        if (!_open) {
+            throw jac::Exception::create(jac::Exception::Type::Error, "Presenter is closed");
+        }
+
+        bool released = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            int idx = findBuffer(data);
+            if (idx < 0 || _buffers[idx].state != BufferState::Acquired) {
+                throw jac::Exception::create(jac::Exception::Type::Error, "Buffer was not acquired from this presenter");
+            }
+
+            // Frames that did not start transmitting yet are superseded by the new one
+            if (_options.dropStale) {
+                for (int queued : _txQueue) {
+                    _buffers[queued].state = BufferState::Free;
+                    _stats.dropped++;
+                    released = true;
+                }
+                _txQueue.clear();
+            }
+
+            auto& buffer = _buffers[idx];
+            buffer.used = (size > 0 && size <= buffer.size) ? size : buffer.size;
+            buffer.state = BufferState::Queued;
+            _txQueue.push_back(idx);
+            _stats.presented++;
+        }
+        _cv.notify_one();
+
+        if (released) {
+            dispatchFree();
+        }
+    }
+
+    /**
+     * @brief Return a previously acquired buffer without presenting it
+     */
+    void release(const uint8_t* data) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            int idx = findBuffer(data);
+            if (idx < 0 || _buffers[idx].state != BufferState::Acquired) {
+                throw jac::Exception::create(jac::Exception::Type::Error, "Buffer was not acquired from this presenter");
+            }
+            _buffers[idx].state = BufferState::Free;
+        }
+        dispatchFree();
+    }
+
+    PresenterStats stats() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = PresenterStats{};
+    }
+
+    void setBrightness(int brightness) {
+        _brightness = brightness;
+    }
+
+    void closeNative(bool rejectPromises) {
+        if (!_open.exchange(false)) {
+            return;
+        }
+        _cv.notify_one();
+        if (_txThread.joinable()) {
+            _txThread.join();
+        }
+
+        std::deque<PendingAcquire> pending;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::swap(pending, _pendingAcquire);
+        }
+        if (rejectPromises) {
+            for (auto& request : pending) {
+                request.reject.template call<void>(jac::Exception::create(jac::Exception::Type::Error, "Presenter is closed"));
+            }
+        }
+    }
+
+    void close() {
+        closeNative(true);
+    }
+
+    ~FramePresenter() {
+        closeNative(false);
+    }
+};
+
+
+template<class Feature>
+struct FramePresenterProtoBuilder : public jac::ProtoBuilder::Opaque<FramePresenter<Feature>>, public jac::ProtoBuilder::Properties {
+    using FramePresenter_ = FramePresenter<Feature>;
+
+    static PresenterOptions optionsFromObject(jac::Object options) {
+        for (auto key : { "cs", "width", "height" }) {
+            if (!options.hasProperty(key)) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, std::string("Missing required property '") + key + "'");
+            }
+        }
+
+        PresenterOptions config{
+            .cs = options.get<int>("cs"),
+            .width = options.get<int>("width"),
+            .height = options.get<int>("height"),
+            .format = 10,
+            .buffers = 2,
+            .qio = false,
+            .dropStale = true,
+            .brightness = 255,
+            .framing = PresenterFraming::Raw,
+            .minInterval = std::chrono::microseconds(0),
+        };
+
+        if (options.hasProperty("format")) {
+            config.format = options.get<int>("format");
+        }
+        if (options.hasProperty("buffers")) {
+            config.buffers = options.get<int>("buffers");
+        }
+        if (options.hasProperty("qio")) {
+            config.qio = options.get<bool>("qio");
+        }
+        if (options.hasProperty("dropStale")) {
+            config.dropStale = options.get<bool>("dropStale");
+        }
+        if (options.hasProperty("brightness")) {
+            config.brightness = options.get<int>("brightness");
+        }
+        if (options.hasProperty("fps")) {
+            int fps = options.get<int>("fps");
+            if (fps <= 0) {
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "fps must be greater than 0");
+            }
+            config.minInterval = std::chrono::microseconds(1'000'000 / fps);
+        }
+        if (options.hasProperty("framing")) {
+            auto framing = options.get<std::string>("framing");
+            if (framing == "raw") {
+                config.framing = PresenterFraming::Raw;
+            }
+            else if (framing == "hub75-bridge") {
+                config.framing = PresenterFraming::Hub75Bridge;
+            }
+            else {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid framing");
+            }
+        }
+
+        if (config.width <= 0 || config.height <= 0) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "width and height must be greater than 0");
+        }
+        if (config.buffers < 2 || config.buffers > 4) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "buffers must be between 2 and 4");
+        }
+
+        return config;
+    }
+
+    static FramePresenter_* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        if (args.size() < 2) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "Expected 2 arguments (spi, options)");
+        }
+
+        SPI* spi = jac::ProtoBuilder::Opaque<SPI>::getOpaque(ctx, args[0]);
+        if (!spi) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid SPI object");
+        }
+
+        auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx));  // NOLINT
+        return new FramePresenter_(&feature, ctx, args[0], spi, optionsFromObject(args[1].to<jac::Object>()));
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("acquire", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            return self.acquire(ctx_);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("present", ff.newFunctionThisVariadic([](jac::ContextRef ctx_, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Expected a buffer");
+            }
+
+            size_t maxBytes;
+            uint8_t* raw = JS_GetArrayBuffer(ctx_, &maxBytes, args[0].getVal());
+            if (!raw) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid ArrayBuffer passed");
+            }
+            int size = (args.size() > 1 && !args[1].isUndefined()) ? args[1].to<int>() : 0;
+            self.present(raw, size > 0 ? size : 0);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("release", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal, jac::ValueWeak buffer) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            size_t maxBytes;
+            uint8_t* raw = JS_GetArrayBuffer(ctx_, &maxBytes, buffer.getVal());
+            if (!raw) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid ArrayBuffer passed");
+            }
+            self.release(raw);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setBrightness", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal, int brightness) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            self.setBrightness(brightness);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getStats", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            PresenterStats stats = self.stats();
+
+            jac::Object obj = jac::Object::create(ctx_);
+            obj.set("presented", static_cast<double>(stats.presented));
+            obj.set("transmitted", static_cast<double>(stats.transmitted));
+            obj.set("dropped", static_cast<double>(stats.dropped));
+            obj.set("errors", static_cast<double>(stats.errors));
+            obj.set("lastTxUs", static_cast<double>(stats.lastTxUs));
+            obj.set("maxTxUs", static_cast<double>(stats.maxTxUs));
+            obj.set("avgTxUs", stats.transmitted > 0 ? static_cast<double>(stats.totalTxUs) / stats.transmitted : 0.0);
+            obj.set("lastIntervalUs", static_cast<double>(stats.lastIntervalUs));
+            obj.set("maxIntervalUs", static_cast<double>(stats.maxIntervalUs));
+            return obj;
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("resetStats", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            self.resetStats();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("close", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FramePresenterProtoBuilder::getOpaque(ctx_, thisVal);
+            self.close();
+
+            auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx_));  // NOLINT
+            feature.unregisterPresenter(thisVal);
+        }), jac::PropFlags::Enumerable);
+    }
+
+    static void postConstruction(jac::ContextRef ctx, jac::Object thisVal, std::vector<jac::ValueWeak> args) {
+        auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx));  // NOLINT
+        feature.registerPresenter(thisVal);
+    }
+};
+
+
+template<class Next>
+class FramePresenterFeature : public Next {
+    std::vector<jac::Object> _presenters;
+public:
+    using PresenterClass = jac::Class<FramePresenterProtoBuilder<FramePresenterFeature<Next>>>;
+
+    FramePresenterFeature() {
+        PresenterClass::init("FramePresenter");
+    }
+
+    ~FramePresenterFeature() {
+        for (auto& presenter : _presenters) {
+            auto* ptr = FramePresenterProtoBuilder<FramePresenterFeature<Next>>::getOpaque(this->context(), presenter);
+            ptr->closeNative(false);
+        }
+    }
+
+    void registerPresenter(jac::Object presenter) {
+        _presenters.emplace_back(presenter);
+    }
+
+    void unregisterPresenter(jac::ValueWeak presenter) {
+        for (auto itr = _presenters.begin(); itr != _presenters.end(); ++itr) {
+            if (itr->getVal() == presenter.getVal()) {
+                _presenters.erase(itr);
+                return;
+            }
+        }
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        auto& mod = this->newModule("presenter");
+        mod.addExport("FramePresenter", PresenterClass::getConstructor(this->context()));
+    }
+};
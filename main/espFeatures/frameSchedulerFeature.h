@@ -0,0 +1,395 @@
+#pragma once
+
+#include <jac/device/logger.h>
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+#include <jac/machine/values.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "esp_timer.h"
+#include "freeRTOSEventQueue.h"
+
+
+enum class FramePolicy {
+    // Late frames give up the missed slots and wait for the next one
+    Skip,
+    // Late frames run back to back until the schedule is met again
+    CatchUp,
+};
+
+struct FrameSchedulerOptions {
+    int64_t periodUs;
+    FramePolicy policy;
+    int maxCatchUp;
+};
+
+struct FrameSchedulerStats {
+    uint32_t frames = 0;
+    uint32_t dropped = 0;
+    int64_t lastJitterUs = 0;
+    int64_t maxJitterUs = 0;
+    int64_t totalJitterUs = 0;
+    int64_t lastFrameUs = 0;
+    int64_t maxFrameUs = 0;
+};
+
+
+/**
+ * Runs a frame callback at a target rate through the event queue.
+ *
+ * The next frame is only scheduled after the previous one completed, either when the callback
+ * returns or, if it returns a promise, when that promise settles.
+ */
+template<class Feature>
+class FrameScheduler {
+    Feature* _feature;
+    FrameSchedulerOptions _options;
+    FrameSchedulerStats _stats;
+
+    static constexpr int64_t RETRY_US = 1000;
+
+    esp_timer_handle_t _timer = nullptr;
+    std::optional<jac::Function> _callback;
+    // Neither the esp_timer task nor the loop may wait for room in the lane
+    EventSource _events{EventLane::Timer, OverflowPolicy::DropNewest, false, "frame"};
+
+    bool _running = false;
+    bool _inFrame = false;
+    bool _eventPending = false;
+    int64_t _next = 0;
+    int64_t _frameStart = 0;
+    int64_t _lastStart = 0;
+
+    bool post() {
+        return _feature->scheduleEvent(_events, [this]() { runFrame(); });
+    }
+
+    /**
+     * Runs in the esp_timer task. A full lane tries again after RETRY_US,
+     * the frame stays pending meanwhile.
+     */
+    static void onTimer(void* arg) {
+        auto* self = static_cast<FrameScheduler*>(arg);
+        if (!self->post()) {
+            esp_timer_start_once(self->_timer, RETRY_US);
+        }
+    }
+
+    void arm(int64_t deadline) {
+        _eventPending = true;
+        int64_t delay = deadline - esp_timer_get_time();
+        if (delay <= 0 && post()) {
+            return;
+        }
+
+        // A frame that is due but did not fit into the lane is retried by the timer
+        esp_err_t err = esp_timer_start_once(_timer, std::max(delay, RETRY_US));
+        if (err == ESP_OK) {
+            return;
+        }
+        jac::Logger::error("FrameScheduler esp_timer_start_once: " + std::string(esp_err_to_name(err)));
+        if (!post()) {
+            // Nothing will run the frame, leave it idle so stop() and start() can arm it again
+            _eventPending = false;
+        }
+    }
+
+    void runFrame() {
+        _eventPending = false;
+        if (!_running) {
+            // Stopped while this event was in flight, the registration was kept until now
+            _feature->unregisterScheduler(this);
+            return;
+        }
+
+        int64_t now = esp_timer_get_time();
+        int64_t jitter = std::abs(now - _next);
+        _stats.frames++;
+        _stats.lastJitterUs = jitter;
+        _stats.maxJitterUs = std::max(_stats.maxJitterUs, jitter);
+        _stats.totalJitterUs += jitter;
+
+        double delta = _lastStart != 0 ? (now - _lastStart) / 1000.0 : 0.0;
+        _lastStart = now;
+        _frameStart = now;
+        _inFrame = true;
+
+        jac::Value result;
+        try {
+            result = _callback->template call<jac::Value>(now / 1000.0, delta);
+        }
+        catch (...) {
+            completeFrame();
+            throw;
+        }
+
+        if (result.isObject()) {
+            auto obj = result.to<jac::Object>();
+            if (obj.hasProperty("then")) {
+                jac::FunctionFactory ff(_feature->context());
+                auto settle = ff.newFunctionVariadic([this](std::vector<jac::ValueWeak>) {
+                    this->completeFrame();
+                });
+                obj.get<jac::Function>("then").template callThis<void>(obj, settle, settle);
+                return;
+            }
+        }
+        completeFrame();
+    }
+
+    void completeFrame() {
+        if (!_inFrame) {
+            return;
+        }
+        _inFrame = false;
+
+        int64_t now = esp_timer_get_time();
+        int64_t frameUs = now - _frameStart;
+        _stats.lastFrameUs = frameUs;
+        _stats.maxFrameUs = std::max(_stats.maxFrameUs, frameUs);
+
+        if (!_running) {
+            // Stopped during the frame, the registration was kept until now
+            _feature->unregisterScheduler(this);
+            return;
+        }
+
+        int64_t period = _options.periodUs;
+        _next += period;
+        if (now >= _next) {
+            int64_t behind = (now - _next) / period + 1;
+            if (_options.policy == FramePolicy::Skip) {
+                _stats.dropped += behind;
+                _next += behind * period;
+            }
+            else if (behind > _options.maxCatchUp) {
+                // Too far behind to catch up, run now and restart the schedule from here
+                _stats.dropped += behind - 1;
+                _next = now;
+            }
+        }
+        arm(_next);
+    }
+
+public:
+    FrameScheduler(Feature* feature, FrameSchedulerOptions options):
+        _feature(feature),
+        _options(options)
+    {
+        esp_timer_create_args_t args{};
+        args.callback = onTimer;
+        args.arg = static_cast<void*>(this);
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "frame";
+
+        esp_err_t err = esp_timer_create(&args, &_timer);
+        if (err != ESP_OK) {
+            throw jac::Exception::create(jac::Exception::Type::InternalError, "esp_timer_create failed: " + std::string(esp_err_to_name(err)));
+        }
+    }
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    bool running() const { return _running; }
+
+    /**
+     * @brief Start calling the callback with (timestamp, delta) in milliseconds
+     * @return True if the scheduler was idle and has to be registered with the feature
+     */
+    bool start(jac::Function callback) {
+        if (_running) {
+            throw jac::Exception::create(jac::Exception::Type::Error, "FrameScheduler is already running");
+        }
+        _callback.emplace(std::move(callback));
+        _running = true;
+        _lastStart = 0;
+        _next = esp_timer_get_time();
+
+        // A frame or event left over from before the last stop continues the new schedule
+        if (_eventPending || _inFrame) {
+            return false;
+        }
+        arm(_next);
+        return true;
+    }
+
+    /**
+     * @brief Stop scheduling frames
+     * @return True if no frame is in flight and the scheduler can be unregistered now
+     */
+    bool stop() {
+        if (!_running) {
+            return false;
+        }
+        _running = false;
+
+        // A timer that did not fire yet is cancelled, an event already queued still arrives
+        if (_eventPending && esp_timer_stop(_timer) == ESP_OK) {
+            _eventPending = false;
+        }
+        return !_eventPending && !_inFrame;
+    }
+
+    void setFps(int fps) {
+        _options.periodUs = 1'000'000 / fps;
+    }
+
+    FrameSchedulerStats stats() const { return _stats; }
+    void resetStats() { _stats = FrameSchedulerStats{}; }
+
+    ~FrameScheduler() {
+        if (_timer) {
+            esp_timer_stop(_timer);
+            esp_timer_delete(_timer);
+        }
+    }
+};
+
+
+template<class Feature>
+struct FrameSchedulerProtoBuilder : public jac::ProtoBuilder::Opaque<FrameScheduler<Feature>>, public jac::ProtoBuilder::Properties {
+    using FrameScheduler_ = FrameScheduler<Feature>;
+
+    static int fpsFromValue(int fps) {
+        if (fps <= 0 || fps > 1000) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "fps must be between 1 and 1000");
+        }
+        return fps;
+    }
+
+    static FrameSchedulerOptions optionsFromObject(jac::Object options) {
+        FrameSchedulerOptions config{
+            .periodUs = 1'000'000 / 30,
+            .policy = FramePolicy::Skip,
+            .maxCatchUp = 3,
+        };
+
+        if (options.hasProperty("fps")) {
+            config.periodUs = 1'000'000 / fpsFromValue(options.get<int>("fps"));
+        }
+        if (options.hasProperty("policy")) {
+            auto policy = options.get<std::string>("policy");
+            if (policy == "skip") {
+                config.policy = FramePolicy::Skip;
+            }
+            else if (policy == "catch-up") {
+                config.policy = FramePolicy::CatchUp;
+            }
+            else {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid policy");
+            }
+        }
+        if (options.hasProperty("maxCatchUp")) {
+            config.maxCatchUp = std::max(options.get<int>("maxCatchUp"), 1);
+        }
+
+        return config;
+    }
+
+    static FrameScheduler_* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        FrameSchedulerOptions options{ 1'000'000 / 30, FramePolicy::Skip, 3 };
+        if (!args.empty() && !args[0].isUndefined()) {
+            options = optionsFromObject(args[0].to<jac::Object>());
+        }
+
+        auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx));  // NOLINT
+        return new FrameScheduler_(&feature, options);
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("start", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal, jac::Function callback) {
+            auto& self = *FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal);
+            auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx_));  // NOLINT
+
+            if (self.start(std::move(callback))) {
+                feature.registerScheduler(thisVal);
+            }
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("stop", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal);
+            auto& feature = *reinterpret_cast<Feature*>(JS_GetContextOpaque(ctx_));  // NOLINT
+
+            if (self.stop()) {
+                feature.unregisterScheduler(&self);
+            }
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("isRunning", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            return FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal)->running();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setFps", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal, int fps) {
+            FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal)->setFps(fpsFromValue(fps));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getStats", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            auto& self = *FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal);
+            FrameSchedulerStats stats = self.stats();
+
+            jac::Object obj = jac::Object::create(ctx_);
+            obj.set("frames", static_cast<double>(stats.frames));
+            obj.set("dropped", static_cast<double>(stats.dropped));
+            obj.set("lastJitterUs", static_cast<double>(stats.lastJitterUs));
+            obj.set("maxJitterUs", static_cast<double>(stats.maxJitterUs));
+            obj.set("avgJitterUs", stats.frames > 0 ? static_cast<double>(stats.totalJitterUs) / stats.frames : 0.0);
+            obj.set("lastFrameUs", static_cast<double>(stats.lastFrameUs));
+            obj.set("maxFrameUs", static_cast<double>(stats.maxFrameUs));
+            return obj;
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("resetStats", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+            FrameSchedulerProtoBuilder::getOpaque(ctx_, thisVal)->resetStats();
+        }), jac::PropFlags::Enumerable);
+    }
+};
+
+
+template<class Next>
+class FrameSchedulerFeature : public Next {
+    std::vector<jac::Object> _schedulers;
+public:
+    using SchedulerProtoBuilder = FrameSchedulerProtoBuilder<FrameSchedulerFeature<Next>>;
+    using SchedulerClass = jac::Class<SchedulerProtoBuilder>;
+
+    FrameSchedulerFeature() {
+        SchedulerClass::init("FrameScheduler");
+    }
+
+    ~FrameSchedulerFeature() {
+        for (auto& scheduler : _schedulers) {
+            SchedulerProtoBuilder::getOpaque(this->context(), scheduler)->stop();
+        }
+    }
+
+    // Running schedulers are referenced here so they are not collected while frames are pending
+    void registerScheduler(jac::ValueWeak scheduler) {
+        _schedulers.emplace_back(scheduler.to<jac::Object>());
+    }
+
+    void unregisterScheduler(FrameScheduler<FrameSchedulerFeature<Next>>* scheduler) {
+        for (auto itr = _schedulers.begin(); itr != _schedulers.end(); ++itr) {
+            if (SchedulerProtoBuilder::getOpaque(this->context(), *itr) == scheduler) {
+                _schedulers.erase(itr);
+                return;
+            }
+        }
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        auto& mod = this->newModule("frame");
+        mod.addExport("FrameScheduler", SchedulerClass::getConstructor(this->context()));
+    }
+};
@@ -1,233 +1,696 @@
 #pragma once
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <optional>
-#include <tuple>
-#include <variant>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../util/eventLoopStats.h"
+#include "../util/eventRing.h"
+#include "../util/inlineFunction.h"
+#include "../util/statsChannel.h"
+
+#ifndef EVENT_LANE_CAPACITY_REALTIME
+#define EVENT_LANE_CAPACITY_REALTIME 32
+#endif
+#ifndef EVENT_LANE_CAPACITY_TIMER
+#define EVENT_LANE_CAPACITY_TIMER 32
+#endif
+#ifndef EVENT_LANE_CAPACITY_NORMAL
+#define EVENT_LANE_CAPACITY_NORMAL 64
+#endif
+#ifndef EVENT_LANE_CAPACITY_BULK
+#define EVENT_LANE_CAPACITY_BULK 64
+#endif
+
+/**
+ * Priority lanes of the event queue, highest first. Every lane has its own
+ * ring, so a burst in one of them cannot delay or fill the others.
+ */
+enum class EventLane : uint8_t {
+    RealTime, // interrupts, GPIO edges, motor targets
+    Timer,    // timers and frame pacing
+    Normal,   // events scheduled without a lane
+    Bulk,     // serial, network and radio data
+};
+
+// What happens to an event scheduled into a full lane
+enum class OverflowPolicy : uint8_t {
+    Block,      // wait for room, from tasks other than the event loop
+    DropOldest, // discard the oldest event of the lane, released by the loop
+    DropNewest, // discard the event being scheduled
+};
+
+/**
+ * Producer of events with its own lane, overflow policy and counters.
+ *
+ * A coalescing source has at most one event waiting, scheduling while it is
+ * pending only counts the request. The callback is expected to handle
+ * everything that arrived in the meantime.
+ *
+ * A named source gets its own wait and run time statistics, shared by all
+ * sources of the same name. The name has to outlive the program, use a
+ * string literal.
+ */
+struct EventSource {
+    static constexpr size_t STAT_SLOTS = 8;
+    static constexpr uint8_t NO_SLOT = 0xFF;
+
+    EventLane lane;
+    OverflowPolicy policy;
+    bool coalesce;
+    uint8_t statSlot;
+
+    std::atomic<bool> pending = false;
+    std::atomic<uint32_t> scheduled = 0;
+    std::atomic<uint32_t> coalesced = 0;
+    std::atomic<uint32_t> dropped = 0;
+
+    EventSource(EventLane lane_, OverflowPolicy policy_ = OverflowPolicy::Block, bool coalesce_ = false, const char* name = nullptr):
+        lane(lane_), policy(policy_), coalesce(coalesce_), statSlot(slotOf(name))
+    {}
+
+    /**
+     * @brief Names of the statistics slots in use, in slot order
+     */
+    static std::vector<const char*> statNames() {
+        std::lock_guard<std::mutex> lock(_namesMutex);
+        return std::vector<const char*>(_names.begin(), _names.begin() + _nameCount);
+    }
+
+private:
+    static inline std::mutex _namesMutex;
+    static inline std::array<const char*, STAT_SLOTS> _names{};
+    static inline size_t _nameCount = 0;
+
+    // Unnamed sources and names past STAT_SLOTS only count towards their lane
+    static uint8_t slotOf(const char* name) {
+        if (!name) {
+            return NO_SLOT;
+        }
+        std::lock_guard<std::mutex> lock(_namesMutex);
+        for (size_t i = 0; i < _nameCount; ++i) {
+            if (std::strcmp(_names[i], name) == 0) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        if (_nameCount == STAT_SLOTS) {
+            return NO_SLOT;
+        }
+        _names[_nameCount] = name;
+        return static_cast<uint8_t>(_nameCount++);
+    }
+};
+
+struct EventLaneStats {
+    size_t pending;
+    size_t capacity;
+    uint32_t dropped;
+    uint32_t coalesced;
+    uint32_t blocked; // schedules that had to wait for room
+};
 
 template<class Next>
 class FreeRTOSEventQueueFeature : public Next {
 public:
     using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
 
+    /**
+     * Callable stored in the event queue. Callables up to INLINE_SIZE bytes,
+     * which covers a function pointer with its argument or a lambda with a few
+     * captures, are kept inside the event and never allocate.
+     *
+     * Every event is stamped with the esp_timer time of scheduling. Monotonic
+     * steady_clock counts from the same base on ESP-IDF, so the TimePoint
+     * passed to callbacks compares with steady_clock::now().
+     */
     struct Event {
-        using EvStdF = std::function<void()>*;
-        using EvFreeF = std::tuple<void(*)(void*), void*>;
-        using EvTmrStdF = std::tuple<std::function<void(TimePoint)>*, uint64_t>;
-        using EvTmrFreeF = std::tuple<void(*)(void*, TimePoint), void*, uint64_t>;
-
-
-        std::variant<
-            std::monostate,
-            EvStdF,
-            EvFreeF,
-            EvTmrStdF,
-            EvTmrFreeF
-        > event = std::monostate();
-
-        Event() : event(std::monostate()) {}
-
-        Event(std::function<void()> func) : event(new std::function<void()>(std::move(func))) {}
-        Event(void(*func)(void*), void* arg) : event(std::make_tuple(func, arg)) {}
-        Event(std::function<void(TimePoint)> func):
-            event(std::make_tuple(
-                new std::function<void(TimePoint)>(std::move(func)),
-                // TODO: use efficient time source, maybe add time argument?
-                std::chrono::steady_clock::now().time_since_epoch().count()
-            ))
-        {}
-        Event(void(*func)(void*, TimePoint), void* arg):
-            event(std::make_tuple(
-                func,
-                arg,
-                std::chrono::steady_clock::now().time_since_epoch().count()
-            ))
-        {}
+        static constexpr size_t INLINE_SIZE = 32;
+        using Function = InlineFunction<void(TimePoint), INLINE_SIZE>;
+
+        Function func;
+        int64_t time = 0; // microseconds
+        uintptr_t origin = 0; // code address reported for slow callbacks
+        uint8_t source = EventSource::NO_SLOT; // statistics slot of the source
+
+        // Marks the event with the statistics slot of its source
+        struct FromSource {
+            uint8_t slot;
+        };
 
-        Event& operator=(const Event& other) = delete;
-        Event(const Event& other) = delete;
-        Event& operator=(Event&& other) {
-            std::swap(event, other.event);
-            return *this;
+        static int64_t now() {
+            return esp_timer_get_time();
         }
-        Event(Event&& other) {
-            *this = std::move(other);
+
+        Event() = default;
+
+        template<class F, class D = std::decay_t<F>>
+            requires (!std::is_same_v<D, Event> && (std::is_invocable_v<D&, TimePoint> || std::is_invocable_v<D&>))
+        Event(F&& f): time(now()) {
+            if constexpr (std::is_invocable_v<D&, TimePoint>) {
+                func = Function(std::forward<F>(f));
+            }
+            else {
+                func = Function([f = std::forward<F>(f)](TimePoint) mutable { f(); });
+            }
+            origin = func.target();
         }
 
-        ~Event() {
-            std::visit([](auto& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, EvStdF>) {
-                    delete arg;
-                }
-                else if constexpr (std::is_same_v<T, EvTmrStdF>) {
-                    delete std::get<0>(arg);
-                }
-                else {
-                    // no cleanup
-                }
-            }, event);
+        Event(void(*f)(void*), void* arg):
+            func([f, arg](TimePoint) { f(arg); }),
+            time(now()),
+            origin(reinterpret_cast<uintptr_t>(f))
+        {}
+
+        Event(void(*f)(void*, TimePoint), void* arg):
+            func([f, arg](TimePoint t) { f(arg, t); }),
+            time(now()),
+            origin(reinterpret_cast<uintptr_t>(f))
+        {}
+
+        template<class... Args>
+        Event(FromSource from, Args&&... args): Event(std::forward<Args>(args)...) {
+            source = from.slot;
         }
 
+        Event(Event&&) = default;
+        Event& operator=(Event&&) = default;
+        Event(const Event&) = delete;
+        Event& operator=(const Event&) = delete;
+
         void operator()() {
-            std::visit([](auto& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, EvStdF>) {
-                    if (arg) {
-                        (*arg)();
-                    }
-                }
-                else if constexpr (std::is_same_v<T, EvFreeF>) {
-                    auto [func, a] = arg;
-                    if (func) {
-                        func(a);
-                    }
-                }
-                else if constexpr (std::is_same_v<T, EvTmrStdF>) {
-                    auto [func, time] = arg;
-                    if (func) {
-                        (*func)(std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(time)));
-                    }
-                }
-                else if constexpr (std::is_same_v<T, EvTmrFreeF>) {
-                    auto [func, a, time] = arg;
-                    if (func) {
-                        func(a, std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(time)));
-                    }
-                }
-                else {
-                    // empty event
-                }
-            }, event);
+            if (func) {
+                func(TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::microseconds(time))));
+            }
         }
 
         operator bool() const {
-            return !std::holds_alternative<std::monostate>(event);
+            return static_cast<bool>(func);
+        }
+
+        // Whether the event can be destroyed outside of the loop, its captures hold nothing
+        bool trivial() const {
+            return func.trivial();
         }
 
         void release() {
-            event = std::monostate();
+            func.reset();
         }
     };
+
+    static constexpr size_t LANE_COUNT = 4;
+    static constexpr std::array<size_t, LANE_COUNT> LANE_CAPACITY = {
+        EVENT_LANE_CAPACITY_REALTIME,
+        EVENT_LANE_CAPACITY_TIMER,
+        EVENT_LANE_CAPACITY_NORMAL,
+        EVENT_LANE_CAPACITY_BULK,
+    };
+    static constexpr size_t MAX_BATCH = 16;
+    // Batches a waiting lane may be passed over before it is served first
+    static constexpr uint8_t STARVATION_LIMIT = 4;
+
+    using EventStats = EventLoopStats<LANE_COUNT, EventSource::STAT_SLOTS>;
+
 private:
-    QueueHandle_t _eventQueue;
+    struct LaneCounters {
+        std::atomic<uint32_t> dropped = 0;
+        std::atomic<uint32_t> coalesced = 0;
+        std::atomic<uint32_t> blocked = 0;
+    };
+
+    // Event dropped by another task, kept until the loop releases it
+    struct Discarded {
+        Event event;
+        Discarded* next;
+    };
+
+    // Clears the pending flag of a coalescing source once its event runs or is dropped
+    class PendingGuard {
+        std::atomic<bool>* _flag;
+    public:
+        PendingGuard(std::atomic<bool>* flag): _flag(flag) {}
+        PendingGuard(PendingGuard&& other) noexcept: _flag(std::exchange(other._flag, nullptr)) {}
+        PendingGuard& operator=(PendingGuard&&) = delete;
+        ~PendingGuard() { clear(); }
+
+        void clear() {
+            if (_flag) {
+                _flag->store(false, std::memory_order_release);
+                _flag = nullptr;
+            }
+        }
+    };
+
+    std::array<EventRing<Event>, LANE_COUNT> _lanes = {
+        EventRing<Event>(LANE_CAPACITY[0]),
+        EventRing<Event>(LANE_CAPACITY[1]),
+        EventRing<Event>(LANE_CAPACITY[2]),
+        EventRing<Event>(LANE_CAPACITY[3]),
+    };
+    std::array<uint8_t, LANE_COUNT> _starved{};
+    std::array<LaneCounters, LANE_COUNT> _counters;
+    SemaphoreHandle_t _wakeup;
+    std::atomic<TaskHandle_t> _loopTask = nullptr; // read by producers
+
+    // Given by the loop after taking from a lane some producer waits on
+    std::array<SemaphoreHandle_t, LANE_COUNT> _space{};
+    std::array<std::atomic<uint32_t>, LANE_COUNT> _spaceWaiters{};
+
+    // Captures may hold JS values, which only the loop may release
+    std::atomic<Discarded*> _discarded = nullptr;
+    std::atomic<bool> _sleeping = false;
+
+    // Events taken from the ring and not run yet, always run before newer ones
+    std::array<Event, MAX_BATCH> _batch;
+    std::array<uint8_t, MAX_BATCH> _batchLane{};
+    size_t _batchBegin = 0;
+    size_t _batchEnd = 0;
+    size_t _batchLimit = 8;
+    int64_t _timeSliceUs = 2000;
+
+    EventStats _stats;
+    int64_t _streamIntervalUs = 0;
+    int64_t _lastPublish = 0;
+
+    bool onLoopTask() const {
+        return xTaskGetCurrentTaskHandle() == _loopTask.load(std::memory_order_relaxed);
+    }
+
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleeping.exchange(false)) {
+            xSemaphoreGive(_wakeup);
+        }
+    }
+
+    EventRing<Event>& lane(EventLane lane) {
+        return _lanes[static_cast<size_t>(lane)];
+    }
+
+    bool ready() const {
+        return std::any_of(_lanes.begin(), _lanes.end(), [](const auto& lane) { return !lane.empty(); });
+    }
+
+    bool waitReady(bool wait) {
+        if (ready() || !wait) {
+            return ready();
+        }
 
-    Event dequeue(bool wait) {
-        Event e;
-        if (xQueueReceive(_eventQueue, &e, wait ? portMAX_DELAY : 0)) {
-            return e;
+        // Producers only signal a sleeping loop, check again once marked
+        _sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            xSemaphoreTake(_wakeup, portMAX_DELAY);
         }
-        else {
-            return Event();
+        _sleeping = false;
+        return ready();
+    }
+
+    /**
+     * Higher lanes fill the batch first, but every other waiting lane keeps
+     * one slot if the batch is large enough. A lane passed over
+     * STARVATION_LIMIT times in a row is served before all others.
+     */
+    void fillBatch() {
+        std::array<size_t, LANE_COUNT> taken{};
+        auto take = [&](size_t lane, size_t count) {
+            while (count-- > 0 && _batchEnd < _batchLimit && _lanes[lane].tryPop(_batch[_batchEnd])) {
+                _batchLane[_batchEnd++] = static_cast<uint8_t>(lane);
+                taken[lane]++;
+            }
+        };
+
+        for (size_t i = 0; i < LANE_COUNT; ++i) {
+            if (_starved[i] >= STARVATION_LIMIT) {
+                take(i, 1);
+            }
+        }
+        for (size_t i = 0; i < LANE_COUNT; ++i) {
+            size_t waitingBelow = 0;
+            for (size_t j = i + 1; j < LANE_COUNT; ++j) {
+                waitingBelow += !_lanes[j].empty();
+            }
+            size_t room = _batchLimit - _batchEnd;
+            take(i, room > waitingBelow ? room - waitingBelow : 1);
+        }
+
+        for (size_t i = 0; i < LANE_COUNT; ++i) {
+            if (taken[i] > 0 || _lanes[i].empty()) {
+                _starved[i] = 0;
+            }
+            else if (_starved[i] < STARVATION_LIMIT) {
+                _starved[i]++;
+            }
+        }
+
+        // Pairs with the fence of a blocked producer, it either sees the room or is woken
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t i = 0; i < LANE_COUNT; ++i) {
+            if (taken[i] > 0 && _spaceWaiters[i].load(std::memory_order_relaxed) > 0) {
+                xSemaphoreGive(_space[i]);
+            }
         }
     }
 
-    void drain() {
-        while(true) {
-            Event e;
-            if(xQueueReceive(_eventQueue, &e, 0) == pdFALSE) {
-                break;
+    bool refill(bool wait) {
+        releaseDiscarded();
+        _batchBegin = 0;
+        _batchEnd = 0;
+        while (waitReady(wait)) {
+            fillBatch();
+            if (_batchEnd > 0 || !wait) {
+                return _batchEnd > 0;
             }
+            // A producer claimed a slot but has not published it yet. It may
+            // have a lower priority, so block for a tick to let it finish
+            // instead of spinning on the loop task
+            xSemaphoreTake(_wakeup, 1);
         }
+        return false;
     }
 
-    void _scheduleImpl(auto&&... args) {
-        Event e(std::forward<decltype(args)>(args)...);
-        auto res = xQueueSend(_eventQueue, &e, portMAX_DELAY);
-        if (res != pdPASS) {
-            // TODO: handle error
+    void runBatch() {
+        int64_t start = esp_timer_get_time();
+        int64_t now = start;
+        do {
+            // Taken out first, an event that throws is not run again
+            size_t lane = _batchLane[_batchBegin];
+            Event e = std::move(_batch[_batchBegin++]);
+            _stats.waited(lane, now - e.time, e.source);
+            e();
+            int64_t end = esp_timer_get_time();
+            _stats.ran(lane, end - now, now, e.origin, e.source);
+            now = end;
+        } while (_batchBegin < _batchEnd && now - start < _timeSliceUs);
+
+        if (_streamIntervalUs > 0 && now - _lastPublish >= _streamIntervalUs) {
+            _lastPublish = now;
+            std::array<uint32_t, EventStats::SIZE> snapshot;
+            _stats.snapshot(snapshot.data());
+            StatsChannel::publish("eventloop", snapshot);
+        }
+    }
+
+    LaneCounters& counters(EventLane lane) {
+        return _counters[static_cast<size_t>(lane)];
+    }
+
+    void discard(Event event) {
+        if (event.trivial() || onLoopTask()) {
             return;
         }
-        e.release();
+        // Only pushed here and taken all at once by the loop, so there is no ABA
+        auto* node = new Discarded{ std::move(event), _discarded.load(std::memory_order_relaxed) };
+        while (!_discarded.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        wake();
+    }
+
+    void releaseDiscarded() {
+        Discarded* node = _discarded.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            delete std::exchange(node, node->next);
+        }
     }
 
-    void _scheduleIsrImpl(auto&&... args) {
+    void waitForSpace(EventRing<Event>& ring, EventLane to, Event& e) {
+        size_t i = static_cast<size_t>(to);
+        counters(to).blocked++;
+        _spaceWaiters[i]++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ring.tryPush(std::move(e))) {
+            xSemaphoreTake(_space[i], portMAX_DELAY);
+        }
+        // A single give may have been meant for several producers, pass it on
+        if (--_spaceWaiters[i] > 0 && ring.size() < ring.capacity()) {
+            xSemaphoreGive(_space[i]);
+        }
+    }
+
+    bool _scheduleImpl(EventLane to, OverflowPolicy policy, auto&&... args) {
+        auto& ring = lane(to);
         Event e(std::forward<decltype(args)>(args)...);
-        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        auto res = xQueueSendFromISR(_eventQueue, &e, &xHigherPriorityTaskWoken);
-        if (res != pdPASS) {
-            // TODO: handle error
-            return;
+        if (!ring.tryPush(std::move(e))) {
+            // The loop would wait for itself
+            if (policy == OverflowPolicy::Block && onLoopTask()) {
+                policy = OverflowPolicy::DropNewest;
+            }
+
+            switch (policy) {
+                case OverflowPolicy::Block:
+                    waitForSpace(ring, to, e);
+                    break;
+                case OverflowPolicy::DropOldest:
+                    while (!ring.tryPush(std::move(e))) {
+                        Event oldest;
+                        if (ring.tryPop(oldest)) {
+                            counters(to).dropped++;
+                            discard(std::move(oldest));
+                        }
+                    }
+                    break;
+                case OverflowPolicy::DropNewest:
+                    counters(to).dropped++;
+                    return false;
+            }
+        }
+        _stats.observeDepth(static_cast<size_t>(to), ring.size());
+        wake();
+        return true;
+    }
+
+    // Full lanes drop the new event, waiting or freeing memory is not possible here
+    bool _scheduleIsrImpl(EventLane to, auto&&... args) {
+        // Constructed in the slot, function pointer events stay inline
+        if (!lane(to).tryEmplace(std::forward<decltype(args)>(args)...)) {
+            counters(to).dropped++;
+            return false;
+        }
+        _stats.observeDepth(static_cast<size_t>(to), lane(to).size());
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_sleeping.exchange(false)) {
+            return true;
         }
-        e.release();
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(_wakeup, &xHigherPriorityTaskWoken);
         if (xHigherPriorityTaskWoken) {
             portYIELD_FROM_ISR();
         }
+        return true;
+    }
+
+    // Whether the event has to be queued, false if it was coalesced
+    bool admit(EventSource& source) {
+        source.scheduled++;
+        if (source.coalesce && source.pending.exchange(true)) {
+            source.coalesced++;
+            counters(source.lane).coalesced++;
+            return false;
+        }
+        return true;
+    }
+
+    bool settle(EventSource& source, bool queued) {
+        if (!queued) {
+            source.dropped++;
+        }
+        return queued;
     }
 public:
 
     FreeRTOSEventQueueFeature() {
-        _eventQueue = xQueueCreate(64, sizeof(Event));
+        _wakeup = xSemaphoreCreateBinary();
+        for (auto& space : _space) {
+            space = xSemaphoreCreateBinary();
+        }
     }
 
     /**
-     * @brief Check the event queue and return the first event
+     * @brief Check the event queue and return the next batch of events
+     *
+     * The returned event runs the queued events back to back until the batch
+     * is done or the time slice runs out. The rest is kept for the next call,
+     * so timers and microtasks get their turn in between.
+     *
      * @param wait Wait for event if no event is available
      * @return Event or std::nullopt if no event is available
      */
     std::optional<Event> getEvent(bool wait) {
-        auto e(dequeue(wait));
-        if (!e) {
+        _loopTask.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+        if (_batchBegin == _batchEnd && !refill(wait)) {
             return std::nullopt;
         }
-        return e;
+        return Event([this]() { runBatch(); });
+    }
+
+    /**
+     * @brief Configure how events are batched
+     * @param maxEvents Events taken from the queue at once, 1 runs every
+     *                  event in its own loop iteration
+     * @param timeSlice Time after which the rest of a batch waits for the
+     *                  next loop iteration
+     */
+    void setEventBatching(size_t maxEvents, std::chrono::microseconds timeSlice) {
+        _batchLimit = std::clamp<size_t>(maxEvents, 1, MAX_BATCH);
+        _timeSliceUs = timeSlice.count();
+    }
+
+    /**
+     * @brief Number of events waiting in a lane
+     */
+    size_t pendingEvents(EventLane lane) const {
+        return _lanes[static_cast<size_t>(lane)].size();
+    }
+
+    /**
+     * @brief Occupancy and overflow counters of a lane
+     */
+    EventLaneStats laneStats(EventLane lane) const {
+        size_t i = static_cast<size_t>(lane);
+        return {
+            _lanes[i].size(),
+            _lanes[i].capacity(),
+            _counters[i].dropped.load(),
+            _counters[i].coalesced.load(),
+            _counters[i].blocked.load(),
+        };
+    }
+
+    /**
+     * @brief Latency, run time and queue depth statistics of the loop
+     */
+    EventStats& eventStats() {
+        return _stats;
+    }
+
+    /**
+     * @brief Publish the statistics on the device-link stats channel
+     * @param interval Minimum time between two records, zero stops
+     *                 streaming. A record is sent after the batch that
+     *                 passes the interval, an idle loop sends nothing.
+     */
+    void streamEventStats(std::chrono::milliseconds interval) {
+        _streamIntervalUs = std::chrono::duration_cast<std::chrono::microseconds>(interval).count();
+        _lastPublish = esp_timer_get_time();
     }
 
     /**
      * @brief Schedule an event to be run
-     * @param func Function to be run
+     * @param func Function to be run, called with the time of scheduling if
+     *             it accepts a TimePoint
+     * @param lane Priority lane of the event
      */
-    void scheduleEvent(std::function<void()> func) { _scheduleImpl(std::move(func)); }
+    template<class F>
+    void scheduleEvent(F&& func, EventLane lane = EventLane::Normal) { _scheduleImpl(lane, OverflowPolicy::Block, std::forward<F>(func)); }
 
     /**
      * @brief Schedule an event to be run
      * @param func Function to be run
      * @param arg Argument to be passed to function
+     * @param lane Priority lane of the event
      */
-    void scheduleEvent(void(*func)(void*), void* arg) { _scheduleImpl(func, arg); }
+    void scheduleEvent(void(*func)(void*), void* arg, EventLane lane = EventLane::Normal) { _scheduleImpl(lane, OverflowPolicy::Block, func, arg); }
 
     /**
      * @brief Schedule an event to be run
      * @param func Function to be run
+     * @param arg Argument to be passed to function
+     * @param lane Priority lane of the event
      */
-    void scheduleEvent(std::function<void(TimePoint)> func) { _scheduleImpl(std::move(func)); }
+    void scheduleEvent(void(*func)(void*, TimePoint), void* arg, EventLane lane = EventLane::Normal) { _scheduleImpl(lane, OverflowPolicy::Block, func, arg); }
 
     /**
-     * @brief Schedule an event to be run
+     * @brief Schedule an event to be run from ISR
      * @param func Function to be run
      * @param arg Argument to be passed to function
+     * @param lane Priority lane of the event
      */
-    void scheduleEvent(void(*func)(void*, TimePoint), void* arg) { _scheduleImpl(func, arg); }
+    void scheduleEventISR(void(*func)(void*), void* arg, EventLane lane = EventLane::RealTime) { _scheduleIsrImpl(lane, func, arg); }
 
     /**
      * @brief Schedule an event to be run from ISR
      * @param func Function to be run
      * @param arg Argument to be passed to function
+     * @param lane Priority lane of the event
      */
-    void scheduleEventISR(void(*func)(void*), void* arg) { _scheduleIsrImpl(func, arg); }
+    void scheduleEventISR(void(*func)(void*, TimePoint), void* arg, EventLane lane = EventLane::RealTime) { _scheduleIsrImpl(lane, func, arg); }
 
     /**
-     * @brief Schedule an event to be run from ISR
+     * @brief Schedule an event of a source, using its lane and policy
+     * @param source Source of the event
+     * @param func Function to be run, called with the time of scheduling if
+     *             it accepts a TimePoint
+     * @return False if the event was dropped
+     */
+    template<class F>
+    bool scheduleEvent(EventSource& source, F&& func) {
+        if (!admit(source)) {
+            return true;
+        }
+        typename Event::FromSource from{ source.statSlot };
+        if (!source.coalesce) {
+            return settle(source, _scheduleImpl(source.lane, source.policy, from, std::forward<F>(func)));
+        }
+        using D = std::decay_t<F>;
+        return settle(source, _scheduleImpl(source.lane, source.policy, from,
+            [guard = PendingGuard(&source.pending), f = D(std::forward<F>(func))](TimePoint time) mutable {
+                // Cleared first, anything arriving during the callback schedules again
+                guard.clear();
+                if constexpr (std::is_invocable_v<D&, TimePoint>) {
+                    f(time);
+                }
+                else {
+                    f();
+                }
+            }));
+    }
+
+    /**
+     * @brief Schedule an event of a source from ISR, a full lane always
+     *        drops the new event
+     * @param source Source of the event
      * @param func Function to be run
      * @param arg Argument to be passed to function
+     * @return False if the event was dropped
      */
-    void scheduleEventISR(void(*func)(void*, TimePoint), void* arg) { _scheduleIsrImpl(func, arg); }
+    bool scheduleEventISR(EventSource& source, void(*func)(void*), void* arg) {
+        if (!admit(source)) {
+            return true;
+        }
+        typename Event::FromSource from{ source.statSlot };
+        if (!source.coalesce) {
+            return settle(source, _scheduleIsrImpl(source.lane, from, func, arg));
+        }
+        return settle(source, _scheduleIsrImpl(source.lane, from,
+            [guard = PendingGuard(&source.pending), func, arg](TimePoint) mutable {
+                guard.clear();
+                func(arg);
+            }));
+    }
 
     /**
      * @brief Wake up event loop if it is waiting for events
      */
     void notifyEventLoop() {
-        Event e;
-        xQueueSend(_eventQueue, &e, 0);
+        xSemaphoreGive(_wakeup);
     }
 
     ~FreeRTOSEventQueueFeature() {
-        drain();
-        vQueueDelete(_eventQueue);
+        releaseDiscarded();
+        for (auto space : _space) {
+            vSemaphoreDelete(space);
+        }
+        vSemaphoreDelete(_wakeup);
     }
 };
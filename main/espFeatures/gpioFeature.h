@@ -5,14 +5,20 @@
 #include <jac/machine/machine.h>
 #include <jac/machine/values.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <map>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include "../util/capsAllocator.h"
+#include "../util/eventRing.h"
+#include "freeRTOSEventQueue.h"
 
 #include "driver/gpio.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/portmacro.h"
 #include "freertos/task.h"
@@ -49,45 +55,47 @@ struct jac::ConvTraits<PinMode> {
 
 namespace detail {
 
-    using Callback_t = std::function<void(std::chrono::time_point<std::chrono::steady_clock>)>;
+    // Called with the time of the edge and the level read right after it
+    using Callback_t = std::function<void(std::chrono::time_point<std::chrono::steady_clock>, int)>;
 
-    template<size_t N>
-    class InterruptQueue {
-        using ArrayType = std::array<std::shared_ptr<Callback_t>, N>;
-        ArrayType queue;
-        std::atomic<typename ArrayType::iterator> head = queue.begin();
-        std::atomic<typename ArrayType::iterator> tail = queue.begin();
+    // Edge recorded by the interrupt, callbacks are resolved in the event loop
+    struct GpioEdge {
+        int64_t time; // esp_timer microseconds
+        uint8_t pin;
+        uint8_t level;
+    };
 
-        auto next(ArrayType::iterator it) {
-            it++;
-            return it == queue.end() ? queue.begin() : it;
-        }
+    // Called with the edges collected since the last call and the number of edges lost meanwhile
+    using BatchCallback_t = std::function<void(std::span<const GpioEdge>, uint32_t)>;
 
-    public:
-        bool push(std::shared_ptr<Callback_t> callback) {
-            auto t = tail.load();
-            if (next(t) == head) {
-                return false;
-            }
-            *t = callback;
-            tail = next(t);
-            return true;
-        }
+    inline uint8_t interruptBit(InterruptMode mode) {
+        return 1 << static_cast<int>(mode);
+    }
 
-        std::shared_ptr<Callback_t> pop() {
-            auto h = head.load();
-            if (h == tail) {
-                return nullptr;
-            }
-            auto callback = *h;
-            *h = nullptr;
-            head = next(h);
-            return callback;
-        }
+    inline bool wantsEdge(uint8_t modes, bool risingEdge) {
+        return modes & (interruptBit(InterruptMode::CHANGE) | interruptBit(risingEdge ? InterruptMode::RISING : InterruptMode::FALLING));
+    }
 
-        bool empty() {
-            return head == tail;
-        }
+    /**
+     * Edges of a pin collected for a batched handler, delivered at most once
+     * per interval. Kept until the Gpio is destroyed, so an interrupt, timer
+     * or event still holding it never sees it freed.
+     */
+    struct EdgeBatch {
+        static constexpr size_t CAPACITY = 256;
+
+        EventRing<GpioEdge> edges{CAPACITY};
+        EventSource events{EventLane::RealTime, OverflowPolicy::DropNewest, false, "gpio.batch"};
+        InterruptMode mode = InterruptMode::DISABLE;
+        std::atomic<uint8_t> modes = 0;      // mode of the handler, read by the interrupt
+        std::atomic<bool> scheduled = false; // delivery event or timer pending
+        std::atomic<uint32_t> dropped = 0;   // edges lost to a full ring
+        uint32_t reported = 0;               // dropped edges already delivered
+        std::shared_ptr<BatchCallback_t> callback;
+        int64_t interval = 0;
+        int64_t lastDelivery = 0;
+        esp_timer_handle_t timer = nullptr;
+        void* owner = nullptr;
     };
 
     template<typename Holder>
@@ -97,14 +105,13 @@ namespace detail {
         std::shared_ptr<Callback_t> rising;
         std::shared_ptr<Callback_t> falling;
         std::shared_ptr<Callback_t> change;
+        std::atomic<uint8_t> modes = 0; // attached modes, read by the interrupt
         gpio_num_t pin;
         TickType_t lastTime = 0;
         bool lastRising = false;
         Holder* holder;
-    public:
-        Interrupts(gpio_num_t pin, Holder* holder) : pin(pin), holder(holder) {}
 
-        std::shared_ptr<Callback_t>& operator[](InterruptMode mode) {
+        std::shared_ptr<Callback_t>& slot(InterruptMode mode) {
             switch (mode) {
                 case InterruptMode::RISING:
                     return rising;
@@ -116,9 +123,33 @@ namespace detail {
                     throw std::runtime_error("Invalid interrupt mode");
             }
         }
+    public:
+        std::atomic<uint32_t> dropped = 0; // edges lost to a full edge queue
+        std::atomic<EdgeBatch*> batch = nullptr; // batched handler, read by the interrupt
+
+        Interrupts(gpio_num_t pin, Holder* holder) : pin(pin), holder(holder) {}
+
+        const std::shared_ptr<Callback_t>& operator[](InterruptMode mode) {
+            return slot(mode);
+        }
+
+        void set(InterruptMode mode, std::shared_ptr<Callback_t> callback) {
+            if (callback) {
+                modes |= interruptBit(mode);
+            }
+            else {
+                modes &= ~interruptBit(mode);
+            }
+            slot(mode) = std::move(callback);
+        }
 
         operator bool() const {
-            return rising || falling || change;
+            return rising || falling || change || batch.load();
+        }
+
+        // Whether an edge in the given direction has a callback, safe from the interrupt
+        bool wants(bool risingEdge) const {
+            return wantsEdge(modes.load(std::memory_order_relaxed), risingEdge);
         }
 
         gpio_num_t getPin() const {
@@ -147,71 +178,204 @@ template<class GpioFeature>
 class Gpio {
     struct Holder;
 
-    using InterruptQueue_ = detail::InterruptQueue<32>;
     using Interrupts_ = detail::Interrupts<Holder>;
+    using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
+
+    static constexpr size_t EDGE_QUEUE_SIZE = 64;
 
+    // Everything the interrupt touches, kept in internal memory
     struct Holder {
-        InterruptQueue_ _interruptQueue;
+        EventRing<detail::GpioEdge> _edges{EDGE_QUEUE_SIZE};
+        EventSource _edgeEvents{EventLane::RealTime, OverflowPolicy::DropNewest, true, "gpio"};
         std::map<int, Interrupts_> _interruptCallbacks;
-        TaskHandle_t shovelTaskHandle = nullptr;
+        Gpio* gpio = nullptr;
     };
     std::unique_ptr<Holder, EspCapsDeleter<MALLOC_CAP_INTERNAL, Holder>> _holder;
 
+    using EdgeBatchPtr = std::unique_ptr<detail::EdgeBatch, EspCapsDeleter<MALLOC_CAP_INTERNAL, detail::EdgeBatch>>;
+    std::map<int, EdgeBatchPtr> _batches;
+    std::vector<detail::GpioEdge> _batchEdges;
+
     GpioFeature* _feature;
-    std::atomic<bool> stopShovel{false};
-
-    static void shovel(void* pvParameters) {
-        auto& gpio = *static_cast<Gpio*>(pvParameters);
-        while (true) {
-            auto res = xTaskNotifyWait(pdFALSE, ULONG_MAX, nullptr, portMAX_DELAY);
-            if (gpio.stopShovel) {
-                vTaskDelete(nullptr);
-                return;
+
+    static void isr(void* arg) {
+        int64_t time = esp_timer_get_time();
+        auto& callbacks = *static_cast<Interrupts_*>(arg);
+        auto& holder = *callbacks.getHolder();
+
+        bool risingEdge = gpio_get_level(callbacks.getPin()) == 1;
+        if (!callbacks.updateLast(risingEdge)) {
+            return;
+        }
+
+        detail::GpioEdge edge{ time, static_cast<uint8_t>(callbacks.getPin()), static_cast<uint8_t>(risingEdge) };
+        if (callbacks.wants(risingEdge)) {
+            if (!holder._edges.tryPush(detail::GpioEdge(edge))) {
+                callbacks.dropped++;
             }
-            if (res == pdFALSE) {
-                continue;
+            // Also when full, the queued edges may still wait for their event
+            holder.gpio->_feature->scheduleEventISR(holder._edgeEvents, dispatch, holder.gpio);
+        }
+
+        auto* batch = callbacks.batch.load(std::memory_order_acquire);
+        if (batch && detail::wantsEdge(batch->modes.load(std::memory_order_relaxed), risingEdge)) {
+            if (!batch->edges.tryPush(std::move(edge))) {
+                batch->dropped++;
             }
-            auto& queue = gpio._holder->_interruptQueue;
-            while (!queue.empty()) {
-                auto callback = queue.pop();
-                gpio._feature->scheduleEvent([callback]() {
-                    auto now = std::chrono::steady_clock::now();
-                    (*callback)(now);
-                });
+            if (!batch->scheduled.exchange(true) && !holder.gpio->_feature->scheduleEventISR(batch->events, deliver, batch)) {
+                batch->scheduled = false;
             }
         }
     }
+
+    /**
+     * Runs in the event loop. The event is coalescing and rescheduled by any
+     * edge arriving once it started, so taking at most a queue worth of
+     * edges leaves nothing behind.
+     */
+    static void dispatch(void* arg) {
+        auto& gpio = *static_cast<Gpio*>(arg);
+        auto& callbacks = gpio._holder->_interruptCallbacks;
+        detail::GpioEdge edge;
+        for (size_t i = 0; i < EDGE_QUEUE_SIZE && gpio._holder->_edges.tryPop(edge); ++i) {
+            auto time = TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::microseconds(edge.time)));
+            for (auto mode : { InterruptMode::CHANGE, edge.level ? InterruptMode::RISING : InterruptMode::FALLING }) {
+                // Looked up for every call, a callback may detach handlers
+                auto it = callbacks.find(edge.pin);
+                if (it == callbacks.end()) {
+                    break;
+                }
+                auto callback = (it->second)[mode];
+                if (callback) {
+                    (*callback)(time, edge.level);
+                }
+            }
+        }
+    }
+
+    /**
+     * Runs in the esp_timer task, which must not wait for room in the
+     * queue. A full lane retries after another interval, and if even the
+     * timer fails, the next edge schedules the delivery.
+     */
+    static void onBatchTimer(void* arg) {
+        auto* batch = static_cast<detail::EdgeBatch*>(arg);
+        auto* feature = static_cast<Gpio*>(batch->owner)->_feature;
+        if (feature->scheduleEvent(batch->events, [arg]() { deliver(arg); })) {
+            return;
+        }
+        if (esp_timer_start_once(batch->timer, std::max<int64_t>(batch->interval, 1000)) != ESP_OK) {
+            batch->scheduled = false;
+        }
+    }
+
+    /**
+     * Runs in the event loop. Until the interval since the last delivery
+     * passes, the batch stays scheduled and a timer brings it back, so the
+     * interrupt does not queue an event for every edge in the meantime.
+     */
+    static void deliver(void* arg) {
+        auto& batch = *static_cast<detail::EdgeBatch*>(arg);
+        auto& gpio = *static_cast<Gpio*>(batch.owner);
+
+        int64_t now = esp_timer_get_time();
+        int64_t wait = batch.lastDelivery + batch.interval - now;
+        if (wait > 0 && esp_timer_start_once(batch.timer, wait) == ESP_OK) {
+            return;
+        }
+        batch.lastDelivery = now;
+        // Cleared before draining, an edge arriving meanwhile schedules the next delivery
+        batch.scheduled = false;
+
+        auto& edges = gpio._batchEdges;
+        edges.clear();
+        detail::GpioEdge edge;
+        while (edges.size() < detail::EdgeBatch::CAPACITY && batch.edges.tryPop(edge)) {
+            edges.push_back(edge);
+        }
+        uint32_t dropped = batch.dropped.load();
+        uint32_t lost = dropped - batch.reported;
+        batch.reported = dropped;
+
+        // Kept alive, the handler may detach itself
+        auto callback = batch.callback;
+        if (callback && (!edges.empty() || lost > 0)) {
+            (*callback)(std::span<const detail::GpioEdge>(edges), lost);
+        }
+    }
+
+    detail::EdgeBatch& edgeBatch(int pinNum) {
+        auto it = _batches.find(pinNum);
+        if (it != _batches.end()) {
+            return *it->second;
+        }
+
+        EspCapsAllocator<MALLOC_CAP_INTERNAL, detail::EdgeBatch> alloc;
+        auto mem = alloc.allocate(1);
+        alloc.construct(mem);
+        EdgeBatchPtr batch(mem);
+        batch->owner = this;
+
+        esp_timer_create_args_t args{};
+        args.callback = onBatchTimer;
+        args.arg = static_cast<void*>(batch.get());
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "gpio_batch";
+
+        esp_err_t err = esp_timer_create(&args, &batch->timer);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+        return *_batches.emplace(pinNum, std::move(batch)).first->second;
+    }
+
+    static InterruptMode eventMode(const std::string& event) {
+        if (event == "rising") {
+            return InterruptMode::RISING;
+        }
+        if (event == "falling") {
+            return InterruptMode::FALLING;
+        }
+        if (event == "change") {
+            return InterruptMode::CHANGE;
+        }
+        throw std::runtime_error("Invalid event");
+    }
+
+    Interrupts_& interrupts(int pinNum) {
+        gpio_num_t pin = GpioFeature::getInterruptPin(pinNum);
+
+        auto it = _holder->_interruptCallbacks.find(pinNum);
+        if (it == _holder->_interruptCallbacks.end()) {
+            it = _holder->_interruptCallbacks.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(pinNum),
+                std::forward_as_tuple(pin, _holder.get())
+            ).first;
+            gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+            gpio_isr_handler_add(pin, isr, &(it->second));
+            gpio_intr_enable(pin);
+        }
+        return it->second;
+    }
+
+    static bool attached(Interrupts_& callbacks, InterruptMode mode) {
+        auto* batch = callbacks.batch.load();
+        return callbacks[mode] || (batch && batch->mode == mode);
+    }
 public:
     Gpio(GpioFeature* feature) : _feature(feature) {
         EspCapsAllocator<MALLOC_CAP_INTERNAL, Holder> alloc;
         auto mem = alloc.allocate(1);
         alloc.construct(mem);
         _holder.reset(mem);
-
-        auto res = xTaskCreate(
-            shovel,
-            "gpio_shovel",
-            2048,
-            this,
-            tskIDLE_PRIORITY + 1,
-            &_holder->shovelTaskHandle
-        );
-        if (res != pdPASS) {
-            throw std::runtime_error("Failed to create GPIO shovel task");
-        }
+        _holder->gpio = this;
     }
 
     ~Gpio() {
-        stopShovel = true;
-        if (_holder->shovelTaskHandle) {
-            xTaskNotify(_holder->shovelTaskHandle, 0, eNoAction);
-            while (true) {
-                eTaskState state = eTaskGetState(_holder->shovelTaskHandle);
-                if (state == eDeleted || state == eInvalid) {
-                    break;
-                }
-                vTaskDelay(10 / portTICK_PERIOD_MS);
-            }
+        for (auto& [pin, batch] : _batches) {
+            esp_timer_stop(batch->timer);
+            esp_timer_delete(batch->timer);
         }
     }
 
@@ -252,68 +416,69 @@ public:
     }
 
     void attachInterrupt(int pinNum, InterruptMode mode, detail::Callback_t callback) {
-        gpio_num_t pin = GpioFeature::getInterruptPin(pinNum);
-
-        auto it = _holder->_interruptCallbacks.find(pinNum);
-        if (it == _holder->_interruptCallbacks.end()) {
-            it = _holder->_interruptCallbacks.emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(pinNum),
-                std::forward_as_tuple(pin, _holder.get())
-            ).first;
-            gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
-            gpio_isr_handler_add(pin, [](void* arg) {
-                auto& callbacks = *static_cast<Interrupts_*>(arg);
-                auto& holder = *callbacks.getHolder();
-                auto& interruptQueue = holder._interruptQueue;
-
-                bool risingEdge = gpio_get_level(callbacks.getPin()) == 1;
-                if (!callbacks.updateLast(risingEdge)) {
-                    return;
-                }
+        auto& callbacks = interrupts(pinNum);
+        if (attached(callbacks, mode)) {
+            throw std::runtime_error("Interrupt already attached");
+        }
 
-                bool generated = false;
-                if (callbacks[InterruptMode::CHANGE]) {
-                    interruptQueue.push(callbacks[InterruptMode::CHANGE]);
-                    generated = true;
-                }
-                if (callbacks[InterruptMode::RISING] && risingEdge) {
-                    interruptQueue.push(callbacks[InterruptMode::RISING]);
-                    generated = true;
-                }
-                if (callbacks[InterruptMode::FALLING] && !risingEdge) {
-                    interruptQueue.push(callbacks[InterruptMode::FALLING]);
-                    generated = true;
-                }
+        EspCapsAllocator<MALLOC_CAP_INTERNAL, detail::Callback_t> alloc;
+        callbacks.set(mode, std::allocate_shared<detail::Callback_t>(alloc, std::move(callback)));
+    }
 
-                if (generated) {
-                    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                    xTaskNotifyFromISR(holder.shovelTaskHandle, 0, eNoAction, &xHigherPriorityTaskWoken);
-                    if (xHigherPriorityTaskWoken) {
-                        portYIELD_FROM_ISR();
-                    }
-                }
-            }, &(it->second));
-            gpio_intr_enable(pin);
+    /**
+     * @brief Attach a handler receiving the edges of a pin in batches
+     * @param maxRate Maximum number of calls per second
+     */
+    void attachBatchedInterrupt(int pinNum, InterruptMode mode, int maxRate, detail::BatchCallback_t callback) {
+        if (maxRate <= 0) {
+            throw std::runtime_error("Invalid maximum callback rate");
         }
+        GpioFeature::getInterruptPin(pinNum);
 
-        if ((it->second)[mode]) {
-            throw std::runtime_error("Interrupt already attached");
+        auto it = _holder->_interruptCallbacks.find(pinNum);
+        if (it != _holder->_interruptCallbacks.end()) {
+            if (attached(it->second, mode)) {
+                throw std::runtime_error("Interrupt already attached");
+            }
+            if (it->second.batch.load()) {
+                throw std::runtime_error("Only one batched interrupt per pin");
+            }
         }
 
-        EspCapsAllocator<MALLOC_CAP_INTERNAL, detail::Callback_t> alloc;
-        (it->second)[mode] = std::allocate_shared<detail::Callback_t>(alloc, std::move(callback));
+        auto& batch = edgeBatch(pinNum);
+        // Edges left from a previous handler are not delivered to this one
+        detail::GpioEdge stale;
+        while (batch.edges.tryPop(stale)) {}
+        batch.reported = batch.dropped.load();
+
+        EspCapsAllocator<MALLOC_CAP_INTERNAL, detail::BatchCallback_t> alloc;
+        batch.callback = std::allocate_shared<detail::BatchCallback_t>(alloc, std::move(callback));
+        batch.interval = 1000000 / maxRate;
+        batch.mode = mode;
+        batch.modes = detail::interruptBit(mode);
+        _batchEdges.reserve(detail::EdgeBatch::CAPACITY);
+
+        interrupts(pinNum).batch.store(&batch, std::memory_order_release);
     }
 
     void detachInterrupt(int pinNum, InterruptMode mode) {
         gpio_num_t pin = GpioFeature::getInterruptPin(pinNum);
 
         auto it = _holder->_interruptCallbacks.find(pinNum);
-        if (it == _holder->_interruptCallbacks.end() || !(it->second)[mode]) {
+        if (it == _holder->_interruptCallbacks.end() || !attached(it->second, mode)) {
             throw std::runtime_error("Interrupt not attached");
         }
 
-        (it->second)[mode] = nullptr;
+        auto* batch = it->second.batch.load();
+        if (batch && batch->mode == mode) {
+            it->second.batch = nullptr;
+            batch->modes = 0;
+            batch->mode = InterruptMode::DISABLE;
+            batch->callback = nullptr;
+        }
+        else {
+            (it->second).set(mode, nullptr);
+        }
 
         if (!it->second) {
             gpio_intr_disable(pin);
@@ -323,33 +488,25 @@ public:
     }
 
     void on(std::string event, int pinNum, detail::Callback_t callback) {
-        if (event == "rising") {
-            attachInterrupt(pinNum, InterruptMode::RISING, std::move(callback));
-        }
-        else if (event == "falling") {
-            attachInterrupt(pinNum, InterruptMode::FALLING, std::move(callback));
-        }
-        else if (event == "change") {
-            attachInterrupt(pinNum, InterruptMode::CHANGE, std::move(callback));
-        }
-        else {
-            throw std::runtime_error("Invalid event");
-        }
+        attachInterrupt(pinNum, eventMode(event), std::move(callback));
+    }
+
+    void onBatched(std::string event, int pinNum, int maxRate, detail::BatchCallback_t callback) {
+        attachBatchedInterrupt(pinNum, eventMode(event), maxRate, std::move(callback));
+    }
+
+    /**
+     * @brief Number of edges of a pin lost to a full edge queue since its
+     *        first handler was attached, batched handlers get their own
+     *        count with every call
+     */
+    uint32_t droppedEdges(int pinNum) {
+        auto it = _holder->_interruptCallbacks.find(pinNum);
+        return it == _holder->_interruptCallbacks.end() ? 0 : it->second.dropped.load();
     }
 
     void off(std::string event, int pinNum) {
-        if (event == "rising") {
-            detachInterrupt(pinNum, InterruptMode::RISING);
-        }
-        else if (event == "falling") {
-            detachInterrupt(pinNum, InterruptMode::FALLING);
-        }
-        else if (event == "change") {
-            detachInterrupt(pinNum, InterruptMode::CHANGE);
-        }
-        else {
-            throw std::runtime_error("Invalid event");
-        }
+        detachInterrupt(pinNum, eventMode(event));
     }
 };
 
@@ -358,6 +515,10 @@ template<class Next>
 class GpioFeature : public Next {
     using PinConfig = Next::PlatformInfo::PinConfig;
     using Gpio_ = Gpio<GpioFeature>;
+
+    static constexpr int DEFAULT_BATCH_RATE = 50;
+
+    std::vector<double> _batchValues;
 public:
     Gpio_ gpio;
 
@@ -388,15 +549,50 @@ public:
         pinModeEnum.set("INPUT_PULLDOWN", static_cast<int>(PinMode::INPUT_PULLDOWN));
         module.addExport("PinMode", pinModeEnum);
 
-        module.addExport("on", ff.newFunction([this](std::string event, int pin, jac::Function callback) {
-            this->gpio.on(event, pin, [this, callback = std::move(callback)](Next::TimePoint timestamp) mutable {
-                jac::Object info = jac::Object::create(this->context());
-                info.set("timestamp", this->createTimestamp(timestamp));
+        module.addExport("on", ff.newFunctionVariadic([this](std::vector<jac::ValueWeak> args) {
+            if (args.size() < 3 || args.size() > 4) {
+                throw std::runtime_error("Invalid number of arguments");
+            }
+
+            std::string event = args[0].to<std::string>();
+            int pin = args[1].to<int>();
+            jac::Function callback = args[2].to<jac::Function>();
+
+            bool batched = false;
+            int maxRate = DEFAULT_BATCH_RATE;
+            if (args.size() == 4 && !args[3].isUndefined()) {
+                jac::Object options = args[3].to<jac::Object>();
+                if (options.hasProperty("batched")) {
+                    batched = options.get<bool>("batched");
+                }
+                if (options.hasProperty("maxRate")) {
+                    maxRate = options.get<int>("maxRate");
+                }
+            }
 
-                callback.call<void>(info);
+            if (!batched) {
+                this->gpio.on(event, pin, [this, callback = std::move(callback)](Next::TimePoint timestamp, int level) mutable {
+                    jac::Object info = jac::Object::create(this->context());
+                    info.set("timestamp", this->createTimestamp(timestamp));
+                    info.set("level", level);
+
+                    callback.call<void>(info);
+                });
+                return;
+            }
+
+            // One Float64Array of (microseconds, level) pairs per call, nothing allocated per edge
+            this->gpio.onBatched(event, pin, maxRate, [this, callback = std::move(callback)](std::span<const detail::GpioEdge> edges, uint32_t dropped) mutable {
+                _batchValues.resize(edges.size() * 2);
+                for (size_t i = 0; i < edges.size(); ++i) {
+                    _batchValues[2 * i] = static_cast<double>(edges[i].time);
+                    _batchValues[2 * i + 1] = edges[i].level;
+                }
+                callback.call<void>(this->toFloat64Array(_batchValues), static_cast<int>(dropped));
             });
         }));
         module.addExport("off", ff.newFunction(noal::function(&Gpio_::off, &gpio)));
+        module.addExport("droppedEdges", ff.newFunction(noal::function(&Gpio_::droppedEdges, &gpio)));
     }
 
     GpioFeature() : gpio(this) {}
@@ -0,0 +1,337 @@
+#pragma once
+
+#include "soc/soc_caps.h"
+
+// The panel is driven by the i80 LCD peripheral, which the ESP32-C3 lacks
+#if SOC_LCD_I80_SUPPORTED
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp_lcd_panel_io.h"
+
+#include "../util/capsAllocator.h"
+#include "../util/hub75Encoder.h"
+#include "../util/iDisplayHolder.h"
+#include "displayBindings.h"
+
+
+struct Hub75Pins {
+    int r1 = 25, g1 = 26, b1 = 27;
+    int r2 = 14, g2 = 12, b2 = 13;
+    int a = 23, b = 19, c = 5, d = 17, e = -1;
+    int lat = 4, oe = 15, clk = 16;
+};
+
+struct Hub75Options {
+    Hub75Config panel;
+    Hub75Pins pins;
+    int clockHz = 10'000'000;
+};
+
+
+/**
+ * HUB75 panel chain refreshed by the LCD peripheral (I2S LCD mode on ESP32,
+ * LCD_CAM on ESP32-S3) through the esp_lcd i80 bus.
+ *
+ * Frames are encoded into bit planes by Hub75Encoder, a refresh thread keeps
+ * queueing the whole stream so the DMA never idles. Writes land in the stream
+ * being shown, there is no second buffer to flip.
+ */
+class Hub75Display : public IDisplayHolder {
+    using Encoder = BasicHub75Encoder<EspCapsAllocator<MALLOC_CAP_DMA, uint16_t>>;
+
+    // Bus lines without a HUB75 signal
+    static constexpr uint16_t PADDING_LINES = (1 << 6) | (1 << 7) | (1 << 15);
+
+    Hub75Options _options;
+    Encoder _encoder;
+
+    esp_lcd_i80_bus_handle_t _bus = nullptr;
+    esp_lcd_panel_io_handle_t _io = nullptr;
+    std::thread _refreshThread;
+    std::atomic<bool> _running = false;
+
+    static Hub75Config encoderConfig(const Hub75Options& options) {
+        Hub75Config config = options.panel;
+        // The bus drives all 16 lines, unused ones share the OE pin and repeat its level
+        config.oeMirror = PADDING_LINES | (options.pins.e < 0 ? 1 << (Hub75Encoder::ADDR_SHIFT + 4) : 0);
+        return config;
+    }
+
+    void refreshLoop() {
+        while (_running) {
+            // Blocks while the transaction queue is full, keeping one frame in flight behind the other
+            esp_err_t err = esp_lcd_panel_io_tx_color(_io, -1, _encoder.stream(), _encoder.streamBytes());
+            if (err != ESP_OK) {
+                jac::Logger::error(std::string("Hub75: refresh failed: ") + esp_err_to_name(err));
+                _running = false;
+            }
+        }
+    }
+
+    void release() {
+        if (_io) {
+            esp_lcd_panel_io_del(_io);
+            _io = nullptr;
+        }
+        if (_bus) {
+            esp_lcd_del_i80_bus(_bus);
+            _bus = nullptr;
+        }
+    }
+
+public:
+    Hub75Display(const Hub75Options& options):
+        _options(options),
+        _encoder(encoderConfig(options))
+    {}
+
+    Hub75Display(const Hub75Display&) = delete;
+    Hub75Display& operator=(const Hub75Display&) = delete;
+
+    void start() override {
+        if (_running) {
+            return;
+        }
+        const Hub75Pins& p = _options.pins;
+        int e = p.e >= 0 ? p.e : p.oe;
+
+        esp_lcd_i80_bus_config_t busConfig = {};
+        busConfig.clk_src = LCD_CLK_SRC_DEFAULT;
+        busConfig.dc_gpio_num = -1;
+        busConfig.wr_gpio_num = p.clk;
+        const int lines[16] = {
+            p.r1, p.g1, p.b1, p.r2, p.g2, p.b2, p.oe, p.oe,
+            p.a, p.b, p.c, p.d, e, p.lat, p.oe, p.oe
+        };
+        for (int i = 0; i < 16; ++i) {
+            busConfig.data_gpio_nums[i] = lines[i];
+        }
+        busConfig.bus_width = 16;
+        busConfig.max_transfer_bytes = _encoder.streamBytes();
+
+        esp_err_t err = esp_lcd_new_i80_bus(&busConfig, &_bus);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+
+        esp_lcd_panel_io_i80_config_t ioConfig = {};
+        ioConfig.cs_gpio_num = -1;
+        ioConfig.pclk_hz = _options.clockHz;
+        ioConfig.trans_queue_depth = 2;
+        ioConfig.lcd_cmd_bits = 8;
+        ioConfig.lcd_param_bits = 8;
+
+        err = esp_lcd_new_panel_io_i80(_bus, &ioConfig, &_io);
+        if (err != ESP_OK) {
+            release();
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+
+        _running = true;
+        _refreshThread = std::thread([this]() noexcept {
+            refreshLoop();
+        });
+    }
+
+    void stop() {
+        _running = false;
+        if (_refreshThread.joinable()) {
+            _refreshThread.join();
+        }
+        release();
+    }
+
+    ~Hub75Display() override {
+        stop();
+    }
+
+    void clear() override {
+        _encoder.clear();
+    }
+
+    void setBrightness(uint8_t brightness) override {
+        _encoder.setBrightness(brightness);
+    }
+
+    void setGamma(float gamma) {
+        _encoder.setGamma(gamma);
+    }
+
+    bool isInitialized() const override {
+        return _running;
+    }
+
+    DisplayLayout nativeLayout() const override {
+        // Nothing is sent as is, RGB888 is the cheapest input to encode
+        return { _encoder.width(), _encoder.height(), 9, static_cast<size_t>(_encoder.width()) * 3 };
+    }
+
+    void setBuffer(const uint8_t* rawData, size_t size, int format, bool clearPrevious) override {
+        size_t frameBytes = packedColorSize(format) * _encoder.width() * _encoder.height();
+        if (clearPrevious && size < frameBytes) {
+            _encoder.clear();
+        }
+        if (!_encoder.encode(rawData, size, format)) {
+            throw std::runtime_error("Invalid color format");
+        }
+    }
+
+    void setRegion(const uint8_t* data, size_t stride, int format, const FrameRegion& region) override {
+        if (!_encoder.encodeRegion(data, stride, format, region)) {
+            throw std::runtime_error("Invalid color format");
+        }
+    }
+
+    void setBufferFromRaw(const std::vector<DisplayPixel>& pixels, bool clearPrevious) override {
+        if (clearPrevious) {
+            _encoder.clear();
+        }
+        for (const DisplayPixel& pixel : pixels) {
+            _encoder.setPixel(pixel.x, pixel.y, pixel.color);
+        }
+    }
+
+    void setPixels(const uint32_t* records, size_t count, PixelRecordLayout layout, bool clearPrevious) override {
+        if (clearPrevious) {
+            _encoder.clear();
+        }
+        DisplayUtils::forEachPackedPixel(records, count, layout, _encoder.width(), _encoder.height(),
+            [this](int x, int y, DisplayColor color) {
+                _encoder.setPixel(x, y, color);
+            });
+    }
+};
+
+
+template<class Next>
+class Hub75Feature : public Next {
+    static inline bool _inUse = false;
+
+    static void checkPin(int pin) {
+        if (Next::PlatformInfo::PinConfig::DIGITAL_PINS.find(pin) == Next::PlatformInfo::PinConfig::DIGITAL_PINS.end()) {
+            throw std::runtime_error("Invalid pin number " + std::to_string(pin));
+        }
+    }
+
+    static Hub75Options optionsFromArgs(std::vector<jac::ValueWeak>& args) {
+        Hub75Options options;
+        if (args.size() > 0 && !args[0].isUndefined()) {
+            options.panel.width = args[0].to<int>();
+        }
+        if (args.size() > 1 && !args[1].isUndefined()) {
+            options.panel.height = args[1].to<int>();
+        }
+        if (args.size() > 2 && !args[2].isUndefined()) {
+            options.panel.chain = args[2].to<int>();
+        }
+
+        if (args.size() > 3 && !args[3].isUndefined()) {
+            auto obj = args[3].to<jac::Object>();
+            if (obj.hasProperty("depth")) { options.panel.depth = obj.get<int>("depth"); }
+            if (obj.hasProperty("gamma")) { options.panel.gamma = obj.get<double>("gamma"); }
+            if (obj.hasProperty("clockHz")) { options.clockHz = obj.get<int>("clockHz"); }
+            if (obj.hasProperty("pins")) {
+                auto pins = obj.get<jac::Object>("pins");
+                Hub75Pins& p = options.pins;
+                std::pair<const char*, int*> fields[] = {
+                    { "r1", &p.r1 }, { "g1", &p.g1 }, { "b1", &p.b1 },
+                    { "r2", &p.r2 }, { "g2", &p.g2 }, { "b2", &p.b2 },
+                    { "a", &p.a }, { "b", &p.b }, { "c", &p.c }, { "d", &p.d }, { "e", &p.e },
+                    { "lat", &p.lat }, { "oe", &p.oe }, { "clk", &p.clk },
+                };
+                for (auto& [name, pin] : fields) {
+                    if (pins.hasProperty(name)) {
+                        *pin = pins.get<int>(name);
+                    }
+                }
+            }
+        }
+
+        const Hub75Pins& p = options.pins;
+        for (int pin : { p.r1, p.g1, p.b1, p.r2, p.g2, p.b2, p.a, p.b, p.c, p.d, p.lat, p.oe, p.clk }) {
+            checkPin(pin);
+        }
+        if (p.e >= 0) {
+            checkPin(p.e);
+        }
+
+        if (options.panel.width <= 0 || options.panel.chain <= 0) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "width and chainLength must be greater than 0");
+        }
+        if (options.panel.height < 2 || options.panel.height % 2 != 0 || options.panel.height > 64) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "height must be even and at most 64");
+        }
+        if (options.panel.height > 32 && p.e < 0) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "Panels taller than 32 rows need the E pin");
+        }
+        if (options.panel.depth < 1 || options.panel.depth > Hub75Encoder::MAX_DEPTH) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "depth must be between 1 and 12");
+        }
+        return options;
+    }
+
+    struct Hub75ProtoBuilder : public jac::ProtoBuilder::Opaque<Hub75Display>, public jac::ProtoBuilder::Properties {
+        static Hub75Display* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+            if (_inUse) {
+                throw std::runtime_error("The LCD peripheral is already driving a Hub75 display");
+            }
+
+            auto display = std::make_unique<Hub75Display>(optionsFromArgs(args));
+            display->start();
+            _inUse = true;
+            return display.release();
+        }
+
+        static void destroyOpaque(JSRuntime* rt, Hub75Display* ptr) noexcept {
+            if (!ptr) {
+                return;
+            }
+            DisplayProtoBindings<Hub75Display>::release(ptr);
+            delete ptr;
+            _inUse = false;
+        }
+
+        static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+            DisplayProtoBindings<Hub75Display>::addCommonProperties(ctx, proto);
+
+            jac::FunctionFactory ff(ctx);
+
+            proto.defineProperty("setGamma", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal, double gamma) {
+                if (gamma <= 0) {
+                    throw jac::Exception::create(jac::Exception::Type::RangeError, "gamma must be greater than 0");
+                }
+                Hub75ProtoBuilder::getOpaque(ctx_, thisVal)->setGamma(gamma);
+            }), jac::PropFlags::Enumerable);
+
+            proto.defineProperty("close", ff.newFunctionThis([](jac::ContextRef ctx_, jac::ValueWeak thisVal) {
+                Hub75ProtoBuilder::getOpaque(ctx_, thisVal)->stop();
+            }), jac::PropFlags::Enumerable);
+        }
+    };
+
+public:
+    using Hub75Class = jac::Class<Hub75ProtoBuilder>;
+
+    Hub75Feature() {
+        Hub75Class::init("Hub75");
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        jac::Module& mod = this->newModule("hub75");
+        mod.addExport("Hub75", Hub75Class::getConstructor(this->context()));
+    }
+};
+
+#endif // SOC_LCD_I80_SUPPORTED
@@ -0,0 +1,595 @@
+#pragma once
+
+// Needs the LCD_CAM i80 bus and a PSRAM framebuffer reachable by its DMA
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_lcd_panel_io.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "../util/bounceBuffers.h"
+#include "../util/capsAllocator.h"
+#include "../util/iDisplayHolder.h"
+#include "../util/mipiDbiPanel.h"
+#include "displayBindings.h"
+
+
+struct I80TftOptions {
+    MipiDbiConfig panel;
+    std::vector<int> data; // 8 or 16 lines, D0 first
+    int wr = -1;
+    int dc = -1;
+    int cs = -1;
+    int rd = -1;
+    int rst = -1;
+    int bl = -1;
+    int te = -1;
+    int clockHz = 20'000'000;
+    size_t bounceSize = 16 * 1024;
+};
+
+
+/**
+ * MIPI-DBI bus on the LCD peripheral in i80 mode, fed from a ring of internal
+ * DMA buffers.
+ *
+ * Every buffer goes out as its own color transaction. The memory write command
+ * requested by the panel is held back and sent with the first transaction,
+ * the following ones continue the write with RAMWRC.
+ */
+class EspI80Bus {
+    static constexpr size_t BOUNCE_COUNT = 2;
+
+    using DmaBuffer = std::vector<uint8_t, EspCapsAllocator<MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, uint8_t>>;
+
+    esp_lcd_i80_bus_handle_t _bus = nullptr;
+    esp_lcd_panel_io_handle_t _io = nullptr;
+    SemaphoreHandle_t _done = nullptr;
+
+    BounceRing _ring{ BOUNCE_COUNT };
+    std::array<DmaBuffer, BOUNCE_COUNT> _buffers;
+    size_t _bufferSize;
+    int _writeCmd = -1;
+
+    static bool IRAM_ATTR onColorDone(esp_lcd_panel_io_handle_t, esp_lcd_panel_io_event_data_t*, void* arg) {
+        auto& self = *static_cast<EspI80Bus*>(arg);
+        self._ring.complete();
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(self._done, &woken);
+        return woken == pdTRUE;
+    }
+
+    void release() {
+        if (_io) {
+            esp_lcd_panel_io_del(_io);
+            _io = nullptr;
+        }
+        if (_bus) {
+            esp_lcd_del_i80_bus(_bus);
+            _bus = nullptr;
+        }
+        if (_done) {
+            vSemaphoreDelete(_done);
+            _done = nullptr;
+        }
+    }
+
+public:
+    EspI80Bus(const I80TftOptions& options):
+        _bufferSize(options.bounceSize)
+    {
+        for (auto& buffer : _buffers) {
+            buffer.resize(_bufferSize);
+        }
+        _done = xSemaphoreCreateBinary();
+
+        esp_lcd_i80_bus_config_t busConfig = {};
+        busConfig.clk_src = LCD_CLK_SRC_DEFAULT;
+        busConfig.dc_gpio_num = options.dc;
+        busConfig.wr_gpio_num = options.wr;
+        for (size_t i = 0; i < options.data.size(); ++i) {
+            busConfig.data_gpio_nums[i] = options.data[i];
+        }
+        busConfig.bus_width = options.data.size();
+        busConfig.max_transfer_bytes = _bufferSize;
+
+        esp_err_t err = esp_lcd_new_i80_bus(&busConfig, &_bus);
+        if (err != ESP_OK) {
+            release();
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+
+        esp_lcd_panel_io_i80_config_t ioConfig = {};
+        ioConfig.cs_gpio_num = options.cs;
+        ioConfig.pclk_hz = options.clockHz;
+        ioConfig.trans_queue_depth = BOUNCE_COUNT;
+        ioConfig.on_color_trans_done = onColorDone;
+        ioConfig.user_ctx = this;
+        ioConfig.lcd_cmd_bits = 8;
+        ioConfig.lcd_param_bits = 8;
+        ioConfig.dc_levels.dc_idle_level = 0;
+        ioConfig.dc_levels.dc_cmd_level = 0;
+        ioConfig.dc_levels.dc_dummy_level = 0;
+        ioConfig.dc_levels.dc_data_level = 1;
+
+        err = esp_lcd_new_panel_io_i80(_bus, &ioConfig, &_io);
+        if (err != ESP_OK) {
+            release();
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+    }
+
+    EspI80Bus(const EspI80Bus&) = delete;
+    EspI80Bus& operator=(const EspI80Bus&) = delete;
+
+    ~EspI80Bus() {
+        if (_io) {
+            waitIdle();
+        }
+        release();
+    }
+
+    size_t bufferSize() const {
+        return _bufferSize;
+    }
+
+    void command(uint8_t cmd, const uint8_t* params, size_t count) {
+        if (cmd == mipi::RAMWR) {
+            _writeCmd = cmd;
+            return;
+        }
+        // Waits for the queued color transactions, keeping the order
+        esp_err_t err = esp_lcd_panel_io_tx_param(_io, cmd, count > 0 ? params : nullptr, count);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+    }
+
+    uint8_t* acquire(size_t& capacity) {
+        int index;
+        while ((index = _ring.acquire()) < 0) {
+            xSemaphoreTake(_done, pdMS_TO_TICKS(100));
+        }
+        capacity = _bufferSize;
+        return _buffers[index].data();
+    }
+
+    void submit(uint8_t* buffer, size_t size) {
+        esp_err_t err = esp_lcd_panel_io_tx_color(_io, _writeCmd, buffer, size);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+        _ring.submit();
+        _writeCmd = mipi::RAMWRC;
+    }
+
+    void waitIdle() {
+        while (!_ring.idle()) {
+            xSemaphoreTake(_done, pdMS_TO_TICKS(100));
+        }
+    }
+
+    void delayMs(int ms) {
+        waitIdle();
+        vTaskDelay(pdMS_TO_TICKS(ms));
+    }
+};
+
+
+/**
+ * i80 TFT panel with the framebuffer in PSRAM.
+ *
+ * Updates are written into the framebuffer first, then the touched window is
+ * streamed to the panel through the internal bounce buffers, so the DMA never
+ * reads PSRAM. Brightness is applied while gathering, which keeps the
+ * framebuffer unscaled. With the TE line connected, every update waits for the
+ * start of vertical blanking before the first transfer.
+ */
+class I80TftDisplay : public IDisplayHolder {
+    using Framebuffer = std::vector<uint8_t, EspCapsAllocator<MALLOC_CAP_SPIRAM, uint8_t>>;
+
+    // A missed pulse only costs a torn frame, never a stalled update
+    static constexpr TickType_t TE_TIMEOUT = pdMS_TO_TICKS(40);
+
+    I80TftOptions _options;
+    EspI80Bus _bus;
+    MipiDbiPanel<EspI80Bus> _panel;
+    DisplayLayout _layout;
+    Framebuffer _frame;
+    DisplayUtils::ColorLut _lut;
+    SemaphoreHandle_t _vsync = nullptr;
+    bool _initialized = false;
+
+    static void IRAM_ATTR onTearing(void* arg) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(static_cast<SemaphoreHandle_t>(arg), &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+
+    FrameRegion fullWindow() const {
+        return { 0, 0, _layout.width, _layout.height };
+    }
+
+    uint8_t* pixelAt(int x, int y) {
+        return _frame.data() + y * _layout.stride + x * 2;
+    }
+
+    void waitVsync() {
+        if (!_vsync) {
+            return;
+        }
+        // Drop a pulse from an earlier frame, the window has to start with blanking
+        xSemaphoreTake(_vsync, 0);
+        xSemaphoreTake(_vsync, TE_TIMEOUT);
+    }
+
+    void flush(std::span<const FrameRegion> regions) {
+        if (regions.empty()) {
+            return;
+        }
+        waitVsync();
+        for (FrameRegion window : regions) {
+            if (!_panel.clip(window)) {
+                continue;
+            }
+            _panel.setWindow(window.x, window.y, window.width, window.height);
+
+            BouncePlan plan(window, 2, _bus.bufferSize());
+            BouncePlan::Chunk chunk;
+            while (plan.next(chunk)) {
+                size_t capacity;
+                uint8_t* buffer = _bus.acquire(capacity);
+                size_t bytes = plan.gather(_frame.data(), _layout.stride, 2, chunk, buffer);
+                if (!_lut.identity) {
+                    DisplayLayout run{ static_cast<int>(chunk.pixels), 1, _layout.format, bytes };
+                    DisplayUtils::convertFrame(buffer, bytes, _layout.format, run, buffer, &_lut);
+                }
+                _bus.submit(buffer, bytes);
+            }
+        }
+    }
+
+    void flush(const FrameRegion& region) {
+        flush(std::span<const FrameRegion>(&region, 1));
+    }
+
+    void writeRegion(const uint8_t* data, size_t stride, int format, FrameRegion region) {
+        size_t srcPixel = packedColorSize(format);
+        FrameRegion clipped = region;
+        if (srcPixel == 0) {
+            throw std::runtime_error("Invalid color format");
+        }
+        if (!_panel.clip(clipped)) {
+            return;
+        }
+        data += (clipped.y - region.y) * stride + (clipped.x - region.x) * srcPixel;
+
+        DisplayLayout row{ clipped.width, 1, _layout.format, _layout.stride };
+        for (int y = 0; y < clipped.height; ++y) {
+            DisplayUtils::convertFrame(data + y * stride, clipped.width * srcPixel, format, row,
+                                       pixelAt(clipped.x, clipped.y + y));
+        }
+    }
+
+    // Bounding box of scattered pixel writes
+    struct Bounds {
+        int x0 = INT32_MAX, y0 = INT32_MAX, x1 = -1, y1 = -1;
+
+        void add(int x, int y) {
+            x0 = std::min(x0, x);
+            y0 = std::min(y0, y);
+            x1 = std::max(x1, x);
+            y1 = std::max(y1, y);
+        }
+
+        FrameRegion region() const {
+            return { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+        }
+    };
+
+    void putPixel(int x, int y, DisplayColor color) {
+        DisplayUtils::packColor(pixelAt(x, y), _layout.format, color);
+    }
+
+public:
+    I80TftDisplay(const I80TftOptions& options):
+        _options(options),
+        _bus(options),
+        _panel(_bus, options.panel),
+        // A 16-bit bus sends each pixel as one little-endian word
+        _layout{ _panel.width(), _panel.height(), options.data.size() == 16 ? 7 : mipi::PIXEL_FORMAT,
+                 static_cast<size_t>(_panel.width()) * 2 }
+    {
+        try {
+            _frame.resize(_layout.stride * _layout.height);
+        }
+        catch (const std::bad_alloc&) {
+            throw std::runtime_error("Not enough PSRAM for the framebuffer");
+        }
+    }
+
+    I80TftDisplay(const I80TftDisplay&) = delete;
+    I80TftDisplay& operator=(const I80TftDisplay&) = delete;
+
+    ~I80TftDisplay() override {
+        if (_vsync) {
+            gpio_isr_handler_remove(static_cast<gpio_num_t>(_options.te));
+            vSemaphoreDelete(_vsync);
+        }
+    }
+
+    void start() override {
+        if (_options.rd >= 0) {
+            gpio_num_t rd = static_cast<gpio_num_t>(_options.rd);
+            gpio_reset_pin(rd);
+            gpio_set_direction(rd, GPIO_MODE_OUTPUT);
+            gpio_set_level(rd, 1);
+        }
+        if (_options.rst >= 0) {
+            gpio_num_t rst = static_cast<gpio_num_t>(_options.rst);
+            gpio_reset_pin(rst);
+            gpio_set_direction(rst, GPIO_MODE_OUTPUT);
+            gpio_set_level(rst, 0);
+            vTaskDelay(pdMS_TO_TICKS(10));
+            gpio_set_level(rst, 1);
+            vTaskDelay(pdMS_TO_TICKS(120));
+        }
+
+        _panel.init();
+
+        if (_options.te >= 0) {
+            // The ISR service is installed by GpioFeature
+            gpio_num_t te = static_cast<gpio_num_t>(_options.te);
+            gpio_reset_pin(te);
+            gpio_set_direction(te, GPIO_MODE_INPUT);
+            gpio_set_intr_type(te, GPIO_INTR_POSEDGE);
+            _vsync = xSemaphoreCreateBinary();
+            esp_err_t err = gpio_isr_handler_add(te, onTearing, _vsync);
+            if (err != ESP_OK) {
+                vSemaphoreDelete(_vsync);
+                _vsync = nullptr;
+                throw std::runtime_error(esp_err_to_name(err));
+            }
+            gpio_intr_enable(te);
+        }
+
+        clear();
+
+        if (_options.bl >= 0) {
+            gpio_num_t bl = static_cast<gpio_num_t>(_options.bl);
+            gpio_reset_pin(bl);
+            gpio_set_direction(bl, GPIO_MODE_OUTPUT);
+            gpio_set_level(bl, 1);
+        }
+        _initialized = true;
+    }
+
+    void clear() override {
+        std::fill(_frame.begin(), _frame.end(), 0);
+        flush(fullWindow());
+    }
+
+    void setBrightness(uint8_t brightness) override {
+        _lut.build(brightness, 1.0f);
+        if (_options.bl >= 0) {
+            gpio_set_level(static_cast<gpio_num_t>(_options.bl), brightness > 0);
+        }
+        flush(fullWindow());
+    }
+
+    bool isInitialized() const override {
+        return _initialized;
+    }
+
+    DisplayLayout nativeLayout() const override {
+        return _layout;
+    }
+
+    void setBuffer(const uint8_t* rawData, size_t size, int format, bool clearPrevious) override {
+        if (clearPrevious) {
+            std::fill(_frame.begin(), _frame.end(), 0);
+        }
+        if (!DisplayUtils::convertFrame(rawData, size, format, _layout, _frame.data())) {
+            throw std::runtime_error("Invalid color format");
+        }
+        flush(fullWindow());
+    }
+
+    void setRegion(const uint8_t* data, size_t stride, int format, const FrameRegion& region) override {
+        writeRegion(data, stride, format, region);
+        flush(region);
+    }
+
+    void setRegions(const uint8_t* frame, size_t stride, int format, std::span<const FrameRegion> regions) override {
+        size_t pixelSize = packedColorSize(format);
+        for (const FrameRegion& r : regions) {
+            writeRegion(frame + r.y * stride + r.x * pixelSize, stride, format, r);
+        }
+        flush(regions);
+    }
+
+    void setBufferFromRaw(const std::vector<DisplayPixel>& pixels, bool clearPrevious) override {
+        if (clearPrevious) {
+            std::fill(_frame.begin(), _frame.end(), 0);
+        }
+        Bounds bounds;
+        for (const DisplayPixel& pixel : pixels) {
+            if (pixel.x >= 0 && pixel.x < _layout.width && pixel.y >= 0 && pixel.y < _layout.height) {
+                putPixel(pixel.x, pixel.y, pixel.color);
+                bounds.add(pixel.x, pixel.y);
+            }
+        }
+        if (clearPrevious) {
+            flush(fullWindow());
+        }
+        else if (bounds.x1 >= 0) {
+            flush(bounds.region());
+        }
+    }
+
+    void setPixels(const uint32_t* records, size_t count, PixelRecordLayout layout, bool clearPrevious) override {
+        if (clearPrevious) {
+            std::fill(_frame.begin(), _frame.end(), 0);
+        }
+        Bounds bounds;
+        DisplayUtils::forEachPackedPixel(records, count, layout, _layout.width, _layout.height,
+            [&](int x, int y, DisplayColor color) {
+                putPixel(x, y, color);
+                bounds.add(x, y);
+            });
+        if (clearPrevious) {
+            flush(fullWindow());
+        }
+        else if (bounds.x1 >= 0) {
+            flush(bounds.region());
+        }
+    }
+};
+
+
+template<class Next>
+class I80TftFeature : public Next {
+    static inline bool _inUse = false;
+
+    static void checkPin(int pin, const char* name) {
+        if (Next::PlatformInfo::PinConfig::DIGITAL_PINS.find(pin) == Next::PlatformInfo::PinConfig::DIGITAL_PINS.end()) {
+            throw std::runtime_error(std::string("Invalid pin number for ") + name);
+        }
+    }
+
+    static I80TftOptions optionsFromObject(jac::Object obj) {
+        for (auto key : { "data", "wr", "dc" }) {
+            if (!obj.hasProperty(key)) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, std::string("Missing required property '") + key + "'");
+            }
+        }
+
+        I80TftOptions options;
+        auto data = obj.get("data").to<jac::Array>();
+        int lines = data.length();
+        if (lines != 8 && lines != 16) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "data must have 8 or 16 pins");
+        }
+        for (int i = 0; i < lines; ++i) {
+            options.data.push_back(data.get(i).to<int>());
+        }
+        options.wr = obj.get<int>("wr");
+        options.dc = obj.get<int>("dc");
+        if (obj.hasProperty("cs")) { options.cs = obj.get<int>("cs"); }
+        if (obj.hasProperty("rd")) { options.rd = obj.get<int>("rd"); }
+        if (obj.hasProperty("rst")) { options.rst = obj.get<int>("rst"); }
+        if (obj.hasProperty("bl")) { options.bl = obj.get<int>("bl"); }
+        if (obj.hasProperty("te")) { options.te = obj.get<int>("te"); }
+        if (obj.hasProperty("clockHz")) { options.clockHz = obj.get<int>("clockHz"); }
+        if (obj.hasProperty("bounceSize")) { options.bounceSize = obj.get<int>("bounceSize"); }
+
+        MipiDbiConfig& panel = options.panel;
+        if (obj.hasProperty("controller")) {
+            auto controller = obj.get<std::string>("controller");
+            if (controller == "st7789") {
+                panel.controller = MipiDbiController::ST7789;
+            }
+            else if (controller == "ili9341") {
+                panel.controller = MipiDbiController::ILI9341;
+                panel.bgr = true;
+            }
+            else {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid controller");
+            }
+        }
+        if (obj.hasProperty("width")) { panel.width = obj.get<int>("width"); }
+        if (obj.hasProperty("height")) { panel.height = obj.get<int>("height"); }
+        if (obj.hasProperty("rotation")) { panel.rotation = obj.get<int>("rotation"); }
+        if (obj.hasProperty("colOffset")) { panel.colOffset = obj.get<int>("colOffset"); }
+        if (obj.hasProperty("rowOffset")) { panel.rowOffset = obj.get<int>("rowOffset"); }
+        if (obj.hasProperty("invert")) { panel.invert = obj.get<bool>("invert"); }
+        if (obj.hasProperty("bgr")) { panel.bgr = obj.get<bool>("bgr"); }
+        panel.tearingEffect = options.te >= 0;
+
+        for (int pin : options.data) {
+            checkPin(pin, "data");
+        }
+        checkPin(options.wr, "wr");
+        checkPin(options.dc, "dc");
+        if (options.cs >= 0) { checkPin(options.cs, "cs"); }
+        if (options.rd >= 0) { checkPin(options.rd, "rd"); }
+        if (options.rst >= 0) { checkPin(options.rst, "rst"); }
+        if (options.bl >= 0) { checkPin(options.bl, "bl"); }
+        if (options.te >= 0) { checkPin(options.te, "te"); }
+
+        if (panel.width <= 0 || panel.height <= 0 || panel.width > 480 || panel.height > 480) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "width and height must be between 1 and 480");
+        }
+        if (panel.rotation < 0 || panel.rotation > 3) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "rotation must be between 0 and 3");
+        }
+        if (options.bounceSize < 1024 || options.bounceSize > 64 * 1024) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "bounceSize must be between 1024 and 65536");
+        }
+        return options;
+    }
+
+    struct I80TftProtoBuilder : public jac::ProtoBuilder::Opaque<I80TftDisplay>, public jac::ProtoBuilder::Properties {
+        static I80TftDisplay* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Expected an options object");
+            }
+            if (_inUse) {
+                throw std::runtime_error("The LCD peripheral is already driving an I80Tft display");
+            }
+
+            auto display = std::make_unique<I80TftDisplay>(optionsFromObject(args[0].to<jac::Object>()));
+            display->start();
+            _inUse = true;
+            return display.release();
+        }
+
+        static void destroyOpaque(JSRuntime* rt, I80TftDisplay* ptr) noexcept {
+            if (!ptr) {
+                return;
+            }
+            DisplayProtoBindings<I80TftDisplay>::release(ptr);
+            delete ptr;
+            _inUse = false;
+        }
+
+        static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+            DisplayProtoBindings<I80TftDisplay>::addCommonProperties(ctx, proto);
+        }
+    };
+
+public:
+    using I80TftClass = jac::Class<I80TftProtoBuilder>;
+
+    I80TftFeature() {
+        I80TftClass::init("I80Tft");
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        jac::Module& mod = this->newModule("i80tft");
+        mod.addExport("I80Tft", I80TftClass::getConstructor(this->context()));
+    }
+};
+
+#endif // CONFIG_IDF_TARGET_ESP32S3
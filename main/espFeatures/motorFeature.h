@@ -11,6 +11,8 @@
 #include <optional>
 #include <vector>
 
+#include "freeRTOSEventQueue.h"
+
 
 template<typename Feature>
 struct MotorPins {
@@ -112,6 +114,7 @@ struct JSDCMotor {
     std::optional<PwmRes> resA;
     std::optional<PwmRes> resB;
     std::optional<PromiseFunctions> pendingPromise;
+    EventSource targetEvents{ EventLane::RealTime, OverflowPolicy::DropNewest, false, "motor" };
     int encTicks;
     double circumference;
 
@@ -220,7 +223,7 @@ public:
             };
 
             if (mot->pendingPromise) {
-                machine->scheduleEventISR(resolve, mot);  // FIXME: potential out-of-memory access
+                machine->scheduleEventISR(mot->targetEvents, resolve, mot);  // FIXME: potential out-of-memory access
             }
         });
         mot->motor->setEndPosTolerance(3);
@@ -4,7 +4,11 @@
 #include "jac/machine/class.h"
 #include "jac/machine/functionFactory.h"
 #include "jac/machine/internal/declarations.h"
+#include "../util/displayTypes.h"
+#include "../util/renderStats.h"
+#include "../util/statsChannel.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <map>
 #include <string>
@@ -26,9 +30,25 @@ struct RenderSprite {
     float dist;
 };
 
-extern size_t packedColorSize(int format);
-
 class Raycaster {
+  public:
+    enum Stage : size_t {
+        STAGE_WALLS,
+        STAGE_SPRITES,
+        STAGE_WEAPON,
+        STAGE_TOTAL,
+        STAGE_COUNT
+    };
+    enum Counter : size_t {
+        COUNTER_WALL_PIXELS,
+        COUNTER_FLOOR_PIXELS,
+        COUNTER_SPRITES,
+        COUNTER_SPRITE_PIXELS,
+        COUNTER_WEAPON_PIXELS,
+        COUNTER_COUNT
+    };
+    using Stats = RenderStats<STAGE_COUNT, COUNTER_COUNT>;
+
   private:
     std::vector<std::vector<int>> m_map;
     int m_width;
@@ -53,6 +73,9 @@ class Raycaster {
     int m_mapWidth = 0;
     int m_mapHeight = 0;
 
+    Stats m_stats;
+    bool m_streamStats = false;
+
     bool isWall(int tile) const {
         return std::find(m_wallTypes.begin(), m_wallTypes.end(), tile) !=
                m_wallTypes.end();
@@ -203,6 +226,10 @@ class Raycaster {
             int drawStart = std::max(0, -lineHeight / 2 + m_height / 2);
             int drawEnd = std::min(m_height - 1, lineHeight / 2 + m_height / 2);
 
+            int wallRows = std::max(0, drawEnd - drawStart + 1);
+            m_stats.count(COUNTER_WALL_PIXELS, wallRows);
+            m_stats.count(COUNTER_FLOOR_PIXELS, m_height - wallRows);
+
             float wallX = (side == 0) ? (posY + perpWallDist * rayDirY)
                                       : (posX + perpWallDist * rayDirX);
             wallX -= std::floor(wallX);
@@ -315,6 +342,8 @@ class Raycaster {
                       return a.dist > b.dist;
                   });
 
+        uint32_t spritePixels = 0;
+
         for (const auto &sprite : m_spriteList) {
             float spriteDistX = sprite.x - posX;
             float spriteDistY = sprite.y - posY;
@@ -342,6 +371,7 @@ class Raycaster {
 
             if (m_spriteTextures.count(sprite.tex)) {
                 const RaycasterTexture &tex = m_spriteTextures[sprite.tex];
+                m_stats.count(COUNTER_SPRITES);
                 for (int stripe = drawStartX; stripe < drawEndX; stripe++) {
                     if (stripe >= 0 && stripe < (int)m_zBuffer.size() &&
                         transformY < m_zBuffer[stripe]) {
@@ -360,15 +390,18 @@ class Raycaster {
                             size_t pixelIdx = (size_t)texY * tex.width + texX;
                             if (pixelIdx < tex.pixels.size()) {
                                 uint16_t color = tex.pixels[pixelIdx];
-                                if (color != 0x0000)
+                                if (color != 0x0000) {
                                     drawPixel(raw, stripe, y, color, format,
                                               bpp);
+                                    spritePixels++;
+                                }
                             }
                         }
                     }
                 }
             }
         }
+        m_stats.count(COUNTER_SPRITE_PIXELS, spritePixels);
     }
 
     void renderWeaponOverlay(uint8_t *raw, int weaponFrame, int format,
@@ -387,6 +420,8 @@ class Raycaster {
         if (weaponFrame == 2)
             startY += (m_height / 20);
 
+        uint32_t weaponPixels = 0;
+
         for (int y = 0; y < drawHeight; y++) {
             int screenY = startY + y;
             if (screenY < 0 || screenY >= m_height)
@@ -406,10 +441,12 @@ class Raycaster {
                     uint16_t color = tex.pixels[pixelIdx];
                     if (color != 0x0000) {
                         drawPixel(raw, screenX, screenY, color, format, bpp);
+                        weaponPixels++;
                     }
                 }
             }
         }
+        m_stats.count(COUNTER_WEAPON_PIXELS, weaponPixels);
     }
 
   public:
@@ -522,14 +559,35 @@ class Raycaster {
             return 0;
         }
 
-        renderWalls(raw, posX, posY, dirX, dirY, planeX, planeY, doorData,
-                    format, bpp);
-        renderSprites(raw, posX, posY, dirX, dirY, planeX, planeY, spriteData,
-                      format, bpp);
-        renderWeaponOverlay(raw, weaponFrame, format, bpp);
+        m_stats.beginFrame();
+        {
+            auto total = m_stats.measure(STAGE_TOTAL);
+            {
+                auto timer = m_stats.measure(STAGE_WALLS);
+                renderWalls(raw, posX, posY, dirX, dirY, planeX, planeY,
+                            doorData, format, bpp);
+            }
+            {
+                auto timer = m_stats.measure(STAGE_SPRITES);
+                renderSprites(raw, posX, posY, dirX, dirY, planeX, planeY,
+                              spriteData, format, bpp);
+            }
+            auto timer = m_stats.measure(STAGE_WEAPON);
+            renderWeaponOverlay(raw, weaponFrame, format, bpp);
+        }
+        m_stats.endFrame();
+
+        if (m_streamStats) {
+            std::array<uint32_t, Stats::SIZE> snapshot;
+            m_stats.snapshot(snapshot.data());
+            StatsChannel::publish("raycaster", snapshot);
+        }
 
         return requiredBytes;
     }
+
+    Stats &stats() { return m_stats; }
+    void setStreamStats(bool enable) { m_streamStats = enable; }
 };
 
 class RaycasterProtoBuilder : public jac::ProtoBuilder::Opaque<Raycaster>,
@@ -687,6 +745,45 @@ class RaycasterProtoBuilder : public jac::ProtoBuilder::Opaque<Raycaster>,
                                  spriteData, doorData, wFrame, fmt);
                 return jac::Value::from(ctx, (int)written);
             }));
+
+        proto.defineProperty(
+            "getStats",
+            ff.newFunctionThisVariadic([](jac::ContextRef ctx,
+                                          jac::ValueWeak thisVal,
+                                          std::vector<jac::ValueWeak> args) {
+                Raycaster *self = getOpaque(ctx, thisVal);
+                std::array<uint32_t, Raycaster::Stats::SIZE> snapshot;
+                self->stats().snapshot(snapshot.data());
+
+                if (!args.empty() && !args[0].isUndefined()) {
+                    size_t size;
+                    uint8_t *raw =
+                        JS_GetArrayBuffer(ctx, &size, args[0].getVal());
+                    if (!raw || size < sizeof(snapshot)) {
+                        throw jac::Exception::create(
+                            jac::Exception::Type::TypeError,
+                            "Raycaster.getStats: ArrayBuffer too small");
+                    }
+                    std::memcpy(raw, snapshot.data(), sizeof(snapshot));
+                    return jac::Value(ctx,
+                                      JS_DupValue(ctx, args[0].getVal()));
+                }
+                return jac::Value(jac::ArrayBuffer::create(
+                    ctx, std::span<uint32_t>(snapshot)));
+            }));
+
+        proto.defineProperty(
+            "resetStats",
+            ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+                getOpaque(ctx, thisVal)->stats().reset();
+            }));
+
+        proto.defineProperty(
+            "streamStats",
+            ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal,
+                                  bool enable) {
+                getOpaque(ctx, thisVal)->setStreamStats(enable);
+            }));
     }
 };
 
@@ -701,5 +798,32 @@ template <class Next> class RaycasterFeature : public Next {
         jac::Module &rayModule = this->newModule("raycaster");
         rayModule.addExport("Raycaster",
                             RaycasterClass::getConstructor(this->context()));
+
+        // Indices into the Uint32Array view of Raycaster.getStats()
+        auto stageIndex = [](size_t stage) {
+            return static_cast<int>(1 + stage * Raycaster::Stats::STAGE_FIELDS);
+        };
+        auto counterIndex = [](size_t counter) {
+            return static_cast<int>(1 +
+                                    Raycaster::STAGE_COUNT *
+                                        Raycaster::Stats::STAGE_FIELDS +
+                                    counter);
+        };
+        jac::Object statObj = jac::Object::create(this->context());
+        statObj.set("FRAMES", 0);
+        statObj.set("WALLS", stageIndex(Raycaster::STAGE_WALLS));
+        statObj.set("SPRITES", stageIndex(Raycaster::STAGE_SPRITES));
+        statObj.set("WEAPON", stageIndex(Raycaster::STAGE_WEAPON));
+        statObj.set("TOTAL", stageIndex(Raycaster::STAGE_TOTAL));
+        statObj.set("WALL_PIXELS", counterIndex(Raycaster::COUNTER_WALL_PIXELS));
+        statObj.set("FLOOR_PIXELS",
+                    counterIndex(Raycaster::COUNTER_FLOOR_PIXELS));
+        statObj.set("SPRITE_COUNT", counterIndex(Raycaster::COUNTER_SPRITES));
+        statObj.set("SPRITE_PIXELS",
+                    counterIndex(Raycaster::COUNTER_SPRITE_PIXELS));
+        statObj.set("WEAPON_PIXELS",
+                    counterIndex(Raycaster::COUNTER_WEAPON_PIXELS));
+        statObj.set("SIZE", static_cast<int>(Raycaster::Stats::SIZE));
+        rayModule.addExport("RaycasterStat", statObj);
     }
 };
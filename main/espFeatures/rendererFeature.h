@@ -18,34 +18,24 @@
 #include "jac/machine/internal/declarations.h"
 #include "quickjs.h"
 
+#include "../util/bandWorker.h"
+#include "../util/displayTypes.h"
+#include "../util/particleSystem.h"
+#include "../util/renderStats.h"
+#include "../util/statsChannel.h"
+
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <jac/machine/class.h>
 #include <jac/machine/functionFactory.h>
 #include <jac/machine/machine.h>
 #include <jac/machine/values.h>
 #include <memory>
-
-// Reference:
-// https://419.ecma-international.org/3.0/index.html#-15-display-class-pattern-pixel-format-values
-size_t packedColorSize(int format) {
-    switch (format) {
-    case 3:
-    case 4:
-    case 5:
-    case 6:
-        return 1;
-    case 7:
-    case 8:
-    case 12:
-        return 2;
-    case 9:
-        return 3;
-    case 10:
-        return 4;
-    default:
-        return 0;
-    }
-}
+#include <mutex>
+#include <unordered_map>
 
 template <bool Antialias, int BytesPerPixel, typename Packer>
 void fillBufferBlock(uint8_t* raw, int width, int height, const Display& displayGrid, int start_sx, int start_sy, int dx_sx, int dx_sy, int dy_sx, int dy_sy, Packer pack) {
@@ -83,6 +73,41 @@ void fillBufferBlock(uint8_t* raw, int width, int height, const Display& display
     }
 }
 
+// Source grid start position and steps per output column and row for a rotated frame
+struct FrameWalk {
+    int start_sx = 0, start_sy = 0;
+    int dx_sx = 1, dx_sy = 0, dy_sx = 0, dy_sy = 1;
+};
+
+FrameWalk frameWalk(int width, int height, int rotation) {
+    int r = (rotation % 4 + 4) % 4;
+    FrameWalk w;
+
+    if (r == 1) { // 90 degrees
+        w.start_sx = 0;
+        w.start_sy = width - 1;
+        w.dx_sx = 0;
+        w.dx_sy = -1;
+        w.dy_sx = 1;
+        w.dy_sy = 0;
+    } else if (r == 2) { // 180 degrees
+        w.start_sx = width - 1;
+        w.start_sy = height - 1;
+        w.dx_sx = -1;
+        w.dx_sy = 0;
+        w.dy_sx = 0;
+        w.dy_sy = -1;
+    } else if (r == 3) { // 270 degrees
+        w.start_sx = height - 1;
+        w.start_sy = 0;
+        w.dx_sx = 0;
+        w.dx_sy = 1;
+        w.dy_sx = -1;
+        w.dy_sy = 0;
+    }
+    return w;
+}
+
 size_t writeDenseFramebuffer(uint8_t* raw, size_t maxBytes, int width, int height, int format, bool antialias, const Display& displayGrid, int rotation = 0) {
     size_t bytesPerPixel = packedColorSize(format);
     if (bytesPerPixel == 0)
@@ -92,33 +117,7 @@ size_t writeDenseFramebuffer(uint8_t* raw, size_t maxBytes, int width, int heigh
     if (frameBytes > maxBytes)
         return 0;
 
-    int r = (rotation % 4 + 4) % 4;
-
-    int start_sx = 0, start_sy = 0;
-    int dx_sx = 1, dx_sy = 0, dy_sx = 0, dy_sy = 1;
-
-    if (r == 1) { // 90 degrees
-        start_sx = 0;
-        start_sy = width - 1;
-        dx_sx = 0;
-        dx_sy = -1;
-        dy_sx = 1;
-        dy_sy = 0;
-    } else if (r == 2) { // 180 degrees
-        start_sx = width - 1;
-        start_sy = height - 1;
-        dx_sx = -1;
-        dx_sy = 0;
-        dy_sx = 0;
-        dy_sy = -1;
-    } else if (r == 3) { // 270 degrees
-        start_sx = height - 1;
-        start_sy = 0;
-        dx_sx = 0;
-        dx_sy = 1;
-        dy_sx = -1;
-        dy_sy = 0;
-    }
+    auto [start_sx, start_sy, dx_sx, dx_sy, dy_sx, dy_sy] = frameWalk(width, height, rotation);
 
 #define HANDLE_FORMAT(FMT, BYTES, PACK_LAMBDA) \
     case FMT: \
@@ -381,6 +380,37 @@ public:
     }
 };
 
+/**
+ * Shapes drawn into cached layers, edits made through the JS bindings mark those layers dirty.
+ */
+class ShapeWatch {
+    static inline std::unordered_multimap<const Shape*, bool*> watchers;
+
+public:
+    static void watch(const Shape* shape, bool* dirty) {
+        watchers.emplace(shape, dirty);
+    }
+
+    static void unwatch(const Shape* shape, bool* dirty) {
+        auto [begin, end] = watchers.equal_range(shape);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second == dirty) {
+                watchers.erase(it);
+                return;
+            }
+        }
+    }
+
+    static void touch(const Shape* shape) {
+        if (watchers.empty())
+            return;
+        auto [begin, end] = watchers.equal_range(shape);
+        for (auto it = begin; it != end; ++it) {
+            *it->second = true;
+        }
+    }
+};
+
 class ShapeProtoBuilder : public jac::ProtoBuilder::Opaque<std::shared_ptr<Shape>>, public jac::ProtoBuilder::Properties {
 private:
     static inline std::vector<JSClassID> derivedClassIDs;
@@ -412,6 +442,7 @@ private:
             proto.defineProperty(def.name, ff.newFunctionThis([func = def.func](jac::ContextRef ctx, jac::ValueWeak thisVal, Args... args) {
                 Shape* shape = unwrapShape(ctx, thisVal);
                 func(shape, args...);
+                ShapeWatch::touch(shape);
             }), jac::PropFlags::Enumerable);
         }
     }
@@ -444,6 +475,7 @@ private:
             float ox = originX.isUndefined() ? -1 : originX.to<float>();
             float oy = originY.isUndefined() ? -1 : originY.to<float>();
             shape->setScale(scaleX, scaleY, ox, oy);
+            ShapeWatch::touch(shape);
         }), jac::PropFlags::Enumerable);
     }
 
@@ -474,6 +506,7 @@ private:
             Texture* tex = TextureProtoBuilder::unwrap(ctx, texVal);
             if (tex) {
                 shape->texture = tex;
+                ShapeWatch::touch(shape);
             }
             return jac::Value::undefined(ctx);
         }), jac::PropFlags::Enumerable);
@@ -552,7 +585,9 @@ public:
             jac::FunctionFactory ff(ctx); \
             proto.defineProperty("setColor", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak colorVal) { \
                 Color color = jac::fromValue<Color>(ctx, colorVal); \
-                static_cast<ClassName*>(ShapeProtoBuilder::unwrapShape(ctx, thisVal))->color = color; \
+                Shape* shape = ShapeProtoBuilder::unwrapShape(ctx, thisVal); \
+                static_cast<ClassName*>(shape)->color = color; \
+                ShapeWatch::touch(shape); \
             }), jac::PropFlags::Enumerable); \
             proto.defineProperty("getColor", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) { \
                 return jac::toValue(ctx, static_cast<ClassName*>(ShapeProtoBuilder::unwrapShape(ctx, thisVal))->color); \
@@ -586,6 +621,7 @@ public:
                 auto shapePtr = reinterpret_cast<std::shared_ptr<Shape>*>(shapeOpaque);
                 if (shapePtr && *shapePtr) {
                     (*collectionPtr)->addShape(*shapePtr);
+                    ShapeWatch::touch(collectionPtr->get());
                 }
             }
         }), jac::PropFlags::Enumerable);
@@ -593,6 +629,7 @@ public:
         proto.defineProperty("clear", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
             auto collectionPtr = getOpaque(ctx, thisVal);
             (*collectionPtr)->clear();
+            ShapeWatch::touch(collectionPtr->get());
             return jac::Value::undefined(ctx);
         }), jac::PropFlags::Enumerable);
 
@@ -604,6 +641,7 @@ public:
                 auto shapePtr = reinterpret_cast<std::shared_ptr<Shape>*>(shapeOpaque);
                 if (shapePtr && *shapePtr) {
                     (*collectionPtr)->removeShape(*shapePtr);
+                    ShapeWatch::touch(collectionPtr->get());
                 }
             }
         }), jac::PropFlags::Enumerable);
@@ -630,7 +668,9 @@ public:
 
         proto.defineProperty("setColor", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak colorVal) {
             Color color = jac::fromValue<Color>(ctx, colorVal);
-            static_cast<RegularPolygon*>(ShapeProtoBuilder::unwrapShape(ctx, thisVal))->color = color;
+            Shape* shape = ShapeProtoBuilder::unwrapShape(ctx, thisVal);
+            static_cast<RegularPolygon*>(shape)->color = color;
+            ShapeWatch::touch(shape);
         }), jac::PropFlags::Enumerable);
 
         proto.defineProperty("getColor", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
@@ -672,26 +712,1263 @@ public:
     }
 };
 
+/**
+ * Grid of tiles drawn straight into the renderer's display grid underneath the shapes.
+ *
+ * Cells hold tile indices into either a color table or an atlas image cut into
+ * tileWidth x tileHeight tiles, row by row. Each visible tile is one span fill or row copy.
+ */
+class TileMap {
+    int m_x;
+    int m_y;
+    int m_columns;
+    int m_rows;
+    int m_tileWidth;
+    int m_tileHeight;
+    int m_emptyTile = -1;
+    bool m_visible = true;
+
+    std::vector<uint16_t> m_cells;
+    std::vector<Color> m_colors;
+
+    // Atlas decoded once to grid colors so tiles are plain row copies
+    std::vector<Color> m_atlas;
+    int m_atlasWidth = 0;
+    int m_atlasColumns = 0;
+    int m_atlasTiles = 0;
+
+    void drawTile(Display& grid, int tile, int left, int top, int bandY) const {
+        int x0 = std::max(left, 0);
+        int x1 = std::min(left + m_tileWidth, grid.width);
+        int y0 = std::max(top - bandY, 0);
+        int y1 = std::min(top + m_tileHeight - bandY, grid.height);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+
+        if (!m_atlas.empty()) {
+            if (tile >= m_atlasTiles)
+                return;
+            int atlasX = (tile % m_atlasColumns) * m_tileWidth + (x0 - left);
+            int atlasY = (tile / m_atlasColumns) * m_tileHeight + (y0 + bandY - top);
+            for (int y = y0; y < y1; ++y, ++atlasY) {
+                auto src = m_atlas.begin() + static_cast<size_t>(atlasY) * m_atlasWidth + atlasX;
+                std::copy(src, src + (x1 - x0), grid.pixels.begin() + static_cast<size_t>(y) * grid.width + x0);
+            }
+        } else {
+            if (tile >= static_cast<int>(m_colors.size()))
+                return;
+            Color color = m_colors[tile];
+            for (int y = y0; y < y1; ++y) {
+                std::fill_n(grid.pixels.begin() + static_cast<size_t>(y) * grid.width + x0, x1 - x0, color);
+            }
+        }
+    }
+
+public:
+    TileMap(int x, int y, int columns, int rows, int tileWidth, int tileHeight):
+        m_x(x), m_y(y), m_columns(columns), m_rows(rows), m_tileWidth(tileWidth), m_tileHeight(tileHeight),
+        m_cells(static_cast<size_t>(columns) * rows, 0)
+    {}
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+
+    void setPosition(int x, int y) {
+        m_x = x;
+        m_y = y;
+    }
+
+    void setVisible(bool visible) { m_visible = visible; }
+    void setEmptyTile(int tile) { m_emptyTile = tile; }
+
+    bool inside(int column, int row) const {
+        return column >= 0 && column < m_columns && row >= 0 && row < m_rows;
+    }
+
+    void setCell(int column, int row, uint16_t tile) {
+        if (inside(column, row))
+            m_cells[static_cast<size_t>(row) * m_columns + column] = tile;
+    }
+
+    int getCell(int column, int row) const {
+        return inside(column, row) ? m_cells[static_cast<size_t>(row) * m_columns + column] : -1;
+    }
+
+    void fill(uint16_t tile) {
+        std::fill(m_cells.begin(), m_cells.end(), tile);
+    }
+
+    /**
+     * @brief Copy cells from an array of 8 or 16-bit indices, row-major
+     */
+    template<typename T>
+    void setCells(const T* cells, size_t count) {
+        std::copy_n(cells, std::min(count, m_cells.size()), m_cells.begin());
+    }
+
+    void setColors(std::vector<Color> colors) {
+        m_colors = std::move(colors);
+        m_atlas.clear();
+    }
+
+    /**
+     * @brief Use an atlas image as the tileset
+     * @return False if the atlas cannot hold a single tile or the format is unknown
+     */
+    bool setAtlas(const uint8_t* data, int width, int height, int format) {
+        size_t bytesPerPixel = packedColorSize(format);
+        int atlasColumns = m_tileWidth > 0 ? width / m_tileWidth : 0;
+        int atlasRows = m_tileHeight > 0 ? height / m_tileHeight : 0;
+        if (bytesPerPixel == 0 || atlasColumns == 0 || atlasRows == 0)
+            return false;
+
+        m_atlas.resize(static_cast<size_t>(width) * height);
+        DisplayColor c{};
+        for (size_t i = 0; i < m_atlas.size(); ++i) {
+            DisplayUtils::unpackColor(data + i * bytesPerPixel, format, c);
+            m_atlas[i] = Color(c.r, c.g, c.b, c.a);
+        }
+        m_atlasWidth = width;
+        m_atlasColumns = atlasColumns;
+        m_atlasTiles = atlasColumns * atlasRows;
+        return true;
+    }
+
+    /**
+     * @brief Draw the visible tiles into the grid
+     * @param grid The display grid of the current band
+     * @param bandY Frame row of the first grid row
+     */
+    void draw(Display& grid, int bandY) const {
+        if (!m_visible || m_tileWidth <= 0 || m_tileHeight <= 0 || (m_colors.empty() && m_atlas.empty()))
+            return;
+
+        // Only visit cells overlapping the band
+        int firstColumn = std::max(0, -m_x / m_tileWidth);
+        int lastColumn = std::min(m_columns, (grid.width - m_x + m_tileWidth - 1) / m_tileWidth);
+        int firstRow = std::max(0, (bandY - m_y) / m_tileHeight);
+        int lastRow = std::min(m_rows, (bandY + grid.height - m_y + m_tileHeight - 1) / m_tileHeight);
+
+        for (int row = firstRow; row < lastRow; ++row) {
+            const uint16_t* cells = m_cells.data() + static_cast<size_t>(row) * m_columns;
+            for (int column = firstColumn; column < lastColumn; ++column) {
+                int tile = cells[column];
+                if (tile == m_emptyTile)
+                    continue;
+                drawTile(grid, tile, m_x + column * m_tileWidth, m_y + row * m_tileHeight, bandY);
+            }
+        }
+    }
+};
+
+class TileMapProtoBuilder : public jac::ProtoBuilder::Opaque<std::shared_ptr<TileMap>>, public jac::ProtoBuilder::Properties {
+public:
+    static std::shared_ptr<TileMap>* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        if (args.empty()) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "TileMap: Missing options");
+        }
+
+        auto obj = args[0].to<jac::ObjectWeak>();
+        int columns = obj.get<int>("columns");
+        int rows = obj.get<int>("rows");
+        int tileWidth = obj.get<int>("tileWidth");
+        int tileHeight = obj.get<int>("tileHeight");
+        if (columns <= 0 || rows <= 0 || columns * rows > 65536 || tileWidth <= 0 || tileHeight <= 0) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "TileMap: Invalid size");
+        }
+
+        int x = obj.hasProperty("x") ? obj.get<int>("x") : 0;
+        int y = obj.hasProperty("y") ? obj.get<int>("y") : 0;
+        return new std::shared_ptr<TileMap>(std::make_shared<TileMap>(x, y, columns, rows, tileWidth, tileHeight));
+    }
+
+    static TileMap* unwrap(jac::ContextRef ctx, jac::ValueWeak val) {
+        auto ptr = getOpaque(ctx, val);
+        return ptr ? ptr->get() : nullptr;
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("setCell", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int column, int row, int tile) {
+            unwrap(ctx, thisVal)->setCell(column, row, static_cast<uint16_t>(tile));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getCell", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int column, int row) {
+            return jac::Value::from(ctx, unwrap(ctx, thisVal)->getCell(column, row));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("fill", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int tile) {
+            unwrap(ctx, thisVal)->fill(static_cast<uint16_t>(tile));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setCells", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak cellsVal) {
+            size_t offset, length, elementSize;
+            JSValue bufferVal = JS_GetTypedArrayBuffer(ctx, cellsVal.getVal(), &offset, &length, &elementSize);
+            jac::Value buffer(ctx, bufferVal);
+            size_t size;
+            uint8_t* raw = JS_GetArrayBuffer(ctx, &size, buffer.getVal());
+            if (!raw || (elementSize != 1 && elementSize != 2)) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "TileMap.setCells: Expected a Uint8Array or Uint16Array");
+            }
+
+            TileMap* self = unwrap(ctx, thisVal);
+            if (elementSize == 1) {
+                self->setCells(raw + offset, length);
+            } else {
+                self->setCells(reinterpret_cast<const uint16_t*>(raw + offset), length / 2);
+            }
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setTileColors", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ArrayWeak colorsVal) {
+            std::vector<Color> colors;
+            uint32_t len = colorsVal.length();
+            colors.reserve(len);
+            for (uint32_t i = 0; i < len; ++i) {
+                colors.push_back(jac::fromValue<Color>(ctx, colorsVal.get(i)));
+            }
+            unwrap(ctx, thisVal)->setColors(std::move(colors));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setTileAtlas", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.size() < 3) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "TileMap.setTileAtlas: Missing arguments (buffer, width, height, [format])");
+            }
+
+            size_t size;
+            uint8_t* raw = JS_GetArrayBuffer(ctx, &size, args[0].getVal());
+            int width = args[1].to<int>();
+            int height = args[2].to<int>();
+            int format = (args.size() > 3 && !args[3].isUndefined()) ? args[3].to<int>() : 10;
+            if (!raw || width <= 0 || height <= 0 || static_cast<size_t>(width) * height * packedColorSize(format) > size) {
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "TileMap.setTileAtlas: ArrayBuffer too small or invalid format");
+            }
+            if (!unwrap(ctx, thisVal)->setAtlas(raw, width, height, format)) {
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "TileMap.setTileAtlas: Atlas smaller than one tile");
+            }
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setEmptyTile", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int tile) {
+            unwrap(ctx, thisVal)->setEmptyTile(tile);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setPosition", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y) {
+            unwrap(ctx, thisVal)->setPosition(x, y);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setVisible", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, bool visible) {
+            unwrap(ctx, thisVal)->setVisible(visible);
+        }), jac::PropFlags::Enumerable);
+    }
+};
+
+enum class ParticleShape { Point, Square, Circle };
+
+/**
+ * Particle system drawn into the renderer's display grid above the shapes.
+ */
+class ParticleLayer {
+    ParticleSystem m_system;
+    ParticleShape m_shape = ParticleShape::Point;
+
+    static void span(Display& grid, int x0, int x1, int y, Color color) {
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, grid.width);
+        if (y < 0 || y >= grid.height || x0 >= x1)
+            return;
+        std::fill_n(grid.pixels.begin() + static_cast<size_t>(y) * grid.width + x0, x1 - x0, color);
+    }
+
+public:
+    explicit ParticleLayer(size_t capacity) : m_system(capacity) {}
+
+    ParticleSystem& system() { return m_system; }
+    void setShape(ParticleShape shape) { m_shape = shape; }
+
+    /**
+     * @brief Draw the live particles
+     * @param grid The display grid of the current band
+     * @param bandY Frame row of the first grid row
+     */
+    void draw(Display& grid, int bandY) const {
+        m_system.forEach([&](int x, int y, uint32_t packed, int size) {
+            Color color((packed >> 16) & 0xFF, (packed >> 8) & 0xFF, packed & 0xFF);
+            y -= bandY;
+
+            if (m_shape == ParticleShape::Point || size <= 1) {
+                if (static_cast<unsigned>(x) < static_cast<unsigned>(grid.width) && static_cast<unsigned>(y) < static_cast<unsigned>(grid.height))
+                    grid.pixels[static_cast<size_t>(y) * grid.width + x] = color;
+                return;
+            }
+
+            int half = size / 2;
+            if (m_shape == ParticleShape::Square) {
+                for (int row = y - half; row < y - half + size; ++row)
+                    span(grid, x - half, x - half + size, row, color);
+                return;
+            }
+
+            int r2 = half * half;
+            int dx = half;
+            for (int dy = 0; dy <= half; ++dy) {
+                while (dx > 0 && dx * dx + dy * dy > r2)
+                    dx--;
+                span(grid, x - dx, x + dx + 1, y + dy, color);
+                if (dy != 0)
+                    span(grid, x - dx, x + dx + 1, y - dy, color);
+            }
+        });
+    }
+};
+
+class ParticleSystemProtoBuilder : public jac::ProtoBuilder::Opaque<std::shared_ptr<ParticleLayer>>, public jac::ProtoBuilder::Properties {
+    static ParticleShape shapeFromString(const std::string& shape) {
+        if (shape == "point")
+            return ParticleShape::Point;
+        if (shape == "square")
+            return ParticleShape::Square;
+        if (shape == "circle")
+            return ParticleShape::Circle;
+        throw jac::Exception::create(jac::Exception::Type::RangeError, "ParticleSystem: Unknown shape " + shape);
+    }
+
+    static ParticleSystem::Field fieldFromString(const std::string& field) {
+        static const std::pair<const char*, ParticleSystem::Field> fields[] = {
+            { "x", ParticleSystem::Field::X },
+            { "y", ParticleSystem::Field::Y },
+            { "vx", ParticleSystem::Field::VX },
+            { "vy", ParticleSystem::Field::VY },
+            { "ax", ParticleSystem::Field::AX },
+            { "ay", ParticleSystem::Field::AY },
+            { "life", ParticleSystem::Field::Life },
+            { "size", ParticleSystem::Field::Size },
+            { "color", ParticleSystem::Field::Color },
+        };
+        for (auto& [name, value] : fields) {
+            if (field == name)
+                return value;
+        }
+        throw jac::Exception::create(jac::Exception::Type::RangeError, "ParticleSystem.read: Unknown field " + field);
+    }
+
+    static ParticleSystem::Params paramsFromObject(jac::ContextRef ctx, jac::ObjectWeak obj) {
+        ParticleSystem::Params p;
+        auto optFloat = [&](const char* key, float& out) {
+            if (obj.hasProperty(key))
+                out = obj.get<float>(key);
+        };
+        optFloat("x", p.x);
+        optFloat("y", p.y);
+        optFloat("vx", p.vx);
+        optFloat("vy", p.vy);
+        optFloat("ax", p.ax);
+        optFloat("ay", p.ay);
+        optFloat("life", p.life);
+        optFloat("velocityJitter", p.velocityJitter);
+        optFloat("lifeJitter", p.lifeJitter);
+        if (obj.hasProperty("color"))
+            p.color = obj.get<uint32_t>("color") & 0xFFFFFF;
+        if (obj.hasProperty("size"))
+            p.size = static_cast<uint8_t>(std::clamp(obj.get<int>("size"), 1, 255));
+        return p;
+    }
+
+public:
+    static constexpr int MAX_CAPACITY = 4096;
+
+    static std::shared_ptr<ParticleLayer>* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        int capacity = 64;
+        ParticleShape shape = ParticleShape::Point;
+        float fixedStep = 0;
+
+        if (!args.empty() && !args[0].isUndefined()) {
+            auto obj = args[0].to<jac::ObjectWeak>();
+            if (obj.hasProperty("capacity"))
+                capacity = obj.get<int>("capacity");
+            if (obj.hasProperty("shape"))
+                shape = shapeFromString(obj.get<std::string>("shape"));
+            if (obj.hasProperty("fixedStep"))
+                fixedStep = obj.get<float>("fixedStep");
+        }
+
+        if (capacity <= 0 || capacity > MAX_CAPACITY) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "ParticleSystem: Capacity must be 1 to " + std::to_string(MAX_CAPACITY));
+        }
+
+        auto layer = std::make_shared<ParticleLayer>(capacity);
+        layer->setShape(shape);
+        layer->system().setFixedStep(fixedStep);
+        return new std::shared_ptr<ParticleLayer>(std::move(layer));
+    }
+
+    static ParticleSystem& unwrap(jac::ContextRef ctx, jac::ValueWeak thisVal) {
+        return (*getOpaque(ctx, thisVal))->system();
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("emit", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "ParticleSystem.emit: Missing particle parameters");
+            }
+            int count = (args.size() > 1 && !args[1].isUndefined()) ? args[1].to<int>() : 1;
+            return unwrap(ctx, thisVal).emit(paramsFromObject(ctx, args[0].to<jac::ObjectWeak>()), std::max(count, 0));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("kill", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int index) {
+            if (index >= 0)
+                unwrap(ctx, thisVal).kill(index);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("clear", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            unwrap(ctx, thisVal).clear();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("step", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, float dt) {
+            unwrap(ctx, thisVal).step(dt);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("update", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "ParticleSystem.update: Missing elapsed time");
+            }
+            int maxSteps = (args.size() > 1 && !args[1].isUndefined()) ? args[1].to<int>() : 8;
+            return unwrap(ctx, thisVal).update(args[0].to<float>(), std::max(maxSteps, 1));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setBounds", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::string mode, float x, float y, float width, float height) {
+            ParticleSystem::Bounds bounds;
+            if (mode == "none")
+                bounds = ParticleSystem::Bounds::None;
+            else if (mode == "wrap")
+                bounds = ParticleSystem::Bounds::Wrap;
+            else if (mode == "clamp")
+                bounds = ParticleSystem::Bounds::Clamp;
+            else if (mode == "kill")
+                bounds = ParticleSystem::Bounds::Kill;
+            else
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "ParticleSystem.setBounds: Unknown mode " + mode);
+            if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(x + width) || !std::isfinite(y + height))
+                throw jac::Exception::create(jac::Exception::Type::RangeError, "ParticleSystem.setBounds: Bounds must be finite");
+            unwrap(ctx, thisVal).setBounds(bounds, x, y, x + width, y + height);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setShape", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::string shape) {
+            (*getOpaque(ctx, thisVal))->setShape(shapeFromString(shape));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("seed", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, uint32_t seed) {
+            unwrap(ctx, thisVal).seed(seed);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setPosition", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int index, float x, float y) {
+            if (index >= 0)
+                unwrap(ctx, thisVal).setPosition(index, x, y);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setVelocity", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int index, float vx, float vy) {
+            if (index >= 0)
+                unwrap(ctx, thisVal).setVelocity(index, vx, vy);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getCount", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return static_cast<int>(unwrap(ctx, thisVal).count());
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getCapacity", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return static_cast<int>(unwrap(ctx, thisVal).capacity());
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("read", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) -> jac::Value {
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "ParticleSystem.read: Missing field name");
+            }
+
+            ParticleSystem& system = unwrap(ctx, thisVal);
+            ParticleSystem::Field field = fieldFromString(args[0].to<std::string>());
+
+            // Fill the caller's buffer when given, so per-frame readback does not allocate
+            if (args.size() > 1 && !args[1].isUndefined()) {
+                size_t size;
+                uint8_t* raw = JS_GetArrayBuffer(ctx, &size, args[1].getVal());
+                if (!raw) {
+                    throw jac::Exception::create(jac::Exception::Type::TypeError, "ParticleSystem.read: Invalid ArrayBuffer passed");
+                }
+                return jac::Value::from(ctx, static_cast<int>(system.read(field, raw, size / 4)));
+            }
+
+            std::vector<uint32_t> values(system.count());
+            system.read(field, values.data(), values.size());
+            return jac::ArrayBuffer::create(ctx, std::span<uint32_t>(values));
+        }), jac::PropFlags::Enumerable);
+    }
+};
+
+/**
+ * Shapes rasterized once into a cached pixel buffer and copied into every band with a scroll offset.
+ * The cache is rebuilt only after one of its shapes was changed or invalidate() was called.
+ */
+class StaticLayer {
+    int m_width;
+    int m_height;
+    bool m_wrap;
+    bool m_transparent;
+    bool m_visible = true;
+    int m_scrollX = 0;
+    int m_scrollY = 0;
+
+    std::shared_ptr<Collection> m_root;
+    std::vector<std::shared_ptr<Shape>> m_shapes;
+    std::vector<Color> m_cache;
+    Color m_background;
+    bool m_dirty = true;
+    bool m_antialias = true;
+
+    static int wrapCoord(int v, int size) {
+        v %= size;
+        return v < 0 ? v + size : v;
+    }
+
+    void copySpan(Color* dst, const Color* src, int n) const {
+        if (!m_transparent) {
+            std::copy_n(src, n, dst);
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            const Color& c = src[i];
+            if (c.r != m_background.r || c.g != m_background.g || c.b != m_background.b || c.a != m_background.a)
+                dst[i] = c;
+        }
+    }
+
+public:
+    StaticLayer(int width, int height, bool wrap, bool transparent):
+        m_width(width), m_height(height), m_wrap(wrap), m_transparent(transparent),
+        m_root(std::make_shared<Collection>(ShapeParams(0, 0, 0)))
+    {}
+
+    ~StaticLayer() {
+        for (auto& shape : m_shapes) {
+            ShapeWatch::unwatch(shape.get(), &m_dirty);
+        }
+    }
+
+    StaticLayer(const StaticLayer&) = delete;
+    StaticLayer& operator=(const StaticLayer&) = delete;
+
+    bool visible() const { return m_visible; }
+    void setVisible(bool visible) { m_visible = visible; }
+    void invalidate() { m_dirty = true; }
+    bool needsRebuild(bool antialias) const { return m_dirty || antialias != m_antialias; }
+
+    void setScroll(int x, int y) {
+        m_scrollX = x;
+        m_scrollY = y;
+    }
+
+    void scroll(int dx, int dy) {
+        m_scrollX += dx;
+        m_scrollY += dy;
+        if (m_wrap) {
+            m_scrollX = wrapCoord(m_scrollX, m_width);
+            m_scrollY = wrapCoord(m_scrollY, m_height);
+        }
+    }
+
+    int scrollX() const { return m_scrollX; }
+    int scrollY() const { return m_scrollY; }
+
+    void add(std::shared_ptr<Shape> shape) {
+        if (std::find(m_shapes.begin(), m_shapes.end(), shape) != m_shapes.end())
+            return;
+        m_root->addShape(shape);
+        ShapeWatch::watch(shape.get(), &m_dirty);
+        m_shapes.push_back(std::move(shape));
+        m_dirty = true;
+    }
+
+    void remove(const std::shared_ptr<Shape>& shape) {
+        auto it = std::find(m_shapes.begin(), m_shapes.end(), shape);
+        if (it == m_shapes.end())
+            return;
+        m_root->removeShape(shape);
+        ShapeWatch::unwatch(shape.get(), &m_dirty);
+        m_shapes.erase(it);
+        m_dirty = true;
+    }
+
+    void clear() {
+        for (auto& shape : m_shapes) {
+            m_root->removeShape(shape);
+            ShapeWatch::unwatch(shape.get(), &m_dirty);
+        }
+        m_shapes.clear();
+        m_dirty = true;
+    }
+
+    /**
+     * @brief Rasterize the shapes into the cache, tile by tile through the renderer's grid
+     * @param renderer Renderer whose grid is used as scratch space
+     * @param gridWidth Width of the renderer's grid
+     * @param gridHeight Height of the renderer's grid
+     * @param antialias Whether to enable antialiasing
+     */
+    void rebuild(::Renderer& renderer, int gridWidth, int gridHeight, bool antialias) {
+        m_cache.resize(static_cast<size_t>(m_width) * m_height);
+        Display& grid = renderer.displayGrid;
+
+        renderer.clear();
+        m_background = grid.pixels[0];
+
+        for (int ty = 0; ty < m_height; ty += gridHeight) {
+            for (int tx = 0; tx < m_width; tx += gridWidth) {
+                m_root->setPosition(-tx, -ty);
+                renderer.clear();
+                renderer.render({m_root}, {gridWidth, gridHeight, antialias});
+
+                int rows = std::min(gridHeight, m_height - ty);
+                int cols = std::min(gridWidth, m_width - tx);
+                for (int row = 0; row < rows; ++row) {
+                    std::copy_n(grid.pixels.begin() + static_cast<size_t>(row) * grid.width, cols,
+                                m_cache.begin() + static_cast<size_t>(ty + row) * m_width + tx);
+                }
+            }
+        }
+        m_root->setPosition(0, 0);
+
+        m_antialias = antialias;
+        m_dirty = false;
+    }
+
+    /**
+     * @brief Copy the cached pixels into the grid of the current band
+     * @param grid The display grid of the current band
+     * @param bandY Frame row of the first grid row
+     */
+    void compose(Display& grid, int bandY) const {
+        if (m_cache.empty())
+            return;
+
+        for (int row = 0; row < grid.height; ++row) {
+            int sy = bandY + row + m_scrollY;
+            if (m_wrap) {
+                sy = wrapCoord(sy, m_height);
+            } else if (sy < 0 || sy >= m_height) {
+                continue;
+            }
+
+            Color* dst = grid.pixels.data() + static_cast<size_t>(row) * grid.width;
+            const Color* src = m_cache.data() + static_cast<size_t>(sy) * m_width;
+
+            if (m_wrap) {
+                // The row is split at most in the places where the source wraps around
+                int sx = wrapCoord(m_scrollX, m_width);
+                for (int x = 0; x < grid.width;) {
+                    int n = std::min(m_width - sx, grid.width - x);
+                    copySpan(dst + x, src + sx, n);
+                    x += n;
+                    sx = 0;
+                }
+            } else {
+                int x0 = std::max(0, -m_scrollX);
+                int x1 = std::min(grid.width, m_width - m_scrollX);
+                if (x0 < x1)
+                    copySpan(dst + x0, src + x0 + m_scrollX, x1 - x0);
+            }
+        }
+    }
+};
+
+class StaticLayerProtoBuilder : public jac::ProtoBuilder::Opaque<std::shared_ptr<StaticLayer>>, public jac::ProtoBuilder::Properties {
+    static std::shared_ptr<Shape>& unwrapShape(jac::ContextRef ctx, jac::ValueWeak shapeVal) {
+        void* opaque = JS_GetOpaque(shapeVal.getVal(), JS_GetClassID(shapeVal.getVal()));
+        auto shapePtr = reinterpret_cast<std::shared_ptr<Shape>*>(opaque);
+        if (!shapePtr || !*shapePtr) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "StaticLayer: Invalid Shape object");
+        }
+        return *shapePtr;
+    }
+
+public:
+    static constexpr int MAX_SIZE = 2048;
+    static constexpr int MAX_PIXELS = 512 * 512;
+
+    static std::shared_ptr<StaticLayer>* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+        if (args.empty()) {
+            throw jac::Exception::create(jac::Exception::Type::TypeError, "StaticLayer: Missing parameters");
+        }
+        auto obj = args[0].to<jac::ObjectWeak>();
+        int width = obj.get<int>("width");
+        int height = obj.get<int>("height");
+        bool wrap = obj.hasProperty("wrap") ? obj.get<bool>("wrap") : false;
+        bool transparent = obj.hasProperty("transparent") ? obj.get<bool>("transparent") : false;
+
+        if (width <= 0 || width > MAX_SIZE || height <= 0 || height > MAX_SIZE || width * height > MAX_PIXELS) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "StaticLayer: Invalid size");
+        }
+        return new std::shared_ptr<StaticLayer>(std::make_shared<StaticLayer>(width, height, wrap, transparent));
+    }
+
+    static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+        jac::FunctionFactory ff(ctx);
+
+        proto.defineProperty("add", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak shapeVal) {
+            (*getOpaque(ctx, thisVal))->add(unwrapShape(ctx, shapeVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("remove", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak shapeVal) {
+            (*getOpaque(ctx, thisVal))->remove(unwrapShape(ctx, shapeVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("clear", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            (*getOpaque(ctx, thisVal))->clear();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("invalidate", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            (*getOpaque(ctx, thisVal))->invalidate();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setScroll", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int x, int y) {
+            (*getOpaque(ctx, thisVal))->setScroll(x, y);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("scroll", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, int dx, int dy) {
+            (*getOpaque(ctx, thisVal))->scroll(dx, dy);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getScrollX", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return (*getOpaque(ctx, thisVal))->scrollX();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getScrollY", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return (*getOpaque(ctx, thisVal))->scrollY();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setVisible", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, bool visible) {
+            (*getOpaque(ctx, thisVal))->setVisible(visible);
+        }), jac::PropFlags::Enumerable);
+    }
+};
+
+/**
+ * Frame stored as one palette index per pixel.
+ *
+ * Rasterized bands are mapped to the nearest palette entry through an RGB444 lookup table,
+ * the output conversion expands indices through a table of pixels already packed in the output format.
+ */
+class IndexedFrame {
+public:
+    static constexpr size_t MAX_COLORS = 256;
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_indices;
+    std::vector<Color> m_palette;
+    std::vector<uint8_t> m_nearest;
+    std::vector<uint8_t> m_expand;
+    int m_expandFormat = 0;
+
+    // RGB 3:3:2 levels spread over the full channel range
+    static std::vector<Color> defaultPalette() {
+        std::vector<Color> palette(MAX_COLORS);
+        for (size_t i = 0; i < MAX_COLORS; ++i) {
+            palette[i] = Color(((i >> 5) & 7) * 255 / 7, ((i >> 2) & 7) * 255 / 7, (i & 3) * 255 / 3);
+        }
+        return palette;
+    }
+
+    void buildNearest() {
+        m_nearest.resize(4096);
+        for (int key = 0; key < 4096; ++key) {
+            int r = ((key >> 8) & 0xF) * 17;
+            int g = ((key >> 4) & 0xF) * 17;
+            int b = (key & 0xF) * 17;
+
+            int best = 0;
+            int bestDist = std::numeric_limits<int>::max();
+            for (size_t i = 0; i < m_palette.size(); ++i) {
+                int dr = r - m_palette[i].r;
+                int dg = g - m_palette[i].g;
+                int db = b - m_palette[i].b;
+                int dist = dr * dr * 3 + dg * dg * 4 + db * db * 2;
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = static_cast<int>(i);
+                }
+            }
+            m_nearest[key] = static_cast<uint8_t>(best);
+        }
+    }
+
+    void buildExpand(int format) {
+        size_t bytesPerPixel = packedColorSize(format);
+        m_expand.assign(MAX_COLORS * bytesPerPixel, 0);
+        for (size_t i = 0; i < m_palette.size(); ++i) {
+            writePixelBytes(m_expand.data() + i * bytesPerPixel, format, m_palette[i]);
+        }
+        m_expandFormat = format;
+    }
+
+    template <bool Antialias>
+    void quantizeRows(const Display& grid, int y, int rows) {
+        for (int row = 0; row < rows; ++row) {
+            const Color* src = grid.pixels.data() + static_cast<size_t>(row) * grid.width;
+            uint8_t* dst = m_indices.data() + static_cast<size_t>(y + row) * m_width;
+            for (int x = 0; x < m_width; ++x) {
+                Color p = src[x];
+                if constexpr (Antialias) {
+                    p.r = (p.r * p.a) >> 8;
+                    p.g = (p.g * p.a) >> 8;
+                    p.b = (p.b * p.a) >> 8;
+                }
+                dst[x] = m_nearest[((p.r >> 4) << 8) | ((p.g >> 4) << 4) | (p.b >> 4)];
+            }
+        }
+    }
+
+    template <int BytesPerPixel>
+    void expandBlock(uint8_t* out, int width, int height, const FrameWalk& walk) const {
+        const uint8_t* lut = m_expand.data();
+        int row_sx = walk.start_sx;
+        int row_sy = walk.start_sy;
+
+        for (int y = 0; y < height; ++y) {
+            int sx = row_sx;
+            int sy = row_sy;
+            for (int x = 0; x < width; ++x) {
+                if (static_cast<unsigned>(sx) < static_cast<unsigned>(m_width) && static_cast<unsigned>(sy) < static_cast<unsigned>(m_height)) {
+                    std::memcpy(out, lut + m_indices[static_cast<size_t>(sy) * m_width + sx] * BytesPerPixel, BytesPerPixel);
+                } else {
+                    std::memset(out, 0, BytesPerPixel);
+                }
+                out += BytesPerPixel;
+                sx += walk.dx_sx;
+                sy += walk.dx_sy;
+            }
+            row_sx += walk.dy_sx;
+            row_sy += walk.dy_sy;
+        }
+    }
+
+public:
+    IndexedFrame(int width, int height) : m_width(width), m_height(height), m_indices(static_cast<size_t>(width) * height) {
+        setPalette({});
+    }
+
+    /**
+     * @brief Replace the palette, an empty palette selects the fixed RGB 3:3:2 palette
+     */
+    void setPalette(std::vector<Color> palette) {
+        m_palette = palette.empty() ? defaultPalette() : std::move(palette);
+        if (m_palette.size() > MAX_COLORS)
+            m_palette.resize(MAX_COLORS);
+        buildNearest();
+        m_expandFormat = 0;
+    }
+
+    size_t paletteSize() const { return m_palette.size(); }
+
+    /**
+     * @brief Map rows of a rasterized band to palette indices
+     * @param grid The display grid holding the band
+     * @param y Frame row of the first grid row
+     * @param rows Number of rows to map
+     * @param antialias Whether the grid alpha has to be applied first
+     */
+    void quantize(const Display& grid, int y, int rows, bool antialias) {
+        rows = std::min(rows, m_height - y);
+        if (antialias)
+            quantizeRows<true>(grid, y, rows);
+        else
+            quantizeRows<false>(grid, y, rows);
+    }
+
+    /**
+     * @brief Expand rows of the frame into the output format
+     * @param raw The output buffer
+     * @param maxBytes Size of the output buffer
+     * @param y First frame row
+     * @param rows Number of rows, rotation is only applied to the whole frame
+     * @param format The output pixel format
+     * @param rotation Rotation in 90 degree steps
+     * @return Number of bytes written, 0 on error
+     */
+    size_t expand(uint8_t* raw, size_t maxBytes, int y, int rows, int format, int rotation = 0) {
+        size_t bytesPerPixel = packedColorSize(format);
+        if (bytesPerPixel == 0)
+            return 0;
+
+        size_t bytes = static_cast<size_t>(m_width) * rows * bytesPerPixel;
+        if (bytes > maxBytes)
+            return 0;
+
+        if (format != m_expandFormat)
+            buildExpand(format);
+
+        FrameWalk walk = frameWalk(m_width, rows, rotation);
+        walk.start_sy += y;
+
+        switch (bytesPerPixel) {
+        case 1: expandBlock<1>(raw, m_width, rows, walk); break;
+        case 2: expandBlock<2>(raw, m_width, rows, walk); break;
+        case 3: expandBlock<3>(raw, m_width, rows, walk); break;
+        case 4: expandBlock<4>(raw, m_width, rows, walk); break;
+        }
+        return bytes;
+    }
+};
+
+// Called once per rendered band with the packed strip, its first row and row count
+using BandSink = std::function<void(const uint8_t* strip, size_t size, int y, int rows)>;
+
 class RendererHolder {
+public:
+    enum Stage : size_t { STAGE_CLEAR, STAGE_RASTERIZE, STAGE_PACK, STAGE_TEXT, STAGE_TOTAL, STAGE_COUNT };
+    enum Counter : size_t { COUNTER_BANDS, COUNTER_PACKED_PIXELS, COUNTER_TEXT_PIXELS, COUNTER_LAYER_REBUILDS, COUNTER_COUNT };
+    using Stats = RenderStats<STAGE_COUNT, COUNTER_COUNT>;
+
 private:
     std::unique_ptr<::Renderer> m_renderer;
     int m_width;
     int m_height;
+    int m_bandHeight;
+    std::unique_ptr<::Renderer> m_workerRenderer;
+    std::unique_ptr<BandWorker> m_worker;
+    // The shape library is not known to be safe to draw from two threads, so shapes are drawn one band at a time
+    mutable std::mutex m_sceneMutex;
+    bool m_splitForWorker = false;
+    Stats m_stats;
+    bool m_streamStats = false;
+    std::unique_ptr<IndexedFrame> m_indexed;
+    std::vector<std::shared_ptr<StaticLayer>> m_layers;
+    std::vector<std::shared_ptr<TileMap>> m_tileMaps;
+    std::vector<std::shared_ptr<ParticleLayer>> m_particles;
+
+    /**
+     * @brief Draw one band into the renderer's grid
+     *
+     * Layers, tile maps and particles are only read, so the worker may draw another band into its own
+     * renderer at the same time. The shapes are drawn under m_sceneMutex.
+     *
+     * @param shift Whether scene is the band root, which is moved up by bandY before drawing
+     */
+    void drawBand(::Renderer& renderer, const std::shared_ptr<Collection>& scene, int rows, bool antialias, int bandY, bool shift) const {
+        // Cached layers and tile maps go straight into the cleared grid, shapes are drawn over them
+        for (auto& layer : m_layers) {
+            if (layer->visible())
+                layer->compose(renderer.displayGrid, bandY);
+        }
+        for (auto& tileMap : m_tileMaps) {
+            tileMap->draw(renderer.displayGrid, bandY);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sceneMutex);
+            if (shift)
+                scene->setPosition(0, -bandY);
+            renderer.render({scene}, {m_width, rows, antialias});
+        }
+        for (auto& particles : m_particles) {
+            particles->draw(renderer.displayGrid, bandY);
+        }
+    }
+
+    void rasterize(const std::shared_ptr<Collection>& scene, int rows, bool antialias, int bandY, bool shift) {
+        {
+            auto timer = m_stats.measure(STAGE_CLEAR);
+            m_renderer->clear();
+        }
+        auto timer = m_stats.measure(STAGE_RASTERIZE);
+        drawBand(*m_renderer, scene, rows, antialias, bandY, shift);
+        m_stats.count(COUNTER_BANDS);
+    }
+
+    // Rebuilds dirty layer caches, must run before the grid is used for the first band
+    void refreshLayers(bool antialias) {
+        for (auto& layer : m_layers) {
+            if (layer->visible() && layer->needsRebuild(antialias)) {
+                auto timer = m_stats.measure(STAGE_RASTERIZE);
+                layer->rebuild(*m_renderer, m_width, m_bandHeight, antialias);
+                m_stats.count(COUNTER_LAYER_REBUILDS);
+            }
+        }
+    }
 
 public:
-    RendererHolder(int width, int height) : m_renderer(std::make_unique<::Renderer>(width, height)), m_width(width), m_height(height) {}
+    RendererHolder(int width, int height, int bandHeight = 0) : m_width(width), m_height(height) {
+        m_bandHeight = (bandHeight > 0 && bandHeight < height) ? bandHeight : height;
+        m_renderer = std::make_unique<::Renderer>(width, m_bandHeight);
+    }
 
     ::Renderer* getRenderer() { return m_renderer.get(); }
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
+    int getBandHeight() const { return m_bandHeight; }
+    bool isBanded() const { return m_bandHeight < m_height; }
+    bool isIndexed() const { return m_indexed != nullptr; }
+    bool isParallel() const { return m_worker != nullptr; }
+    Stats& stats() { return m_stats; }
+
+    /**
+     * @brief Keep the frame as palette indices instead of packing each band directly
+     * @param palette Up to 256 colors, empty for the fixed RGB 3:3:2 palette
+     */
+    void setPalette(std::vector<Color> palette) {
+        if (!m_indexed) {
+            m_indexed = std::make_unique<IndexedFrame>(m_width, m_height);
+        }
+        m_indexed->setPalette(std::move(palette));
+    }
+
+    /**
+     * @brief Rasterize every other band on a worker thread with its own band grid
+     *
+     * Clearing, layers, tile maps and particles of two bands run in parallel, the shapes are still
+     * drawn one band at a time.
+     * A renderer without bands is split into two halves, so the grid memory stays the same
+     * and rotation is no longer available unless the renderer is indexed.
+     */
+    void setParallel(bool enable) {
+        if (enable == isParallel())
+            return;
+
+        if (enable) {
+            if (!isBanded()) {
+                m_splitForWorker = true;
+                m_bandHeight = (m_height + 1) / 2;
+                m_renderer = std::make_unique<::Renderer>(m_width, m_bandHeight);
+            }
+            m_workerRenderer = std::make_unique<::Renderer>(m_width, m_bandHeight);
+            m_worker = std::make_unique<BandWorker>();
+        } else {
+            m_worker.reset();
+            m_workerRenderer.reset();
+            if (m_splitForWorker) {
+                m_splitForWorker = false;
+                m_bandHeight = m_height;
+                m_renderer = std::make_unique<::Renderer>(m_width, m_bandHeight);
+            }
+        }
+    }
+
+    void addLayer(std::shared_ptr<StaticLayer> layer) {
+        if (std::find(m_layers.begin(), m_layers.end(), layer) == m_layers.end()) {
+            m_layers.push_back(std::move(layer));
+        }
+    }
+
+    void removeLayer(const std::shared_ptr<StaticLayer>& layer) {
+        m_layers.erase(std::remove(m_layers.begin(), m_layers.end(), layer), m_layers.end());
+    }
+
+    void addTileMap(std::shared_ptr<TileMap> tileMap) {
+        if (std::find(m_tileMaps.begin(), m_tileMaps.end(), tileMap) == m_tileMaps.end()) {
+            m_tileMaps.push_back(std::move(tileMap));
+        }
+    }
+
+    void removeTileMap(const std::shared_ptr<TileMap>& tileMap) {
+        m_tileMaps.erase(std::remove(m_tileMaps.begin(), m_tileMaps.end(), tileMap), m_tileMaps.end());
+    }
+
+    void addParticles(std::shared_ptr<ParticleLayer> particles) {
+        if (std::find(m_particles.begin(), m_particles.end(), particles) == m_particles.end()) {
+            m_particles.push_back(std::move(particles));
+        }
+    }
+
+    void removeParticles(const std::shared_ptr<ParticleLayer>& particles) {
+        m_particles.erase(std::remove(m_particles.begin(), m_particles.end(), particles), m_particles.end());
+    }
+
+    void setStreamStats(bool enable) { m_streamStats = enable; }
+
+    /**
+     * @brief Start a new stats frame, committing the previous one
+     *
+     * A frame spans from one render call to the next, so text drawn over a rendered
+     * scene is accounted to the same frame.
+     */
+    void beginFrame() {
+        if (m_stats.isOpen()) {
+            m_stats.endFrame();
+            if (m_streamStats) {
+                std::array<uint32_t, Stats::SIZE> snapshot;
+                m_stats.snapshot(snapshot.data());
+                StatsChannel::publish("renderer", snapshot);
+            }
+        }
+        m_stats.beginFrame();
+    }
+
+    /**
+     * @brief Rasterize the scene band by band into the strip-sized display grid
+     * @param scene The scene to render
+     * @param antialias Whether to enable antialiasing
+     * @param onBand Called with the first row, row count and the rasterized grid of each band
+     */
+    template <typename OnBand>
+    void forEachBand(const std::shared_ptr<Collection>& scene, bool antialias, OnBand onBand) {
+        refreshLayers(antialias);
+
+        if (!isBanded()) {
+            rasterize(scene, m_height, antialias, 0, false);
+            onBand(0, m_height, m_renderer->displayGrid);
+            return;
+        }
+
+        // The scene is shifted up by the band offset, so the strip-sized grid always sees the current band
+        auto root = std::make_shared<Collection>(ShapeParams(0, 0, 0));
+        root->addShape(scene);
+
+        forEachBandPair(m_worker.get(), m_height, m_bandHeight,
+            [&](int slot, int y, int) {
+                if (slot == 0) {
+                    rasterize(root, m_bandHeight, antialias, y, true);
+                } else {
+                    m_workerRenderer->clear();
+                    drawBand(*m_workerRenderer, root, m_bandHeight, antialias, y, true);
+                }
+            },
+            [&](int slot, int y, int rows) {
+                if (slot == 1)
+                    m_stats.count(COUNTER_BANDS);
+                onBand(y, rows, slot == 0 ? m_renderer->displayGrid : m_workerRenderer->displayGrid);
+            });
+
+        root->removeShape(scene);
+    }
+
+    /**
+     * @brief Render the scene into a strip buffer and pass each band to the sink
+     * @param scene The scene to render
+     * @param antialias Whether to enable antialiasing
+     * @param format The output pixel format
+     * @param strip Buffer holding at least one packed band
+     * @param stripBytes Size of the strip buffer
+     * @param sink Consumer of the packed bands
+     * @return Total number of bytes produced, 0 on error
+     */
+    size_t renderBands(const std::shared_ptr<Collection>& scene, bool antialias, int format, uint8_t* strip, size_t stripBytes, const BandSink& sink) {
+        size_t bytesPerPixel = packedColorSize(format);
+        if (bytesPerPixel == 0 || static_cast<size_t>(m_width) * m_bandHeight * bytesPerPixel > stripBytes)
+            return 0;
+
+        size_t total = 0;
+        forEachBand(scene, antialias, [&](int y, int rows, const Display& grid) {
+            size_t written = m_indexed ? packIndexed(strip, stripBytes, y, rows, format, antialias, grid)
+                                       : pack(strip, stripBytes, rows, format, antialias, grid);
+            total += written;
+            sink(strip, written, y, rows);
+        });
+        return total;
+    }
+
+    /**
+     * @brief Pack rows of the display grid into the output buffer, see writeDenseFramebuffer
+     */
+    size_t pack(uint8_t* raw, size_t maxBytes, int rows, int format, bool antialias, const Display& grid, int rotation = 0) {
+        auto timer = m_stats.measure(STAGE_PACK);
+        size_t written = writeDenseFramebuffer(raw, maxBytes, m_width, rows, format, antialias, grid, rotation);
+        if (written != 0) {
+            m_stats.count(COUNTER_PACKED_PIXELS, static_cast<uint32_t>(m_width) * rows);
+        }
+        return written;
+    }
+
+    /**
+     * @brief Map a band to palette indices and expand it into the output format
+     */
+    size_t packIndexed(uint8_t* raw, size_t maxBytes, int y, int rows, int format, bool antialias, const Display& grid) {
+        auto timer = m_stats.measure(STAGE_PACK);
+        m_indexed->quantize(grid, y, rows, antialias);
+        size_t written = m_indexed->expand(raw, maxBytes, y, rows, format);
+        if (written != 0) {
+            m_stats.count(COUNTER_PACKED_PIXELS, static_cast<uint32_t>(m_width) * rows);
+        }
+        return written;
+    }
+
+    /**
+     * @brief Render the whole frame into palette indices, then expand it into the output buffer
+     * @return Number of bytes written, 0 on error
+     */
+    size_t renderIndexed(const std::shared_ptr<Collection>& scene, bool antialias, uint8_t* raw, size_t maxBytes, int format, int rotation) {
+        size_t bytesPerPixel = packedColorSize(format);
+        if (bytesPerPixel == 0 || static_cast<size_t>(m_width) * m_height * bytesPerPixel > maxBytes)
+            return 0;
+
+        forEachBand(scene, antialias, [&](int y, int rows, const Display& grid) {
+            auto timer = m_stats.measure(STAGE_PACK);
+            m_indexed->quantize(grid, y, rows, antialias);
+        });
+
+        auto timer = m_stats.measure(STAGE_PACK);
+        size_t written = m_indexed->expand(raw, maxBytes, 0, m_height, format, rotation);
+        m_stats.count(COUNTER_PACKED_PIXELS, static_cast<uint32_t>(m_width) * m_height);
+        return written;
+    }
 };
 
 class RendererProtoBuilder : public jac::ProtoBuilder::Opaque<RendererHolder>, public jac::ProtoBuilder::Properties {
+    static constexpr int MAX_SIZE = 512;
+    static constexpr int MAX_BANDED_SIZE = 2048;
+    static constexpr int INDEXED_BAND_HEIGHT = 16;
+
+    static std::vector<Color> paletteFromArray(jac::ContextRef ctx, jac::ArrayWeak colorsVal) {
+        uint32_t len = colorsVal.length();
+        if (len > IndexedFrame::MAX_COLORS) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "Renderer: Palette has more than 256 colors");
+        }
+        std::vector<Color> colors;
+        colors.reserve(len);
+        for (uint32_t i = 0; i < len; ++i) {
+            colors.push_back(jac::fromValue<Color>(ctx, colorsVal.get(i)));
+        }
+        return colors;
+    }
+
+    static RendererHolder* constructIndexed(jac::ContextRef ctx, int w, int h, int band, jac::ValueWeak paletteVal) {
+        // The frame itself is one byte per pixel, only a band of full colors is rasterized at once
+        if (band <= 0)
+            band = INDEXED_BAND_HEIGHT;
+        if (w <= 0 || w > MAX_BANDED_SIZE || h <= 0 || h > MAX_BANDED_SIZE || w * h > MAX_SIZE * MAX_SIZE || w * std::min(band, h) > MAX_SIZE * MAX_SIZE) {
+            jac::Logger::error("Renderer: Invalid indexed size, falling back to 64x64");
+            w = 64;
+            h = 64;
+        }
+
+        std::vector<Color> palette;
+        if (JS_IsArray(ctx, paletteVal.getVal())) {
+            palette = paletteFromArray(ctx, paletteVal.to<jac::ArrayWeak>());
+        }
+
+        auto* holder = new RendererHolder(w, h, band);
+        holder->setPalette(std::move(palette));
+        return holder;
+    }
+
 public:
     static RendererHolder* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
         int w = args[0].to<int>();
         int h = args[1].to<int>();
-        if (w <= 0 || w > 512 || h <= 0 || h > 512) {
+        int band = (args.size() > 2 && !args[2].isUndefined()) ? args[2].to<int>() : 0;
+
+        if (args.size() > 3 && !args[3].isUndefined() && (JS_IsArray(ctx, args[3].getVal()) || args[3].to<bool>())) {
+            return constructIndexed(ctx, w, h, band, args[3]);
+        }
+
+        // Only the band grid has to fit in memory, so banded renderers may be taller
+        if (band > 0 && band < h) {
+            if (w <= 0 || w > MAX_BANDED_SIZE || h <= 0 || h > MAX_BANDED_SIZE || w * band > MAX_SIZE * MAX_SIZE) {
+                jac::Logger::error("Renderer: Invalid banded size, falling back to 64x64");
+                return new RendererHolder(64, 64);
+            }
+            return new RendererHolder(w, h, band);
+        }
+
+        if (w <= 0 || w > MAX_SIZE || h <= 0 || h > MAX_SIZE) {
             w = 64;
             h = 64;
         }
@@ -734,13 +2011,31 @@ public:
 
             int w = holder->getWidth();
             int h = holder->getHeight();
-            holder->getRenderer()->clear();
 
-            holder->getRenderer()->render({*collectionPtr}, {w, h, antialias});
+            holder->beginFrame();
+            auto timer = holder->stats().measure(RendererHolder::STAGE_TOTAL);
 
-            const Display& displayGrid = holder->getRenderer()->displayGrid;
+            size_t frameBytes = 0;
+            if (holder->isIndexed()) {
+                frameBytes = holder->renderIndexed(*collectionPtr, antialias, raw, maxBytes, format, rotation);
+            } else if (holder->isBanded()) {
+                if (rotation % 4 != 0) {
+                    jac::Logger::error("Renderer.render: Rotation is not supported in band mode");
+                    return jac::Value::undefined(ctx);
+                }
 
-            size_t frameBytes = writeDenseFramebuffer(raw, maxBytes, w, h, format, antialias, displayGrid, rotation);
+                size_t bytesPerPixel = packedColorSize(format);
+                if (bytesPerPixel != 0 && static_cast<size_t>(w) * h * bytesPerPixel <= maxBytes) {
+                    holder->forEachBand(*collectionPtr, antialias, [&](int y, int rows, const Display& grid) {
+                        size_t offset = static_cast<size_t>(y) * w * bytesPerPixel;
+                        frameBytes += holder->pack(raw + offset, maxBytes - offset, rows, format, antialias, grid);
+                    });
+                }
+            } else {
+                holder->forEachBand(*collectionPtr, antialias, [&](int, int, const Display& grid) {
+                    frameBytes = holder->pack(raw, maxBytes, h, format, antialias, grid, rotation);
+                });
+            }
 
             if (frameBytes == 0) {
                 jac::Logger::error("Renderer.render: ArrayBuffer too small or invalid format");
@@ -750,6 +2045,98 @@ public:
             return jac::Value(ctx, static_cast<int>(frameBytes));
         }), jac::PropFlags::Enumerable);
 
+        proto.defineProperty("renderBands", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) -> jac::Value {
+            if (args.size() < 3) {
+                jac::Logger::error("Renderer.renderBands: Missing arguments (collection, strip, callback)");
+                return jac::Value::undefined(ctx);
+            }
+
+            auto* holder = getOpaque(ctx, thisVal);
+
+            jac::ValueWeak collectionVal = args[0];
+            auto collectionPtr = reinterpret_cast<std::shared_ptr<Collection>*>(JS_GetOpaque(collectionVal.getVal(), JS_GetClassID(collectionVal.getVal())));
+
+            if (!collectionPtr || !*collectionPtr)
+                return jac::Value::undefined(ctx);
+
+            size_t stripBytes;
+            uint8_t* strip = JS_GetArrayBuffer(ctx, &stripBytes, args[1].getVal());
+            if (!strip) {
+                jac::Logger::error("Renderer.renderBands: Invalid ArrayBuffer passed");
+                return jac::Value::undefined(ctx);
+            }
+
+            jac::Function callback = args[2].to<jac::Function>();
+            bool antialias = (args.size() > 3) ? args[3].to<bool>() : true;
+            int format = (args.size() > 4) ? args[4].to<int>() : 10;
+
+            holder->beginFrame();
+            auto timer = holder->stats().measure(RendererHolder::STAGE_TOTAL);
+
+            size_t total = holder->renderBands(*collectionPtr, antialias, format, strip, stripBytes, [&](const uint8_t*, size_t size, int y, int rows) {
+                callback.call<void>(args[1], y, rows, static_cast<int>(size));
+            });
+
+            if (total == 0) {
+                jac::Logger::error("Renderer.renderBands: Strip buffer too small or invalid format");
+                return jac::Value::undefined(ctx);
+            }
+
+            return jac::Value(ctx, static_cast<int>(total));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("addLayer", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak layerVal) {
+            getOpaque(ctx, thisVal)->addLayer(*StaticLayerProtoBuilder::getOpaque(ctx, layerVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("removeLayer", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak layerVal) {
+            getOpaque(ctx, thisVal)->removeLayer(*StaticLayerProtoBuilder::getOpaque(ctx, layerVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("addTileMap", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak tileMapVal) {
+            getOpaque(ctx, thisVal)->addTileMap(*TileMapProtoBuilder::getOpaque(ctx, tileMapVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("removeTileMap", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak tileMapVal) {
+            getOpaque(ctx, thisVal)->removeTileMap(*TileMapProtoBuilder::getOpaque(ctx, tileMapVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("addParticles", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak particlesVal) {
+            getOpaque(ctx, thisVal)->addParticles(*ParticleSystemProtoBuilder::getOpaque(ctx, particlesVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("removeParticles", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, jac::ValueWeak particlesVal) {
+            getOpaque(ctx, thisVal)->removeParticles(*ParticleSystemProtoBuilder::getOpaque(ctx, particlesVal));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setPalette", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) {
+            auto* holder = getOpaque(ctx, thisVal);
+            if (!holder->isIndexed()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Renderer.setPalette: Renderer was not created with a palette");
+            }
+            std::vector<Color> palette;
+            if (!args.empty() && !args[0].isUndefined()) {
+                palette = paletteFromArray(ctx, args[0].to<jac::ArrayWeak>());
+            }
+            holder->setPalette(std::move(palette));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("setParallel", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, bool enable) {
+            getOpaque(ctx, thisVal)->setParallel(enable);
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("isParallel", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return getOpaque(ctx, thisVal)->isParallel();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("isIndexed", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return getOpaque(ctx, thisVal)->isIndexed();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getBandHeight", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            return jac::Value::from(ctx, getOpaque(ctx, thisVal)->getBandHeight());
+        }), jac::PropFlags::Enumerable);
+
         proto.defineProperty("drawText", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) -> jac::Value {
             if (args.size() < 6) {
                 jac::Logger::error("Renderer.drawText: Missing arguments (buffer, text, x, y, font, color, [wrap], [format])");
@@ -789,12 +2176,45 @@ public:
                 return jac::Value::undefined(ctx);
             }
 
+            auto& stats = holder->stats();
+            auto totalTimer = stats.measure(RendererHolder::STAGE_TOTAL);
+            auto textTimer = stats.measure(RendererHolder::STAGE_TEXT);
+
+            uint32_t textPixels = 0;
             holder->getRenderer()->drawText(text, x, y, font, color, wrap, 0, [&](int px, int py, const Color& c) {
                 writeTextPixel(raw, maxBytes, w, h, format, rotation, px, py, c);
+                textPixels++;
             });
+            stats.count(RendererHolder::COUNTER_TEXT_PIXELS, textPixels);
 
             return jac::Value(ctx, static_cast<int>(frameBytes));
         }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("getStats", ff.newFunctionThisVariadic([](jac::ContextRef ctx, jac::ValueWeak thisVal, std::vector<jac::ValueWeak> args) -> jac::Value {
+            auto* holder = getOpaque(ctx, thisVal);
+            std::array<uint32_t, RendererHolder::Stats::SIZE> snapshot;
+            holder->stats().snapshot(snapshot.data());
+
+            // Reuse the caller's buffer when given, so polling every frame does not allocate
+            if (!args.empty() && !args[0].isUndefined()) {
+                size_t size;
+                uint8_t* raw = JS_GetArrayBuffer(ctx, &size, args[0].getVal());
+                if (!raw || size < sizeof(snapshot)) {
+                    throw jac::Exception::create(jac::Exception::Type::TypeError, "Renderer.getStats: ArrayBuffer too small");
+                }
+                std::memcpy(raw, snapshot.data(), sizeof(snapshot));
+                return jac::Value(ctx, JS_DupValue(ctx, args[0].getVal()));
+            }
+            return jac::ArrayBuffer::create(ctx, std::span<uint32_t>(snapshot));
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("resetStats", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal) {
+            getOpaque(ctx, thisVal)->stats().reset();
+        }), jac::PropFlags::Enumerable);
+
+        proto.defineProperty("streamStats", ff.newFunctionThis([](jac::ContextRef ctx, jac::ValueWeak thisVal, bool enable) {
+            getOpaque(ctx, thisVal)->setStreamStats(enable);
+        }), jac::PropFlags::Enumerable);
     }
 };
 
@@ -816,6 +2236,9 @@ public:
     using RegularPolygonClass = jac::Class<RegularPolygonProtoBuilder>;
     using FontClass = jac::Class<FontProtoBuilder>;
     using TextureClass = jac::Class<TextureProtoBuilder>;
+    using TileMapClass = jac::Class<TileMapProtoBuilder>;
+    using StaticLayerClass = jac::Class<StaticLayerProtoBuilder>;
+    using ParticleSystemClass = jac::Class<ParticleSystemProtoBuilder>;
 
     RendererFeature() {
         RendererClass::init("Renderer");
@@ -829,6 +2252,9 @@ public:
         LineSegmentClass::init("LineSegment");
         PointClass::init("Point");
         RegularPolygonClass::init("RegularPolygon");
+        TileMapClass::init("TileMap");
+        StaticLayerClass::init("StaticLayer");
+        ParticleSystemClass::init("ParticleSystem");
 
         FontClass::init("Font");
         TextureClass::init("Texture");
@@ -864,6 +2290,24 @@ public:
         formatObj.set("XRGB", 12);
         rendererModule.addExport("Format", formatObj);
 
+        // Indices into the Uint32Array view of Renderer.getStats()
+        using Holder = RendererHolder;
+        auto stageIndex = [](size_t stage) { return static_cast<int>(1 + stage * Holder::Stats::STAGE_FIELDS); };
+        auto counterIndex = [](size_t counter) { return static_cast<int>(1 + Holder::STAGE_COUNT * Holder::Stats::STAGE_FIELDS + counter); };
+        jac::Object statObj = jac::Object::create(this->context());
+        statObj.set("FRAMES", 0);
+        statObj.set("CLEAR", stageIndex(Holder::STAGE_CLEAR));
+        statObj.set("RASTERIZE", stageIndex(Holder::STAGE_RASTERIZE));
+        statObj.set("PACK", stageIndex(Holder::STAGE_PACK));
+        statObj.set("TEXT", stageIndex(Holder::STAGE_TEXT));
+        statObj.set("TOTAL", stageIndex(Holder::STAGE_TOTAL));
+        statObj.set("BANDS", counterIndex(Holder::COUNTER_BANDS));
+        statObj.set("PACKED_PIXELS", counterIndex(Holder::COUNTER_PACKED_PIXELS));
+        statObj.set("TEXT_PIXELS", counterIndex(Holder::COUNTER_TEXT_PIXELS));
+        statObj.set("LAYER_REBUILDS", counterIndex(Holder::COUNTER_LAYER_REBUILDS));
+        statObj.set("SIZE", static_cast<int>(Holder::Stats::SIZE));
+        rendererModule.addExport("RenderStat", statObj);
+
         jac::Module& shapesModule = this->newModule("shapes");
         shapesModule.addExport("Collection", CollectionClass::getConstructor(this->context()));
         shapesModule.addExport("Circle", CircleClass::getConstructor(this->context()));
@@ -872,5 +2316,8 @@ public:
         shapesModule.addExport("LineSegment", LineSegmentClass::getConstructor(this->context()));
         shapesModule.addExport("Point", PointClass::getConstructor(this->context()));
         shapesModule.addExport("RegularPolygon", RegularPolygonClass::getConstructor(this->context()));
+        shapesModule.addExport("TileMap", TileMapClass::getConstructor(this->context()));
+        shapesModule.addExport("StaticLayer", StaticLayerClass::getConstructor(this->context()));
+        shapesModule.addExport("ParticleSystem", ParticleSystemClass::getConstructor(this->context()));
     }
 };
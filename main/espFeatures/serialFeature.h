@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "driver/uart.h"
+#include "freeRTOSEventQueue.h"
 
 
 struct SerialOptions {
@@ -55,6 +56,8 @@ class Serial {
     std::atomic<bool> _open = false;
     std::mutex _rxMutex;
     std::deque<PendingRequest> _pending;
+    // processRx drains everything available, one waiting event is enough
+    EventSource _rxEvents{ EventLane::Bulk, OverflowPolicy::Block, true, "serial" };
 
     void ensureOpen() const {
         if (!_open) {
@@ -210,7 +213,7 @@ public:
 
                 switch (event.type) {
                     case UART_DATA:
-                        _feature->scheduleEvent([this]() {
+                        _feature->scheduleEvent(_rxEvents, [this]() {
                             this->processRx();
                         });
                         break;
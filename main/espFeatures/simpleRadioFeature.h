@@ -8,6 +8,8 @@
 #include <sstream>
 #include <iomanip>
 
+#include "freeRTOSEventQueue.h"
+
 
 template<>
 struct jac::ConvTraits<PacketDataType> {
@@ -109,6 +111,8 @@ struct jac::ConvTraits<PacketInfo> {
 
 template<class Next>
 class SimpleRadioFeature : public Next {
+    EventSource _radioEvents{ EventLane::Bulk, OverflowPolicy::Block, false, "radio" };
+
 public:
     void initialize() {
         Next::initialize();
@@ -152,21 +156,21 @@ public:
             switch (type) {
             case PacketDataType::Number:
                 SimpleRadio.setOnNumberCallback([this, callback](double num, PacketInfo info) mutable {
-                    this->scheduleEvent([callback, num, info]() mutable {
+                    this->scheduleEvent(_radioEvents, [callback, num, info]() mutable {
                         callback.call<void>(num, info);
                     });
                 });
                 break;
             case PacketDataType::String:
                 SimpleRadio.setOnStringCallback([this, callback](std::string str, PacketInfo info) mutable {
-                    this->scheduleEvent([callback, str, info]() mutable {
+                    this->scheduleEvent(_radioEvents, [callback, str, info]() mutable {
                         callback.call<void>(str, info);
                     });
                 });
                 break;
             case PacketDataType::KeyValue:
                 SimpleRadio.setOnKeyValueCallback([this, callback](std::string key, double value, PacketInfo info) mutable {
-                    this->scheduleEvent([callback, key, value, info]() mutable {
+                    this->scheduleEvent(_radioEvents, [callback, key, value, info]() mutable {
                         callback.call<void>(key, value, info);
                     });
                 });
@@ -174,7 +178,7 @@ public:
             case PacketDataType::Blob:
                 SimpleRadio.setOnBlobCallback([this, callback](std::span<const uint8_t> data, PacketInfo info) mutable {
                     auto dataVec = std::vector<uint8_t>(data.begin(), data.end());
-                    this->scheduleEvent([this, callback, data = std::move(dataVec), info]() mutable {
+                    this->scheduleEvent(_radioEvents, [this, callback, data = std::move(dataVec), info]() mutable {
                         callback.call<void>(this->toUint8Array(data), info);
                     });
                 });
@@ -4,10 +4,13 @@
 #include <jac/machine/functionFactory.h>
 #include <jac/machine/machine.h>
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <noal_func.h>
 #include <optional>
 #include <array>
+#include <span>
 
 #include "driver/spi_common.h"
 #include "driver/spi_master.h"
@@ -19,11 +22,51 @@ class SPI {
     spi_host_device_t host;
     spi_device_handle_t deviceHandle;
     bool open = false;
+    std::mutex mutex;
 
 public:
+    static constexpr size_t MAX_CHUNK = 4092;
+
     SPI(int hostId) : host(static_cast<spi_host_device_t>(hostId)) {}
 
+    /**
+     * @brief Write data in chunks of at most MAX_CHUNK bytes without allocating a receive buffer
+     * @param data Data to write
+     * @param cs Chip-select pin, toggled around each chunk
+     * @param qio Whether to use quad SPI mode
+     */
+    void write(std::span<const uint8_t> data, int cs, bool qio = false) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!open) {
+            throw std::runtime_error("SPI not configured");
+        }
+        gpio_set_direction(static_cast<gpio_num_t>(cs), GPIO_MODE_OUTPUT);
+
+        for (size_t n = 0; n < data.size(); n += MAX_CHUNK) {
+            size_t len = std::min(MAX_CHUNK, data.size() - n);
+            gpio_set_level(static_cast<gpio_num_t>(cs), 0);
+
+            spi_transaction_t transaction = {
+                .flags = static_cast<uint32_t>(qio ? SPI_TRANS_MODE_QIO : 0),
+                .cmd = 0,
+                .addr = 0,
+                .length = len * 8,
+                .rxlength = 0,
+                .user = nullptr,
+                .tx_buffer = data.data() + n,
+                .rx_buffer = nullptr
+            };
+
+            esp_err_t err = spi_device_transmit(deviceHandle, &transaction);
+            gpio_set_level(static_cast<gpio_num_t>(cs), 1);
+            if (err != ESP_OK) {
+                throw std::runtime_error(esp_err_to_name(err));
+            }
+        }
+    }
+
     std::vector<uint8_t> transfer(std::span<uint8_t> data, int cs, int rxLength = 0, bool qio = false) {
+        std::lock_guard<std::mutex> lock(mutex);
         if (!open) {
             throw std::runtime_error("SPI not configured");
         }
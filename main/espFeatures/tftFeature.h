@@ -0,0 +1,547 @@
+#pragma once
+
+#include <jac/machine/class.h>
+#include <jac/machine/functionFactory.h>
+#include <jac/machine/machine.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../util/capsAllocator.h"
+#include "../util/iDisplayHolder.h"
+#include "../util/mipiDbiPanel.h"
+#include "displayBindings.h"
+
+
+struct TftOptions {
+    MipiDbiConfig panel;
+    int host = SPI2_HOST;
+    int sck = -1;
+    int mosi = -1;
+    int cs = -1;
+    int dc = -1;
+    int rst = -1;
+    int bl = -1;
+    int baud = 40'000'000;
+};
+
+
+/**
+ * MIPI-DBI bus on SPI with the DC line driven from the pre-transfer callback.
+ *
+ * Commands, parameters and pixel data all go through one transaction queue so
+ * they stay ordered without waiting, the caller only blocks when the queue or
+ * every pixel buffer is in flight.
+ */
+class EspDbiBus {
+    static constexpr size_t QUEUE_SIZE = 8;
+    static constexpr size_t BUFFER_COUNT = 2;
+    static constexpr size_t BUFFER_SIZE = 8 * 1024;
+
+    using DmaBuffer = std::vector<uint8_t, EspCapsAllocator<MALLOC_CAP_DMA, uint8_t>>;
+
+    spi_host_device_t _host;
+    spi_device_handle_t _device = nullptr;
+    int _dc = -1;
+    bool _busOpen = false;
+
+    std::array<spi_transaction_t, QUEUE_SIZE> _transactions{};
+    uint64_t _queued = 0;
+    uint64_t _completed = 0;
+
+    std::array<DmaBuffer, BUFFER_COUNT> _buffers;
+    std::array<uint64_t, BUFFER_COUNT> _bufferDone{};
+    size_t _nextBuffer = 0;
+
+    static void IRAM_ATTR preTransfer(spi_transaction_t* t) {
+        intptr_t value = reinterpret_cast<intptr_t>(t->user);
+        gpio_set_level(static_cast<gpio_num_t>(value >> 1), value & 1);
+    }
+
+    void reapOne() {
+        spi_transaction_t* done;
+        esp_err_t err = spi_device_get_trans_result(_device, &done, portMAX_DELAY);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+        _completed++;
+    }
+
+    void queue(bool data, const uint8_t* bytes, size_t size, bool inline_) {
+        if (_queued - _completed == QUEUE_SIZE) {
+            reapOne();
+        }
+        spi_transaction_t& t = _transactions[_queued % QUEUE_SIZE];
+        t = {};
+        t.length = size * 8;
+        t.user = reinterpret_cast<void*>(static_cast<intptr_t>((_dc << 1) | (data ? 1 : 0)));
+        if (inline_) {
+            t.flags = SPI_TRANS_USE_TXDATA;
+            std::memcpy(t.tx_data, bytes, size);
+        }
+        else {
+            t.tx_buffer = bytes;
+        }
+
+        esp_err_t err = spi_device_queue_trans(_device, &t, portMAX_DELAY);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+        _queued++;
+    }
+
+public:
+    EspDbiBus(const TftOptions& options):
+        _host(static_cast<spi_host_device_t>(options.host)),
+        _dc(options.dc)
+    {
+        for (auto& buffer : _buffers) {
+            buffer.resize(BUFFER_SIZE);
+        }
+
+        gpio_reset_pin(static_cast<gpio_num_t>(_dc));
+        gpio_set_direction(static_cast<gpio_num_t>(_dc), GPIO_MODE_OUTPUT);
+
+        spi_bus_config_t busConfig = {
+            .data0_io_num = options.mosi,
+            .data1_io_num = -1,
+            .sclk_io_num = options.sck,
+            .data2_io_num = -1,
+            .data3_io_num = -1,
+            .data4_io_num = -1,
+            .data5_io_num = -1,
+            .data6_io_num = -1,
+            .data7_io_num = -1,
+            .max_transfer_sz = static_cast<int>(BUFFER_SIZE),
+            .flags = SPICOMMON_BUSFLAG_MASTER,
+            .isr_cpu_id = ESP_INTR_CPU_AFFINITY_AUTO,
+            .intr_flags = 0,
+        };
+        esp_err_t err = spi_bus_initialize(_host, &busConfig, SPI_DMA_CH_AUTO);
+        if (err != ESP_OK) {
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+        _busOpen = true;
+
+        spi_device_interface_config_t deviceConfig = {
+            .command_bits = 0,
+            .address_bits = 0,
+            .dummy_bits = 0,
+            .mode = 0,
+            .clock_source = SPI_CLK_SRC_DEFAULT,
+            .duty_cycle_pos = 0,
+            .cs_ena_pretrans = 0,
+            .cs_ena_posttrans = 0,
+            .clock_speed_hz = options.baud,
+            .input_delay_ns = 0,
+            .spics_io_num = options.cs,
+            .flags = SPI_DEVICE_HALFDUPLEX,
+            .queue_size = static_cast<int>(QUEUE_SIZE),
+            .pre_cb = preTransfer,
+            .post_cb = nullptr,
+        };
+        err = spi_bus_add_device(_host, &deviceConfig, &_device);
+        if (err != ESP_OK) {
+            spi_bus_free(_host);
+            _busOpen = false;
+            throw std::runtime_error(esp_err_to_name(err));
+        }
+    }
+
+    EspDbiBus(const EspDbiBus&) = delete;
+    EspDbiBus& operator=(const EspDbiBus&) = delete;
+
+    ~EspDbiBus() {
+        if (_device) {
+            waitIdle();
+            spi_bus_remove_device(_device);
+        }
+        if (_busOpen) {
+            spi_bus_free(_host);
+        }
+    }
+
+    void command(uint8_t cmd, const uint8_t* params, size_t count) {
+        queue(false, &cmd, 1, true);
+        if (count == 0) {
+            return;
+        }
+        if (count <= 4) {
+            queue(true, params, count, true);
+            return;
+        }
+        size_t capacity;
+        uint8_t* buffer = acquire(capacity);
+        std::memcpy(buffer, params, std::min(count, capacity));
+        submit(buffer, std::min(count, capacity));
+    }
+
+    uint8_t* acquire(size_t& capacity) {
+        while (_bufferDone[_nextBuffer] > _completed) {
+            reapOne();
+        }
+        capacity = BUFFER_SIZE;
+        return _buffers[_nextBuffer].data();
+    }
+
+    void submit(uint8_t* buffer, size_t size) {
+        queue(true, buffer, size, false);
+        _bufferDone[_nextBuffer] = _queued;
+        _nextBuffer = (_nextBuffer + 1) % BUFFER_COUNT;
+    }
+
+    void waitIdle() {
+        while (_completed < _queued) {
+            reapOne();
+        }
+    }
+
+    void delayMs(int ms) {
+        waitIdle();
+        vTaskDelay(pdMS_TO_TICKS(ms));
+    }
+};
+
+
+/**
+ * SPI TFT panel, frames and regions are converted to RGB565 straight into the
+ * DMA buffers of the bus.
+ *
+ * With PSRAM a shadow of the panel RAM is kept as well, so scattered pixel
+ * writes go out as one window around them and brightness changes redraw the
+ * panel. Without it, every pixel is sent as its own window.
+ */
+class TftDisplay : public IDisplayHolder {
+    using Shadow = std::vector<uint8_t, EspCapsAllocator<MALLOC_CAP_SPIRAM, uint8_t>>;
+
+    // Bounding box of scattered pixel writes
+    struct Bounds {
+        int x0 = INT32_MAX, y0 = INT32_MAX, x1 = -1, y1 = -1;
+
+        void add(int x, int y) {
+            x0 = std::min(x0, x);
+            y0 = std::min(y0, y);
+            x1 = std::max(x1, x);
+            y1 = std::max(y1, y);
+        }
+
+        FrameRegion region() const {
+            return { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+        }
+    };
+
+    TftOptions _options;
+    EspDbiBus _bus;
+    MipiDbiPanel<EspDbiBus> _panel;
+    DisplayUtils::ColorLut _lut;
+    Shadow _shadow; // in the panel format, before brightness
+    bool _initialized = false;
+
+    DisplayColor adjust(DisplayColor color) const {
+        return { _lut.table[color.r], _lut.table[color.g], _lut.table[color.b], color.a };
+    }
+
+    FrameRegion fullWindow() const {
+        return { 0, 0, _panel.width(), _panel.height() };
+    }
+
+    size_t shadowStride() const {
+        return static_cast<size_t>(_panel.width()) * 2;
+    }
+
+    uint8_t* shadowAt(int x, int y) {
+        return _shadow.data() + y * shadowStride() + x * 2;
+    }
+
+    void flushShadow(const FrameRegion& region) {
+        _panel.writeRegion(shadowAt(region.x, region.y), shadowStride(), mipi::PIXEL_FORMAT, region, &_lut);
+    }
+
+    // Returns the part of the region on the panel, empty if none
+    FrameRegion writeShadow(const uint8_t* data, size_t stride, int format, const FrameRegion& region) {
+        size_t srcPixel = packedColorSize(format);
+        if (srcPixel == 0) {
+            throw std::runtime_error("Invalid color format");
+        }
+        FrameRegion clipped = region;
+        if (!_panel.clip(clipped)) {
+            return { 0, 0, 0, 0 };
+        }
+        data += (clipped.y - region.y) * stride + (clipped.x - region.x) * srcPixel;
+
+        DisplayLayout row{ clipped.width, 1, mipi::PIXEL_FORMAT, shadowStride() };
+        for (int y = 0; y < clipped.height; ++y) {
+            DisplayUtils::convertFrame(data + y * stride, clipped.width * srcPixel, format, row,
+                                       shadowAt(clipped.x, clipped.y + y));
+        }
+        return clipped;
+    }
+
+    void clearShadow() {
+        std::fill(_shadow.begin(), _shadow.end(), 0);
+    }
+
+    void setPixel(int x, int y, DisplayColor color, Bounds& bounds) {
+        if (_shadow.empty()) {
+            _panel.fill({ x, y, 1, 1 }, adjust(color));
+            return;
+        }
+        DisplayUtils::packColor(shadowAt(x, y), mipi::PIXEL_FORMAT, color);
+        bounds.add(x, y);
+    }
+
+    void flushPixels(const Bounds& bounds, bool clearPrevious) {
+        if (_shadow.empty()) {
+            return;
+        }
+        if (clearPrevious) {
+            flushShadow(fullWindow());
+        }
+        else if (bounds.x1 >= 0) {
+            flushShadow(bounds.region());
+        }
+    }
+
+public:
+    TftDisplay(const TftOptions& options):
+        _options(options),
+        _bus(options),
+        _panel(_bus, options.panel)
+    {
+        try {
+            _shadow.resize(shadowStride() * _panel.height());
+        }
+        catch (const std::bad_alloc&) {
+            // No PSRAM, run without the shadow
+        }
+    }
+
+    void start() override {
+        if (_options.rst >= 0) {
+            gpio_num_t rst = static_cast<gpio_num_t>(_options.rst);
+            gpio_reset_pin(rst);
+            gpio_set_direction(rst, GPIO_MODE_OUTPUT);
+            gpio_set_level(rst, 0);
+            vTaskDelay(pdMS_TO_TICKS(10));
+            gpio_set_level(rst, 1);
+            vTaskDelay(pdMS_TO_TICKS(120));
+        }
+
+        _panel.init();
+        clear();
+
+        if (_options.bl >= 0) {
+            gpio_num_t bl = static_cast<gpio_num_t>(_options.bl);
+            gpio_reset_pin(bl);
+            gpio_set_direction(bl, GPIO_MODE_OUTPUT);
+            gpio_set_level(bl, 1);
+        }
+        _initialized = true;
+    }
+
+    void clear() override {
+        clearShadow();
+        _panel.fill(fullWindow(), DisplayColors::BLACK);
+    }
+
+    void setBrightness(uint8_t brightness) override {
+        // Backlight is switched, levels in between are scaled into the pixels
+        _lut.build(brightness, 1.0f);
+        if (_options.bl >= 0) {
+            gpio_set_level(static_cast<gpio_num_t>(_options.bl), brightness > 0);
+        }
+        if (_initialized && !_shadow.empty()) {
+            flushShadow(fullWindow());
+        }
+    }
+
+    bool isInitialized() const override {
+        return _initialized;
+    }
+
+    DisplayLayout nativeLayout() const override {
+        return { _panel.width(), _panel.height(), mipi::PIXEL_FORMAT, shadowStride() };
+    }
+
+    void setBuffer(const uint8_t* rawData, size_t size, int format, bool clearPrevious) override {
+        size_t stride = packedColorSize(format) * _panel.width();
+        if (stride == 0) {
+            throw std::runtime_error("Invalid color format");
+        }
+        int rows = std::min<size_t>(size / stride, _panel.height());
+
+        if (!_shadow.empty()) {
+            if (clearPrevious) {
+                clearShadow();
+            }
+            DisplayUtils::convertFrame(rawData, size, format, nativeLayout(), _shadow.data());
+            // A partial last row counts as a whole one
+            int touched = std::min<size_t>((size + stride - 1) / stride, _panel.height());
+            flushShadow({ 0, 0, _panel.width(), clearPrevious ? _panel.height() : touched });
+            return;
+        }
+
+        _panel.writeRegion(rawData, stride, format, { 0, 0, _panel.width(), rows }, &_lut);
+        if (clearPrevious && rows < _panel.height()) {
+            _panel.fill({ 0, rows, _panel.width(), _panel.height() - rows }, DisplayColors::BLACK);
+        }
+    }
+
+    void setRegion(const uint8_t* data, size_t stride, int format, const FrameRegion& region) override {
+        if (!_shadow.empty()) {
+            FrameRegion clipped = writeShadow(data, stride, format, region);
+            if (clipped.width > 0) {
+                flushShadow(clipped);
+            }
+            return;
+        }
+        if (!_panel.writeRegion(data, stride, format, region, &_lut)) {
+            throw std::runtime_error("Invalid color format");
+        }
+    }
+
+    void setBufferFromRaw(const std::vector<DisplayPixel>& pixels, bool clearPrevious) override {
+        if (clearPrevious && _shadow.empty()) {
+            clear();
+        }
+        else if (clearPrevious) {
+            clearShadow();
+        }
+        Bounds bounds;
+        for (const DisplayPixel& pixel : pixels) {
+            if (pixel.x >= 0 && pixel.x < _panel.width() && pixel.y >= 0 && pixel.y < _panel.height()) {
+                setPixel(pixel.x, pixel.y, pixel.color, bounds);
+            }
+        }
+        flushPixels(bounds, clearPrevious);
+    }
+
+    void setPixels(const uint32_t* records, size_t count, PixelRecordLayout layout, bool clearPrevious) override {
+        if (clearPrevious && _shadow.empty()) {
+            clear();
+        }
+        else if (clearPrevious) {
+            clearShadow();
+        }
+        Bounds bounds;
+        DisplayUtils::forEachPackedPixel(records, count, layout, _panel.width(), _panel.height(),
+            [&](int x, int y, DisplayColor color) {
+                setPixel(x, y, color, bounds);
+            });
+        flushPixels(bounds, clearPrevious);
+    }
+};
+
+
+template<class Next>
+class TftFeature : public Next {
+    static void checkPin(int pin, const char* name) {
+        if (Next::PlatformInfo::PinConfig::DIGITAL_PINS.find(pin) == Next::PlatformInfo::PinConfig::DIGITAL_PINS.end()) {
+            throw std::runtime_error(std::string("Invalid pin number for ") + name);
+        }
+    }
+
+    static TftOptions optionsFromObject(jac::Object obj) {
+        for (auto key : { "sck", "mosi", "cs", "dc" }) {
+            if (!obj.hasProperty(key)) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, std::string("Missing required property '") + key + "'");
+            }
+        }
+
+        TftOptions options;
+        options.sck = obj.get<int>("sck");
+        options.mosi = obj.get<int>("mosi");
+        options.cs = obj.get<int>("cs");
+        options.dc = obj.get<int>("dc");
+        if (obj.hasProperty("rst")) { options.rst = obj.get<int>("rst"); }
+        if (obj.hasProperty("bl")) { options.bl = obj.get<int>("bl"); }
+        if (obj.hasProperty("baud")) { options.baud = obj.get<int>("baud"); }
+        if (obj.hasProperty("host")) { options.host = obj.get<int>("host"); }
+
+        MipiDbiConfig& panel = options.panel;
+        if (obj.hasProperty("controller")) {
+            auto controller = obj.get<std::string>("controller");
+            if (controller == "st7789") {
+                panel.controller = MipiDbiController::ST7789;
+            }
+            else if (controller == "ili9341") {
+                panel.controller = MipiDbiController::ILI9341;
+                panel.bgr = true;
+            }
+            else {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Invalid controller");
+            }
+        }
+        if (obj.hasProperty("width")) { panel.width = obj.get<int>("width"); }
+        if (obj.hasProperty("height")) { panel.height = obj.get<int>("height"); }
+        if (obj.hasProperty("rotation")) { panel.rotation = obj.get<int>("rotation"); }
+        if (obj.hasProperty("colOffset")) { panel.colOffset = obj.get<int>("colOffset"); }
+        if (obj.hasProperty("rowOffset")) { panel.rowOffset = obj.get<int>("rowOffset"); }
+        if (obj.hasProperty("invert")) { panel.invert = obj.get<bool>("invert"); }
+        if (obj.hasProperty("bgr")) { panel.bgr = obj.get<bool>("bgr"); }
+
+        checkPin(options.sck, "sck");
+        checkPin(options.mosi, "mosi");
+        checkPin(options.cs, "cs");
+        checkPin(options.dc, "dc");
+        if (options.rst >= 0) { checkPin(options.rst, "rst"); }
+        if (options.bl >= 0) { checkPin(options.bl, "bl"); }
+
+        if (panel.width <= 0 || panel.height <= 0 || panel.width > 480 || panel.height > 480) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "width and height must be between 1 and 480");
+        }
+        if (panel.rotation < 0 || panel.rotation > 3) {
+            throw jac::Exception::create(jac::Exception::Type::RangeError, "rotation must be between 0 and 3");
+        }
+        return options;
+    }
+
+    struct TftProtoBuilder : public jac::ProtoBuilder::Opaque<TftDisplay>, public jac::ProtoBuilder::Properties {
+        static TftDisplay* constructOpaque(jac::ContextRef ctx, std::vector<jac::ValueWeak> args) {
+            if (args.empty()) {
+                throw jac::Exception::create(jac::Exception::Type::TypeError, "Expected an options object");
+            }
+            auto display = std::make_unique<TftDisplay>(optionsFromObject(args[0].to<jac::Object>()));
+            display->start();
+            return display.release();
+        }
+
+        static void destroyOpaque(JSRuntime* rt, TftDisplay* ptr) noexcept {
+            if (!ptr) {
+                return;
+            }
+            DisplayProtoBindings<TftDisplay>::release(ptr);
+            delete ptr;
+        }
+
+        static void addProperties(jac::ContextRef ctx, jac::Object proto) {
+            DisplayProtoBindings<TftDisplay>::addCommonProperties(ctx, proto);
+        }
+    };
+
+public:
+    using TftClass = jac::Class<TftProtoBuilder>;
+
+    TftFeature() {
+        TftClass::init("Tft");
+    }
+
+    void initialize() {
+        Next::initialize();
+
+        jac::Module& mod = this->newModule("tft");
+        mod.addExport("Tft", TftClass::getConstructor(this->context()));
+    }
+};
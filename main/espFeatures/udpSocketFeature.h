@@ -25,6 +25,7 @@
 #include <unistd.h>
 
 #include "../platform/espWifi.h"
+#include "freeRTOSEventQueue.h"
 
 
 template<class UdpFeature>
@@ -43,6 +44,8 @@ private:
     std::function<void(uint32_t)> _onReadable;  // uint32_t: number of datagrams available
     UdpFeature* _feature;
     unsigned _maxQueueSize;
+    // A single waiting notification reports every datagram queued until it runs
+    EventSource _readableEvents{ EventLane::Bulk, OverflowPolicy::Block, true, "udp" };
 
     int _sockfd{-1};
     std::mutex _mutex;
@@ -126,13 +129,15 @@ public:
                 self._rxQueue.push_back({ std::move(data), std::move(addr), port });
 
                 if (self._onReadable) {
-                    self._feature->scheduleEvent([&self, count = self._rxQueue.size()]() {
+                    self._feature->scheduleEvent(self._readableEvents, [&self]() {
                         decltype(self._onReadable) onReadable;
+                        size_t count;
                         {
                             std::lock_guard<std::mutex> lock(self._mutex);
                             onReadable = self._onReadable;
+                            count = self._rxQueue.size();
                         }
-                        if (onReadable) {
+                        if (onReadable && count > 0) {
                             onReadable(static_cast<uint32_t>(count));
                         }
                     });
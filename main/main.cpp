@@ -14,16 +14,25 @@
 
 #include <jac/link/encoders/cobs.h>
 #include <jac/link/mux.h>
+#include <jac/link/routerCommunicator.h>
 
 #include "espFeatures/adcFeature.h"
+#include "espFeatures/blitFeature.h"
+#include "espFeatures/drawFeature.h"
+#include "espFeatures/eventLoopStatsFeature.h"
 #include "espFeatures/extendLifetimeFeature.h"
+#include "espFeatures/framePresenterFeature.h"
+#include "espFeatures/frameSchedulerFeature.h"
 #include "espFeatures/freeRTOSEventQueue.h"
 #include "espFeatures/gpioFeature.h"
 #include "espFeatures/gridui/gridUiFeature.h"
+#include "espFeatures/hub75Feature.h"
 #include "espFeatures/i2cFeature.h"
+#include "espFeatures/i80TftFeature.h"
 #include "espFeatures/raycasterFeature.h"
 #include "espFeatures/oneWireFeature.h"
 #include "espFeatures/spiFeature.h"
+#include "espFeatures/tftFeature.h"
 #include "espFeatures/pwmFeature.h"
 #include "espFeatures/motorFeature.h"
 #include "espFeatures/pulseCounterFeature.h"
@@ -40,6 +49,7 @@
 #include "platform/espNvsKeyValue.h"
 #include "platform/espWifi.h"
 
+#include "util/statsChannel.h"
 #include "util/tcpStream.h"
 #include "util/uartStream.h"
 
@@ -56,6 +66,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
+#include "soc/soc_caps.h"
 
 #if defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
 #include "util/jtagStream.h"
@@ -84,6 +95,7 @@ using Machine = jac::ComposeMachine<
     jac::NodeModuleLoaderFeature,
     jac::TimersFeature,
     TimestampFeature,
+    EventLoopStatsFeature,
     ExtendLifetimeFeature,
     ConvertFeature,
     GpioFeature,
@@ -100,7 +112,18 @@ using Machine = jac::ComposeMachine<
     WifiFeature,
     GridUiFeature,
     RendererFeature,
+    DrawFeature,
+    BlitFeature,
     RaycasterFeature,
+    FramePresenterFeature,
+    FrameSchedulerFeature,
+#if SOC_LCD_I80_SUPPORTED
+    Hub75Feature,
+#endif
+    TftFeature,
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    I80TftFeature,
+#endif
     jac::KeyValueFeature,
     SelectFeature,
     UdpSocketFeature,
@@ -145,6 +168,10 @@ using Mux_t = jac::Mux<jac::CobsEncoder>;
 std::unique_ptr<Mux_t> muxUart;
 std::unique_ptr<Mux_t> muxTcp;
 
+// Device-link channel carrying live statistics (see util/statsChannel.h)
+static constexpr uint8_t STATS_CHANNEL = 24;
+std::unique_ptr<jac::RouterOutputStreamCommunicator> statsOutput;
+
 #if defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
 std::unique_ptr<Mux_t> muxJtag;
 #endif
@@ -258,6 +285,10 @@ int main() {
         esp_pthread_set_cfg(&cfg);
     });
 
+    statsOutput = std::make_unique<jac::RouterOutputStreamCommunicator>(
+        device.router(), STATS_CHANNEL, std::vector<int>{});
+    StatsChannel::bind(std::make_unique<jac::LinkWritable>(statsOutput.get()));
+
     esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
     cfg.stack_size = 10 * 1024;
     cfg.inherit_cfg = true;
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(ESP_PLATFORM) && !CONFIG_FREERTOS_UNICORE
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+
+/**
+ * Persistent thread running one job at a time alongside the caller.
+ *
+ * On dual-core ESP32 targets the thread is pinned to the core the creating task does not run on.
+ */
+class BandWorker {
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::function<void()> _job;
+    std::exception_ptr _error;
+    bool _busy = false;
+    bool _stop = false;
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _cv.wait(lock, [this]() { return _stop || _busy; });
+            if (_stop) {
+                return;
+            }
+
+            lock.unlock();
+            try {
+                _job();
+            }
+            catch (...) {
+                _error = std::current_exception();
+            }
+            lock.lock();
+
+            _busy = false;
+            _cv.notify_all();
+        }
+    }
+
+public:
+    BandWorker(size_t stackSize = 8 * 1024) {
+#if defined(ESP_PLATFORM) && !CONFIG_FREERTOS_UNICORE
+        esp_pthread_cfg_t previous;
+        bool hadConfig = esp_pthread_get_cfg(&previous) == ESP_OK;
+
+        esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+        cfg.stack_size = stackSize;
+        cfg.thread_name = "band";
+        cfg.pin_to_core = xPortGetCoreID() == 0 ? 1 : 0;
+        cfg.inherit_cfg = false;
+        esp_pthread_set_cfg(&cfg);
+#else
+        (void) stackSize;
+#endif
+
+        _thread = std::thread([this]() {
+            loop();
+        });
+
+#if defined(ESP_PLATFORM) && !CONFIG_FREERTOS_UNICORE
+        if (hadConfig) {
+            esp_pthread_set_cfg(&previous);
+        }
+#endif
+    }
+
+    BandWorker(const BandWorker&) = delete;
+    BandWorker& operator=(const BandWorker&) = delete;
+
+    /**
+     * @brief Start a job on the worker, the previous job must have been waited for
+     */
+    void run(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = std::move(job);
+            _busy = true;
+        }
+        _cv.notify_all();
+    }
+
+    /**
+     * @brief Wait for the current job, rethrowing its exception if it failed
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return !_busy; });
+        if (_error) {
+            std::exception_ptr error = std::exchange(_error, nullptr);
+            std::rethrow_exception(error);
+        }
+    }
+
+    ~BandWorker() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+};
+
+
+/**
+ * @brief Draw the bands of a frame and hand them over in band order
+ *
+ * Without a worker every band is drawn into slot 0. With one, the worker draws each odd band into
+ * slot 1 while the caller draws the even band before it into slot 0, and the pair is handed over
+ * once both are drawn, so nothing else runs while the worker is busy.
+ *
+ * @param draw Called as draw(slot, y, rows), on the worker for slot 1
+ * @param onBand Called as onBand(slot, y, rows) on the calling thread
+ */
+template <typename Draw, typename OnBand>
+void forEachBandPair(BandWorker* worker, int height, int bandHeight, Draw&& draw, OnBand&& onBand) {
+    if (!worker) {
+        for (int y = 0; y < height; y += bandHeight) {
+            int rows = std::min(bandHeight, height - y);
+            draw(0, y, rows);
+            onBand(0, y, rows);
+        }
+        return;
+    }
+
+    for (int y = 0; y < height; y += 2 * bandHeight) {
+        int rows = std::min(bandHeight, height - y);
+        int nextY = y + bandHeight;
+        int nextRows = std::min(bandHeight, height - nextY);
+        bool paired = nextRows > 0;
+        if (paired) {
+            worker->run([&draw, nextY, nextRows]() {
+                draw(1, nextY, nextRows);
+            });
+        }
+
+        try {
+            draw(0, y, rows);
+        }
+        catch (...) {
+            // The worker job refers to this frame, it has to finish before unwinding
+            if (paired) {
+                try {
+                    worker->wait();
+                }
+                catch (...) {}
+            }
+            throw;
+        }
+
+        if (paired) {
+            worker->wait();
+        }
+        onBand(0, y, rows);
+        if (paired) {
+            onBand(1, nextY, nextRows);
+        }
+    }
+}
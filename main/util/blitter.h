@@ -0,0 +1,347 @@
+#pragma once
+
+#include "displayTypes.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#include "esp_async_memcpy.h"
+#include "esp_attr.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#define BLITTER_ASYNC_MEMCPY 1
+#else
+#define BLITTER_ASYNC_MEMCPY 0
+#endif
+
+
+struct BlitImage {
+    uint8_t* data;
+    int width;
+    int height;
+    int format;
+};
+
+struct BlitOptions {
+    // Source rectangle, a negative size means the whole source
+    int sx = 0;
+    int sy = 0;
+    int sw = -1;
+    int sh = -1;
+
+    // Destination position and size, a non-positive size means the scaled source size
+    int dx = 0;
+    int dy = 0;
+    int dw = 0;
+    int dh = 0;
+
+    // Integer scale used when no destination size is given
+    int scale = 1;
+
+    // Clockwise rotation in 90 degree steps, flips are applied after rotation
+    int rotation = 0;
+    bool flipX = false;
+    bool flipY = false;
+
+    // Source pixels equal to the colorkey (in the source format) are skipped
+    bool useColorKey = false;
+    DisplayColor colorKey{};
+};
+
+/**
+ * Rectangle copy between packed framebuffers with format conversion, colorkey,
+ * nearest-neighbour scaling, flips and 90 degree rotation.
+ *
+ * Plain same-format copies go row by row with memcpy. On ESP32-S3, large copies between
+ * DMA-capable internal buffers are offloaded to the async memcpy engine.
+ */
+class Blitter {
+public:
+    // Copies below this many bytes are not worth the DMA setup
+    static constexpr size_t ASYNC_THRESHOLD = 4096;
+
+private:
+#if BLITTER_ASYNC_MEMCPY
+    async_memcpy_handle_t _mcp = nullptr;
+    SemaphoreHandle_t _done = nullptr;
+    bool _asyncFailed = false;
+
+    static bool IRAM_ATTR onCopyDone(async_memcpy_handle_t, async_memcpy_event_t*, void* arg) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(static_cast<SemaphoreHandle_t>(arg), &woken);
+        return woken == pdTRUE;
+    }
+
+    bool ensureAsync() {
+        if (_mcp) {
+            return true;
+        }
+        if (_asyncFailed) {
+            return false;
+        }
+
+        async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+        config.backlog = 16;
+        if (esp_async_memcpy_install(&config, &_mcp) != ESP_OK) {
+            _mcp = nullptr;
+            _asyncFailed = true;
+            return false;
+        }
+        _done = xSemaphoreCreateCounting(config.backlog, 0);
+        return true;
+    }
+
+    /**
+     * @brief Copy rows with the DMA engine, falling back to memcpy for rows it rejects
+     * @return False if nothing could be offloaded
+     */
+    bool copyRowsAsync(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t rowBytes, int rows) {
+        if (!esp_ptr_dma_capable(dst) || !esp_ptr_dma_capable(src) || !ensureAsync()) {
+            return false;
+        }
+
+        // Contiguous rows go out as a single transaction
+        if (dstStride == rowBytes && srcStride == rowBytes) {
+            rowBytes *= rows;
+            rows = 1;
+        }
+
+        int pending = 0;
+        for (int y = 0; y < rows; ++y) {
+            uint8_t* d = dst + dstStride * y;
+            const uint8_t* s = src + srcStride * y;
+            if (esp_async_memcpy(_mcp, d, const_cast<uint8_t*>(s), rowBytes, onCopyDone, _done) == ESP_OK) {
+                pending++;
+            } else {
+                std::memcpy(d, s, rowBytes);
+            }
+
+            if (pending == 16) {
+                for (; pending > 0; --pending) {
+                    xSemaphoreTake(_done, portMAX_DELAY);
+                }
+            }
+        }
+        for (; pending > 0; --pending) {
+            xSemaphoreTake(_done, portMAX_DELAY);
+        }
+        return true;
+    }
+#endif
+
+    static void copyRows(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t rowBytes, int rows) {
+        // Moving down within one buffer must start at the bottom so no source row is overwritten before it is read
+        if (dst > src) {
+            for (int y = rows - 1; y >= 0; --y) {
+                std::memmove(dst + dstStride * y, src + srcStride * y, rowBytes);
+            }
+            return;
+        }
+        for (int y = 0; y < rows; ++y) {
+            std::memmove(dst + dstStride * y, src + srcStride * y, rowBytes);
+        }
+    }
+
+    template<size_t BPP>
+    static bool sameBytes(const uint8_t* a, const uint8_t* b) {
+        if constexpr (BPP == 1) {
+            return a[0] == b[0];
+        } else {
+            return std::memcmp(a, b, BPP) == 0;
+        }
+    }
+
+    /**
+     * @brief Generic transformed copy
+     * @tparam SrcBPP Source pixel size, 0 when formats differ and pixels have to be converted
+     */
+    template<size_t SrcBPP, bool ColorKey>
+    static size_t transform(const BlitImage& dst, const BlitImage& src, int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh,
+                            int rotation, bool flipX, bool flipY, const uint8_t* key) {
+        size_t srcBpp = SrcBPP != 0 ? SrcBPP : packedColorSize(src.format);
+        size_t dstBpp = SrcBPP != 0 ? SrcBPP : packedColorSize(dst.format);
+
+        // Size of the rotated source rectangle, mapped onto dw x dh
+        int rw = (rotation & 1) ? sh : sw;
+        int rh = (rotation & 1) ? sw : sh;
+
+        int u0 = std::max(0, -dx);
+        int v0 = std::max(0, -dy);
+        int u1 = std::min(dw, dst.width - dx);
+        int v1 = std::min(dh, dst.height - dy);
+        if (u0 >= u1 || v0 >= v1) {
+            return 0;
+        }
+
+        // 16.16 fixed-point steps from destination to rotated source coordinates
+        uint32_t stepU = (static_cast<uint32_t>(rw) << 16) / dw;
+        uint32_t stepV = (static_cast<uint32_t>(rh) << 16) / dh;
+
+        size_t written = 0;
+        for (int v = v0; v < v1; ++v) {
+            int rv = static_cast<int>((v * stepV) >> 16);
+            if (flipY) {
+                rv = rh - 1 - rv;
+            }
+
+            uint8_t* out = dst.data + (static_cast<size_t>(dy + v) * dst.width + dx + u0) * dstBpp;
+            uint32_t fu = u0 * stepU;
+            for (int u = u0; u < u1; ++u, fu += stepU, out += dstBpp) {
+                int ru = static_cast<int>(fu >> 16);
+                if (flipX) {
+                    ru = rw - 1 - ru;
+                }
+
+                int x, y;
+                switch (rotation) {
+                case 1: x = rv; y = sh - 1 - ru; break;
+                case 2: x = sw - 1 - ru; y = sh - 1 - rv; break;
+                case 3: x = sw - 1 - rv; y = ru; break;
+                default: x = ru; y = rv; break;
+                }
+
+                const uint8_t* in = src.data + (static_cast<size_t>(sy + y) * src.width + sx + x) * srcBpp;
+                if constexpr (ColorKey) {
+                    if constexpr (SrcBPP != 0) {
+                        if (sameBytes<SrcBPP>(in, key)) {
+                            continue;
+                        }
+                    } else if (std::memcmp(in, key, srcBpp) == 0) {
+                        continue;
+                    }
+                }
+
+                if constexpr (SrcBPP != 0) {
+                    std::memcpy(out, in, SrcBPP);
+                } else {
+                    DisplayColor c{};
+                    DisplayUtils::unpackColor(in, src.format, c);
+                    DisplayUtils::packColor(out, dst.format, c);
+                }
+                written++;
+            }
+        }
+        return written;
+    }
+
+    template<bool ColorKey>
+    static size_t dispatch(const BlitImage& dst, const BlitImage& src, int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh,
+                           const BlitOptions& opts, const uint8_t* key) {
+        int rotation = ((opts.rotation % 4) + 4) % 4;
+        if (src.format != dst.format) {
+            return transform<0, ColorKey>(dst, src, sx, sy, sw, sh, dx, dy, dw, dh, rotation, opts.flipX, opts.flipY, key);
+        }
+
+        switch (packedColorSize(src.format)) {
+        case 1: return transform<1, ColorKey>(dst, src, sx, sy, sw, sh, dx, dy, dw, dh, rotation, opts.flipX, opts.flipY, key);
+        case 2: return transform<2, ColorKey>(dst, src, sx, sy, sw, sh, dx, dy, dw, dh, rotation, opts.flipX, opts.flipY, key);
+        case 3: return transform<3, ColorKey>(dst, src, sx, sy, sw, sh, dx, dy, dw, dh, rotation, opts.flipX, opts.flipY, key);
+        case 4: return transform<4, ColorKey>(dst, src, sx, sy, sw, sh, dx, dy, dw, dh, rotation, opts.flipX, opts.flipY, key);
+        }
+        return 0;
+    }
+
+public:
+    Blitter() = default;
+    Blitter(const Blitter&) = delete;
+    Blitter& operator=(const Blitter&) = delete;
+
+    ~Blitter() {
+#if BLITTER_ASYNC_MEMCPY
+        if (_mcp) {
+            esp_async_memcpy_uninstall(_mcp);
+        }
+        if (_done) {
+            vSemaphoreDelete(_done);
+        }
+#endif
+    }
+
+    /**
+     * @brief Copy a rectangle from src to dst
+     *
+     * Both images must already be validated to hold width * height pixels of their format.
+     * @return Number of destination pixels written
+     */
+    size_t blit(const BlitImage& dst, const BlitImage& src, const BlitOptions& opts) {
+        // Clip the source rectangle to the source image
+        int sx = opts.sx;
+        int sy = opts.sy;
+        int sw = opts.sw < 0 ? src.width : opts.sw;
+        int sh = opts.sh < 0 ? src.height : opts.sh;
+        if (sx < 0) { sw += sx; sx = 0; }
+        if (sy < 0) { sh += sy; sy = 0; }
+        sw = std::min(sw, src.width - sx);
+        sh = std::min(sh, src.height - sy);
+        if (sw <= 0 || sh <= 0) {
+            return 0;
+        }
+
+        bool rotated = (((opts.rotation % 4) + 4) % 4) & 1;
+        int scale = std::max(1, opts.scale);
+        int dw = opts.dw > 0 ? opts.dw : (rotated ? sh : sw) * scale;
+        int dh = opts.dh > 0 ? opts.dh : (rotated ? sw : sh) * scale;
+
+        bool plain = !opts.useColorKey && !opts.flipX && !opts.flipY && opts.rotation % 4 == 0
+                     && src.format == dst.format && dw == sw && dh == sh;
+        if (plain) {
+            return copy(dst, src, sx, sy, sw, sh, opts.dx, opts.dy);
+        }
+
+        // Transformed copies read the source out of order, so a blit within one buffer goes through a copy of the source rectangle
+        std::vector<uint8_t> staging;
+        BlitImage source = src;
+        if (dst.data == src.data) {
+            size_t bpp = packedColorSize(src.format);
+            size_t rowBytes = static_cast<size_t>(sw) * bpp;
+            staging.resize(rowBytes * sh);
+            copyRows(staging.data(), rowBytes, src.data + (static_cast<size_t>(sy) * src.width + sx) * bpp,
+                     static_cast<size_t>(src.width) * bpp, rowBytes, sh);
+            source = { staging.data(), sw, sh, src.format };
+            sx = 0;
+            sy = 0;
+        }
+
+        if (opts.useColorKey) {
+            uint8_t key[4] = {};
+            DisplayUtils::packColor(key, src.format, opts.colorKey);
+            return dispatch<true>(dst, source, sx, sy, sw, sh, opts.dx, opts.dy, dw, dh, opts, key);
+        }
+        return dispatch<false>(dst, source, sx, sy, sw, sh, opts.dx, opts.dy, dw, dh, opts, nullptr);
+    }
+
+    /**
+     * @brief Same-format copy without transformation, clipped to the destination
+     */
+    size_t copy(const BlitImage& dst, const BlitImage& src, int sx, int sy, int w, int h, int dx, int dy) {
+        if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+        if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+        w = std::min(w, dst.width - dx);
+        h = std::min(h, dst.height - dy);
+        if (w <= 0 || h <= 0) {
+            return 0;
+        }
+
+        size_t bpp = packedColorSize(src.format);
+        size_t rowBytes = static_cast<size_t>(w) * bpp;
+        size_t srcStride = static_cast<size_t>(src.width) * bpp;
+        size_t dstStride = static_cast<size_t>(dst.width) * bpp;
+        uint8_t* out = dst.data + (static_cast<size_t>(dy) * dst.width + dx) * bpp;
+        const uint8_t* in = src.data + (static_cast<size_t>(sy) * src.width + sx) * bpp;
+
+#if BLITTER_ASYNC_MEMCPY
+        // Overlapping copies within one buffer must stay on memmove
+        bool sameBuffer = dst.data == src.data;
+        if (!sameBuffer && rowBytes * h >= ASYNC_THRESHOLD && copyRowsAsync(out, dstStride, in, srcStride, rowBytes, h)) {
+            return static_cast<size_t>(w) * h;
+        }
+#endif
+        copyRows(out, dstStride, in, srcStride, rowBytes, h);
+        return static_cast<size_t>(w) * h;
+    }
+};
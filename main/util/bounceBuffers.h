@@ -0,0 +1,118 @@
+#pragma once
+#include "frameDelta.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Split of a framebuffer window into transfers of at most one bounce buffer.
+ *
+ * A window is written to the panel as one continuous memory write in row-major
+ * order, so a transfer may end on any pixel. When a row fits into the buffer,
+ * transfers carry whole rows only and every gather is a plain strided copy.
+ */
+class BouncePlan {
+  public:
+    struct Chunk {
+        int x; // first pixel, in frame coordinates
+        int y;
+        size_t pixels;
+    };
+
+  private:
+    FrameRegion _window;
+    size_t _chunkPixels;
+    size_t _total;
+    size_t _next = 0;
+
+  public:
+    BouncePlan(const FrameRegion &window, size_t pixelSize,
+               size_t bufferBytes)
+        : _window(window),
+          _total(static_cast<size_t>(std::max(window.width, 0)) *
+                 std::max(window.height, 0)) {
+        size_t capacity = std::max<size_t>(bufferBytes / pixelSize, 1);
+        size_t row = std::max(window.width, 1);
+        _chunkPixels = capacity >= row ? capacity / row * row : capacity;
+    }
+
+    size_t chunkPixels() const { return _chunkPixels; }
+
+    size_t chunks() const {
+        return (_total + _chunkPixels - 1) / _chunkPixels;
+    }
+
+    bool next(Chunk &chunk) {
+        if (_next >= _total)
+            return false;
+        chunk.x = _window.x + static_cast<int>(_next % _window.width);
+        chunk.y = _window.y + static_cast<int>(_next / _window.width);
+        chunk.pixels = std::min(_chunkPixels, _total - _next);
+        _next += chunk.pixels;
+        return true;
+    }
+
+    /**
+     * @brief Copy the pixels of a chunk out of the framebuffer
+     * @return Bytes written to dst
+     */
+    size_t gather(const uint8_t *frame, size_t stride, size_t pixelSize,
+                  const Chunk &chunk, uint8_t *dst) const {
+        int x = chunk.x;
+        int y = chunk.y;
+        size_t remaining = chunk.pixels;
+        uint8_t *out = dst;
+        while (remaining > 0) {
+            size_t run = std::min<size_t>(remaining,
+                                          _window.x + _window.width - x);
+            size_t bytes = run * pixelSize;
+            std::memcpy(out, frame + y * stride + x * pixelSize, bytes);
+            out += bytes;
+            remaining -= run;
+            x = _window.x;
+            ++y;
+        }
+        return out - dst;
+    }
+};
+
+/**
+ * Ownership of a ring of bounce buffers shared with a DMA engine.
+ *
+ * Transfers finish in the order they were submitted, so counting completions
+ * is enough to know which buffers are free again. complete() is the only call
+ * made from the interrupt, everything else belongs to the filling task.
+ */
+class BounceRing {
+    size_t _count;
+    uint32_t _submitted = 0;
+    std::atomic<uint32_t> _completed = 0;
+
+  public:
+    explicit BounceRing(size_t count) : _count(count) {}
+
+    size_t count() const { return _count; }
+
+    size_t inFlight() const {
+        return _submitted - _completed.load(std::memory_order_acquire);
+    }
+
+    bool idle() const { return inFlight() == 0; }
+
+    // Buffer to fill next, -1 while every buffer is in flight
+    int acquire() const {
+        return inFlight() < _count ? static_cast<int>(_submitted % _count)
+                                   : -1;
+    }
+
+    void submit() { ++_submitted; }
+
+    void complete() { _completed.fetch_add(1, std::memory_order_release); }
+
+    void reset() {
+        _submitted = 0;
+        _completed.store(0, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,276 @@
+#pragma once
+#include "displayTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace DisplayUtils {
+
+// Brightness and gamma folded into one 8-bit table applied to each channel
+struct ColorLut {
+    uint8_t table[256];
+    bool identity = true;
+
+    ColorLut() { build(255, 1.0f); }
+
+    void build(uint8_t brightness, float gamma) {
+        identity = brightness == 255 && gamma == 1.0f;
+        for (int i = 0; i < 256; ++i) {
+            float v = std::pow(i / 255.0f, gamma) * brightness;
+            table[i] = static_cast<uint8_t>(v + 0.5f);
+        }
+    }
+};
+
+namespace kernels {
+
+// Decoders and encoders mirror unpackColor and packColor, one per format so
+// the per-pixel loop is free of the format switch
+
+struct Mono1 {
+    static constexpr size_t bytes = 1;
+    static DisplayColor decode(const uint8_t *s) {
+        uint8_t v = (s[0] & 0x01) ? 255 : 0;
+        return {v, v, v, 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = (c.r + c.g + c.b) > 381 ? 1 : 0;
+    }
+};
+
+struct Gray4 {
+    static constexpr size_t bytes = 1;
+    static DisplayColor decode(const uint8_t *s) {
+        uint8_t v = s[0] & 0x0F;
+        v |= v << 4;
+        return {v, v, v, 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = ((c.r * 77 + c.g * 150 + c.b * 29) >> 12) & 0x0F;
+    }
+};
+
+struct Gray8 {
+    static constexpr size_t bytes = 1;
+    static DisplayColor decode(const uint8_t *s) {
+        return {s[0], s[0], s[0], 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = (c.r * 77 + c.g * 150 + c.b * 29) >> 8;
+    }
+};
+
+struct Rgb332 {
+    static constexpr size_t bytes = 1;
+    static DisplayColor decode(const uint8_t *s) {
+        return {static_cast<uint8_t>(s[0] & 0xE0),
+                static_cast<uint8_t>((s[0] << 3) & 0xE0),
+                static_cast<uint8_t>((s[0] << 6) & 0xC0), 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = (c.r & 0xE0) | ((c.g >> 3) & 0x1C) | (c.b >> 6);
+    }
+};
+
+template <bool BigEndian> struct Rgb565 {
+    static constexpr size_t bytes = 2;
+    static DisplayColor decode(const uint8_t *s) {
+        uint16_t v = BigEndian ? (s[0] << 8) | s[1] : s[0] | (s[1] << 8);
+        return {static_cast<uint8_t>((v >> 8) & 0xF8),
+                static_cast<uint8_t>((v >> 3) & 0xFC),
+                static_cast<uint8_t>((v << 3) & 0xF8), 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        uint16_t v = ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+        d[BigEndian ? 1 : 0] = v & 0xFF;
+        d[BigEndian ? 0 : 1] = v >> 8;
+    }
+};
+
+struct Rgb888 {
+    static constexpr size_t bytes = 3;
+    static DisplayColor decode(const uint8_t *s) {
+        return {s[0], s[1], s[2], 255};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = c.r;
+        d[1] = c.g;
+        d[2] = c.b;
+    }
+};
+
+struct Rgba8888 {
+    static constexpr size_t bytes = 4;
+    static DisplayColor decode(const uint8_t *s) {
+        return {s[0], s[1], s[2], s[3]};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = c.r;
+        d[1] = c.g;
+        d[2] = c.b;
+        d[3] = c.a;
+    }
+};
+
+struct Xrgb4444 {
+    static constexpr size_t bytes = 2;
+    static DisplayColor decode(const uint8_t *s) {
+        return {static_cast<uint8_t>(((s[1] & 0x0F) << 4) | (s[1] & 0x0F)),
+                static_cast<uint8_t>((s[0] & 0xF0) | (s[0] >> 4)),
+                static_cast<uint8_t>(((s[0] & 0x0F) << 4) | (s[0] & 0x0F)),
+                static_cast<uint8_t>((s[1] & 0xF0) | (s[1] >> 4))};
+    }
+    static void encode(uint8_t *d, DisplayColor c) {
+        d[0] = (c.g & 0xF0) | (c.b >> 4);
+        d[1] = (c.a & 0xF0) | (c.r >> 4);
+    }
+};
+
+template <typename Format, bool UseLut>
+inline void unpack(const uint8_t *src, size_t count, DisplayColor *out,
+                   const uint8_t *lut) {
+    for (size_t i = 0; i < count; ++i, src += Format::bytes) {
+        DisplayColor c = Format::decode(src);
+        if constexpr (UseLut) {
+            c.r = lut[c.r];
+            c.g = lut[c.g];
+            c.b = lut[c.b];
+        }
+        out[i] = c;
+    }
+}
+
+template <typename Format>
+inline void pack(const DisplayColor *src, size_t count, uint8_t *dst) {
+    for (size_t i = 0; i < count; ++i, dst += Format::bytes) {
+        Format::encode(dst, src[i]);
+    }
+}
+
+template <typename Fn> inline bool withFormat(int format, Fn &&fn) {
+    switch (format) {
+    case 3: fn(Mono1{}); return true;
+    case 4: fn(Gray4{}); return true;
+    case 5: fn(Gray8{}); return true;
+    case 6: fn(Rgb332{}); return true;
+    case 7: fn(Rgb565<false>{}); return true;
+    case 8: fn(Rgb565<true>{}); return true;
+    case 9: fn(Rgb888{}); return true;
+    case 10: fn(Rgba8888{}); return true;
+    case 12: fn(Xrgb4444{}); return true;
+    default: return false;
+    }
+}
+
+using UnpackFn = void (*)(const uint8_t *, size_t, DisplayColor *,
+                          const uint8_t *);
+using PackFn = void (*)(const DisplayColor *, size_t, uint8_t *);
+
+// Resolve the kernels of a format once, for loops over many runs
+inline UnpackFn unpacker(int format, bool useLut) {
+    UnpackFn fn = nullptr;
+    withFormat(format, [&](auto fmt) {
+        using Format = decltype(fmt);
+        fn = useLut ? &unpack<Format, true> : &unpack<Format, false>;
+    });
+    return fn;
+}
+
+inline PackFn packer(int format) {
+    PackFn fn = nullptr;
+    withFormat(format, [&](auto fmt) { fn = &pack<decltype(fmt)>; });
+    return fn;
+}
+
+} // namespace kernels
+
+/**
+ * @brief Decode a run of pixels, applying the LUT if given
+ * @return false for an unknown format
+ */
+inline bool unpackRun(const uint8_t *src, size_t count, int format,
+                      DisplayColor *out, const ColorLut *lut = nullptr) {
+    return kernels::withFormat(format, [&](auto fmt) {
+        using Format = decltype(fmt);
+        if (lut && !lut->identity)
+            kernels::unpack<Format, true>(src, count, out, lut->table);
+        else
+            kernels::unpack<Format, false>(src, count, out, nullptr);
+    });
+}
+
+/**
+ * @brief Encode a run of pixels
+ * @return false for an unknown format
+ */
+inline bool packRun(const DisplayColor *src, size_t count, int format,
+                    uint8_t *dst) {
+    return kernels::withFormat(format, [&](auto fmt) {
+        kernels::pack<decltype(fmt)>(src, count, dst);
+    });
+}
+
+/**
+ * @brief Convert a tightly packed frame into the display's native layout
+ *
+ * Matching formats without a color transform are copied row by row, others
+ * are decoded and encoded in chunks through a small stack buffer by kernels
+ * picked once per frame.
+ * Missing trailing pixels are left untouched.
+ *
+ * @return false for an unknown format
+ */
+inline bool convertFrame(const uint8_t *src, size_t size, int format,
+                         const DisplayLayout &layout, uint8_t *dst,
+                         const ColorLut *lut = nullptr) {
+    size_t srcPixel = packedColorSize(format);
+    size_t dstPixel = packedColorSize(layout.format);
+    if (srcPixel == 0 || dstPixel == 0 || layout.width <= 0)
+        return false;
+
+    size_t srcStride = srcPixel * layout.width;
+    size_t rows = std::min<size_t>(size / srcStride, layout.height);
+    size_t tail = (size - rows * srcStride) / srcPixel;
+
+    if (format == layout.format && (!lut || lut->identity)) {
+        if (srcStride == layout.stride) {
+            std::memcpy(dst, src, rows * srcStride);
+        } else {
+            for (size_t y = 0; y < rows; ++y)
+                std::memcpy(dst + y * layout.stride, src + y * srcStride,
+                            srcStride);
+        }
+        if (rows < static_cast<size_t>(layout.height))
+            std::memcpy(dst + rows * layout.stride, src + rows * srcStride,
+                        tail * srcPixel);
+        return true;
+    }
+
+    bool useLut = lut && !lut->identity;
+    kernels::UnpackFn unpack = kernels::unpacker(format, useLut);
+    kernels::PackFn pack = kernels::packer(layout.format);
+    const uint8_t *table = useLut ? lut->table : nullptr;
+
+    constexpr size_t CHUNK = 64;
+    DisplayColor chunk[CHUNK];
+    auto convertRun = [&](const uint8_t *s, uint8_t *d, size_t count) {
+        while (count > 0) {
+            size_t n = std::min(count, CHUNK);
+            unpack(s, n, chunk, table);
+            pack(chunk, n, d);
+            s += n * srcPixel;
+            d += n * dstPixel;
+            count -= n;
+        }
+    };
+
+    for (size_t y = 0; y < rows; ++y)
+        convertRun(src + y * srcStride, dst + y * layout.stride, layout.width);
+    if (rows < static_cast<size_t>(layout.height))
+        convertRun(src + rows * srcStride, dst + rows * layout.stride, tail);
+    return true;
+}
+
+} // namespace DisplayUtils
@@ -37,6 +37,43 @@ bool operator!=(const DisplayPixel &lhs, const DisplayPixel &rhs);
 
 using DisplayPixels = std::vector<DisplayPixel>;
 
+// Native framebuffer of a display, stride is in bytes per row
+struct DisplayLayout {
+    int width;
+    int height;
+    int format;
+    size_t stride;
+};
+
+// Layout of packed sparse pixel records, colors are 0xRRGGBB
+enum class PixelRecordLayout {
+    Index, // [y * width + x, color]
+    XY,    // [x, y, color]
+};
+
+// Bytes per pixel of a packed format, 0 for unknown formats
+// Reference:
+// https://419.ecma-international.org/3.0/index.html#-15-display-class-pattern-pixel-format-values
+inline size_t packedColorSize(int format) {
+    switch (format) {
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+        return 1;
+    case 7:
+    case 8:
+    case 12:
+        return 2;
+    case 9:
+        return 3;
+    case 10:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
 namespace DisplayUtils {
 inline size_t unpackColor(const uint8_t *src, int format, DisplayColor &out) {
     switch (format) {
@@ -112,4 +149,88 @@ inline size_t unpackColor(const uint8_t *src, int format, DisplayColor &out) {
         return 0;
     }
 }
+
+inline size_t packColor(uint8_t *dst, int format, const DisplayColor &c) {
+    switch (format) {
+    case 3:
+        dst[0] = (c.r + c.g + c.b) > 381 ? 1 : 0;
+        return 1;
+    case 4:
+        dst[0] = ((c.r * 77 + c.g * 150 + c.b * 29) >> 12) & 0x0F;
+        return 1;
+    case 5:
+        dst[0] = (c.r * 77 + c.g * 150 + c.b * 29) >> 8;
+        return 1;
+    case 6:
+        dst[0] = (c.r & 0xE0) | ((c.g >> 3) & 0x1C) | (c.b >> 6);
+        return 1;
+    case 7: {
+        uint16_t val = ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+        dst[0] = val & 0xFF;
+        dst[1] = val >> 8;
+        return 2;
+    }
+    case 8: {
+        uint16_t val = ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+        dst[0] = val >> 8;
+        dst[1] = val & 0xFF;
+        return 2;
+    }
+    case 9:
+        dst[0] = c.r;
+        dst[1] = c.g;
+        dst[2] = c.b;
+        return 3;
+    case 10:
+        dst[0] = c.r;
+        dst[1] = c.g;
+        dst[2] = c.b;
+        dst[3] = c.a;
+        return 4;
+    case 12:
+        dst[0] = (c.g & 0xF0) | (c.b >> 4);
+        dst[1] = (c.a & 0xF0) | (c.r >> 4);
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+inline size_t recordWords(PixelRecordLayout layout) {
+    return layout == PixelRecordLayout::XY ? 3 : 2;
+}
+
+// Visit packed pixel records in place as fn(x, y, color), skipping records
+// outside of width x height
+template <typename Fn>
+inline void forEachPackedPixel(const uint32_t *records, size_t count,
+                               PixelRecordLayout layout, int width, int height,
+                               Fn fn) {
+    if (width <= 0 || height <= 0)
+        return;
+    const uint32_t pixelCount = static_cast<uint32_t>(width) * height;
+    const size_t stride = recordWords(layout);
+
+    for (size_t i = 0; i < count; ++i, records += stride) {
+        uint32_t x, y, rgb;
+        if (layout == PixelRecordLayout::Index) {
+            if (records[0] >= pixelCount)
+                continue;
+            x = records[0] % width;
+            y = records[0] / width;
+            rgb = records[1];
+        } else {
+            x = records[0];
+            y = records[1];
+            if (x >= static_cast<uint32_t>(width) ||
+                y >= static_cast<uint32_t>(height))
+                continue;
+            rgb = records[2];
+        }
+        fn(static_cast<int>(x), static_cast<int>(y),
+           DisplayColor{static_cast<uint8_t>(rgb >> 16),
+                        static_cast<uint8_t>(rgb >> 8),
+                        static_cast<uint8_t>(rgb), 255});
+    }
+}
 } // namespace DisplayUtils
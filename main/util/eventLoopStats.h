@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Set to 0 to compile the event loop instrumentation out entirely
+#ifndef EVENT_STATS_ENABLED
+#define EVENT_STATS_ENABLED 1
+#endif
+
+
+/**
+ * Histogram of microsecond durations with power of two buckets. Bucket 0
+ * counts values below 1 us, bucket i values in [2^(i-1), 2^i) and the last
+ * bucket everything longer.
+ */
+template<size_t Buckets = 16>
+class DurationHistogram {
+    std::array<uint32_t, Buckets> _buckets{};
+    uint32_t _max = 0;
+
+public:
+    static constexpr size_t BUCKETS = Buckets;
+
+    static size_t bucket(uint32_t us) {
+        return std::min<size_t>(std::bit_width(us), Buckets - 1);
+    }
+
+    void record(uint32_t us) {
+        _buckets[bucket(us)]++;
+        _max = std::max(_max, us);
+    }
+
+    uint32_t max() const {
+        return _max;
+    }
+
+    const std::array<uint32_t, Buckets>& buckets() const {
+        return _buckets;
+    }
+
+    void reset() {
+        _buckets.fill(0);
+        _max = 0;
+    }
+};
+
+
+/**
+ * Queue depth, wait and run time statistics of an event loop with Lanes
+ * priority lanes and up to Sources event sources, plus the Slow longest
+ * callbacks since the last reset.
+ *
+ * Only observeDepth() may be called from other tasks or interrupts, the rest
+ * belongs to the task running the loop.
+ *
+ * Snapshot layout (uint32 entries):
+ *   [0]                                events run since reset
+ *   [1 + LANE_FIELDS * lane + 0..3]    events run, high-water mark, max wait
+ *                                      and max run microseconds of the lane
+ *   [... + 4 + bucket]                 wait time histogram of the lane
+ *   [... + 4 + BUCKETS + bucket]       run time histogram of the lane
+ *   [SOURCE_OFFSET + SOURCE_FIELDS * source + 0..2]
+ *                                      events run, max wait and max run
+ *                                      microseconds of the source
+ *   [... + 3 + bucket]                 wait time histogram of the source
+ *   [... + 3 + BUCKETS + bucket]       run time histogram of the source
+ *   [SLOW_OFFSET + SLOW_FIELDS * i]    run microseconds, lane, start
+ *                                      milliseconds and code address of the
+ *                                      i-th slowest callback, longest first
+ */
+template<size_t Lanes, size_t Sources = 8, size_t Slow = 8>
+class EventLoopStats {
+public:
+    static constexpr bool enabled = EVENT_STATS_ENABLED;
+    using Histogram = DurationHistogram<16>;
+    static constexpr size_t BUCKETS = Histogram::BUCKETS;
+    static constexpr size_t LANE_FIELDS = 4 + 2 * BUCKETS;
+    static constexpr size_t SOURCES = Sources;
+    static constexpr size_t SOURCE_FIELDS = 3 + 2 * BUCKETS;
+    static constexpr size_t SOURCE_OFFSET = 1 + Lanes * LANE_FIELDS;
+    static constexpr size_t SLOW_FIELDS = 4;
+    static constexpr size_t SLOW_OFFSET = SOURCE_OFFSET + Sources * SOURCE_FIELDS;
+    static constexpr size_t SIZE = SLOW_OFFSET + Slow * SLOW_FIELDS;
+
+    struct SlowCallback {
+        uint32_t runUs;
+        uint32_t lane;
+        uint32_t startMs;
+        uint32_t target;
+    };
+
+private:
+    struct Lane {
+        uint32_t events = 0;
+        std::atomic<uint32_t> highWater = 0;
+        Histogram wait;
+        Histogram run;
+    };
+
+    struct Source {
+        uint32_t events = 0;
+        Histogram wait;
+        Histogram run;
+    };
+
+    std::array<Lane, Lanes> _lanes;
+    std::array<Source, Sources> _sources;
+    std::array<SlowCallback, Slow> _slow{};
+    size_t _slowCount = 0;
+    uint32_t _events = 0;
+
+    static uint32_t clampUs(int64_t us) {
+        return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, UINT32_MAX));
+    }
+
+public:
+    /**
+     * @brief Note the number of events waiting in a lane right after a push
+     */
+    void observeDepth(size_t lane, size_t depth) {
+        if constexpr (enabled) {
+            auto& mark = _lanes[lane].highWater;
+            uint32_t value = static_cast<uint32_t>(depth);
+            uint32_t current = mark.load(std::memory_order_relaxed);
+            while (value > current && !mark.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+    }
+
+    /**
+     * @brief Record the time an event spent queued before it started
+     * @param source Source of the event, sources past Sources are not
+     *               recorded separately
+     */
+    void waited(size_t lane, int64_t us, size_t source = SIZE_MAX) {
+        if constexpr (enabled) {
+            uint32_t waitUs = clampUs(us);
+            _lanes[lane].wait.record(waitUs);
+            if (source < Sources) {
+                _sources[source].wait.record(waitUs);
+            }
+        }
+    }
+
+    /**
+     * @brief Record the run time of a callback
+     * @param startUs Time the callback started at
+     * @param target Address identifying the callback
+     * @param source Source of the event, see waited()
+     */
+    void ran(size_t lane, int64_t us, int64_t startUs, uintptr_t target, size_t source = SIZE_MAX) {
+        if constexpr (enabled) {
+            uint32_t runUs = clampUs(us);
+            _events++;
+            _lanes[lane].events++;
+            _lanes[lane].run.record(runUs);
+            if (source < Sources) {
+                _sources[source].events++;
+                _sources[source].run.record(runUs);
+            }
+
+            if (_slowCount == Slow && runUs <= _slow[Slow - 1].runUs) {
+                return;
+            }
+            size_t i = _slowCount < Slow ? _slowCount++ : Slow - 1;
+            for (; i > 0 && _slow[i - 1].runUs < runUs; --i) {
+                _slow[i] = _slow[i - 1];
+            }
+            _slow[i] = { runUs, static_cast<uint32_t>(lane), static_cast<uint32_t>(startUs / 1000), static_cast<uint32_t>(target) };
+        }
+    }
+
+    void reset() {
+        for (auto& lane : _lanes) {
+            lane.events = 0;
+            lane.highWater = 0;
+            lane.wait.reset();
+            lane.run.reset();
+        }
+        for (auto& source : _sources) {
+            source.events = 0;
+            source.wait.reset();
+            source.run.reset();
+        }
+        _slowCount = 0;
+        _events = 0;
+    }
+
+    /**
+     * @brief Write the statistics to out, which must hold SIZE entries
+     */
+    void snapshot(uint32_t* out) const {
+        std::fill(out, out + SIZE, 0);
+        if constexpr (!enabled) {
+            return;
+        }
+
+        out[0] = _events;
+        for (size_t i = 0; i < Lanes; ++i) {
+            const Lane& lane = _lanes[i];
+            uint32_t* fields = out + 1 + i * LANE_FIELDS;
+            fields[0] = lane.events;
+            fields[1] = lane.highWater.load(std::memory_order_relaxed);
+            fields[2] = lane.wait.max();
+            fields[3] = lane.run.max();
+            std::copy(lane.wait.buckets().begin(), lane.wait.buckets().end(), fields + 4);
+            std::copy(lane.run.buckets().begin(), lane.run.buckets().end(), fields + 4 + BUCKETS);
+        }
+        for (size_t i = 0; i < Sources; ++i) {
+            const Source& source = _sources[i];
+            uint32_t* fields = out + SOURCE_OFFSET + i * SOURCE_FIELDS;
+            fields[0] = source.events;
+            fields[1] = source.wait.max();
+            fields[2] = source.run.max();
+            std::copy(source.wait.buckets().begin(), source.wait.buckets().end(), fields + 3);
+            std::copy(source.run.buckets().begin(), source.run.buckets().end(), fields + 3 + BUCKETS);
+        }
+        for (size_t i = 0; i < _slowCount; ++i) {
+            uint32_t* fields = out + SLOW_OFFSET + i * SLOW_FIELDS;
+            fields[0] = _slow[i].runUs;
+            fields[1] = _slow[i].lane;
+            fields[2] = _slow[i].startMs;
+            fields[3] = _slow[i].target;
+        }
+    }
+};
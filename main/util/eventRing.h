@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * Bounded lock-free multi-producer ring with all slots allocated up front.
+ *
+ * Each slot carries a sequence number telling whether it is free for the
+ * producer of a given lap or filled for its consumer, so pushes and pops
+ * only contend on a compare-and-swap of the position. A producer never waits
+ * for another one to finish, which keeps pushes safe from interrupts as long
+ * as T can be constructed there.
+ */
+template <typename T> class EventRing {
+    struct Slot {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *value() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask;
+    std::atomic<size_t> _head = 0; // next pop
+    std::atomic<size_t> _tail = 0; // next push
+
+    static size_t roundUp(size_t value) {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+  public:
+    // Capacity is rounded up to a power of two
+    explicit EventRing(size_t capacity)
+        : _slots(new Slot[roundUp(capacity)]), _mask(roundUp(capacity) - 1) {
+        for (size_t i = 0; i <= _mask; ++i)
+            _slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    EventRing(const EventRing &) = delete;
+    EventRing &operator=(const EventRing &) = delete;
+
+    ~EventRing() {
+        T value;
+        while (tryPop(value)) {
+        }
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+    // Exact only while no push or pop is in progress
+    size_t size() const {
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t head = _head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Construct an element in place
+     * @return false if the ring is full, nothing is constructed then
+     */
+    template <typename... Args> bool tryEmplace(Args &&...args) {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &_slots[pos & _mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) T(std::forward<Args>(args)...);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(T &&value) { return tryEmplace(std::move(value)); }
+
+    /**
+     * @brief Move the oldest element out
+     * @return false if the ring is empty or its oldest element is still
+     *         being written
+     */
+    bool tryPop(T &out) {
+        size_t pos = _head.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &_slots[pos & _mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+        T *value = slot->value();
+        out = std::move(*value);
+        value->~T();
+        slot->seq.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+};
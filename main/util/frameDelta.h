@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Changed rectangle of a frame in pixels
+struct FrameRegion {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * Shadow of the last presented frame for delta uploads.
+ *
+ * Rows are compared a word at a time, consecutive changed rows are merged into
+ * one region spanning the union of their changed columns.
+ */
+class FrameDelta {
+    std::vector<uint8_t> _shadow;
+    std::vector<FrameRegion> _regions;
+    int _width = 0;
+    int _height = 0;
+    int _format = -1;
+    bool _enabled = false;
+    bool _valid = false;
+
+    // Changed byte range of a row, returns false if the row is equal
+    static bool rowExtent(const uint8_t *a, const uint8_t *b, size_t bytes,
+                          size_t &first, size_t &last) {
+        size_t words = bytes / 4;
+        size_t i = 0;
+        for (; i < words; ++i) {
+            uint32_t wa, wb;
+            std::memcpy(&wa, a + i * 4, 4);
+            std::memcpy(&wb, b + i * 4, 4);
+            if (wa != wb)
+                break;
+        }
+        first = i * 4;
+        while (first < bytes && a[first] == b[first])
+            ++first;
+        if (first == bytes)
+            return false;
+
+        size_t j = bytes;
+        size_t tail = bytes - words * 4;
+        while (tail > 0 && a[j - 1] == b[j - 1]) {
+            --j;
+            --tail;
+        }
+        if (tail == 0) {
+            while (j >= 4) {
+                uint32_t wa, wb;
+                std::memcpy(&wa, a + j - 4, 4);
+                std::memcpy(&wb, b + j - 4, 4);
+                if (wa != wb)
+                    break;
+                j -= 4;
+            }
+            while (a[j - 1] == b[j - 1])
+                --j;
+        }
+        last = j - 1;
+        return true;
+    }
+
+  public:
+    // Fraction of changed pixels above which a full frame is sent instead
+    float fullFrameThreshold = 0.5f;
+    // Unchanged rows bridged when merging, fewer and taller regions
+    int mergeGap = 1;
+
+    bool enabled() const { return _enabled; }
+
+    void setEnabled(bool enabled) {
+        _enabled = enabled;
+        reset();
+        if (!enabled) {
+            std::vector<uint8_t>().swap(_shadow);
+            std::vector<FrameRegion>().swap(_regions);
+        }
+    }
+
+    // Changed regions found by the last diff that returned false
+    const std::vector<FrameRegion> &regions() const { return _regions; }
+
+    // Forget the shadow, the next frame is sent whole
+    void reset() { _valid = false; }
+
+    /**
+     * @brief Diff a tightly packed frame against the shadow and update it
+     * @return true if the whole frame has to be sent, otherwise the changed
+     *         regions are in regions()
+     */
+    bool diff(const uint8_t *frame, int width, int height, int format,
+              size_t pixelSize) {
+        size_t stride = pixelSize * width;
+        size_t bytes = stride * height;
+
+        if (!_valid || width != _width || height != _height ||
+            format != _format) {
+            _width = width;
+            _height = height;
+            _format = format;
+            _shadow.assign(frame, frame + bytes);
+            _valid = true;
+            return true;
+        }
+
+        _regions.clear();
+        size_t changed = 0;
+        int start = -1;
+        int gap = 0;
+        size_t minX = 0, maxX = 0;
+
+        auto flush = [&](int endRow) {
+            int x = minX / pixelSize;
+            int w = maxX / pixelSize - x + 1;
+            _regions.push_back({x, start, w, endRow - start});
+            changed += static_cast<size_t>(w) * (endRow - start);
+            start = -1;
+        };
+
+        for (int y = 0; y < height; ++y) {
+            size_t first, last;
+            const uint8_t *row = frame + y * stride;
+            if (!rowExtent(row, _shadow.data() + y * stride, stride, first,
+                           last)) {
+                if (start >= 0 && ++gap > mergeGap)
+                    flush(y - gap + 1);
+                continue;
+            }
+            if (start < 0) {
+                start = y;
+                minX = first;
+                maxX = last;
+            } else {
+                minX = std::min(minX, first);
+                maxX = std::max(maxX, last);
+            }
+            gap = 0;
+        }
+        if (start >= 0)
+            flush(height - gap);
+
+        size_t total = static_cast<size_t>(width) * height;
+        bool full = changed > total * fullFrameThreshold;
+        if (full) {
+            std::memcpy(_shadow.data(), frame, bytes);
+            return true;
+        }
+
+        for (const FrameRegion &r : _regions) {
+            for (int y = r.y; y < r.y + r.height; ++y) {
+                size_t offset = y * stride + r.x * pixelSize;
+                std::memcpy(_shadow.data() + offset, frame + offset,
+                            r.width * pixelSize);
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,267 @@
+#pragma once
+#include "displayConvert.h"
+#include "frameDelta.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct Hub75Config {
+    int width = 64;  // of one panel
+    int height = 32; // of one panel
+    int chain = 1;
+    int depth = 8;       // bit planes per channel
+    int transition = -1; // first repeated plane, -1 picks depth - 4
+    float gamma = 2.2f;
+    // Unused bus lines that carry a copy of output enable
+    uint16_t oeMirror = 0;
+};
+
+/**
+ * Encoder of frames into the HUB75 parallel output stream.
+ *
+ * Every output word drives the 16-bit bus for one clock: both color pairs, the
+ * row address, latch and output enable. The stream holds all bit planes of all
+ * scan rows, so refreshing the panel is a single looped DMA of stream().
+ *
+ * Binary coded modulation: plane b of a row is shifted out once and shown for
+ * a time proportional to 2^b. Planes from `transition` upwards are repeated
+ * 2^(b - transition) times, lower planes are shown once with a shortened output
+ * enable window instead. Brightness scales the window of every plane, gamma is
+ * applied through a table from 8-bit channels to plane bits. The 8-bit frame is
+ * kept so a gamma change re-encodes what is shown.
+ *
+ * Panels of a chain are placed left to right in the source frame. Only standard
+ * C++ is used so the encoder builds and can be benchmarked on the host, the
+ * allocator lets the device place the stream in DMA capable memory.
+ */
+template <typename Allocator = std::allocator<uint16_t>>
+class BasicHub75Encoder {
+  public:
+    static constexpr uint16_t BIT_R1 = 1 << 0;
+    static constexpr uint16_t BIT_G1 = 1 << 1;
+    static constexpr uint16_t BIT_B1 = 1 << 2;
+    static constexpr uint16_t BIT_R2 = 1 << 3;
+    static constexpr uint16_t BIT_G2 = 1 << 4;
+    static constexpr uint16_t BIT_B2 = 1 << 5;
+    static constexpr int ADDR_SHIFT = 8; // A..E on bits 8..12
+    static constexpr uint16_t BIT_LAT = 1 << 13;
+    static constexpr uint16_t BIT_OE = 1 << 14; // active low, set blanks
+    static constexpr uint16_t COLOR_MASK = 0x3F;
+
+    static constexpr int MAX_DEPTH = 12;
+
+    using Config = Hub75Config;
+
+  private:
+    struct Copy {
+        int row;
+        int plane;
+    };
+
+    Config _config;
+    int _totalWidth;
+    int _scanRows;
+    uint8_t _brightness = 255;
+
+    std::vector<uint16_t, Allocator> _stream;
+    std::vector<Copy> _schedule;
+    size_t _rowWords = 0;
+    size_t _planeOffset[MAX_DEPTH];
+    int _repeats[MAX_DEPTH];
+
+    uint16_t _lut[256];
+    std::vector<DisplayColor> _frame;
+    std::vector<DisplayColor> _rowColors;
+
+    int outputWindow(int plane) const {
+        int window = _totalWidth * _brightness / 255;
+        if (plane < _config.transition)
+            window >>= _config.transition - plane;
+        // Keep the latch clock blanked
+        return std::min(window, _totalWidth - 1);
+    }
+
+    // Encode columns [begin, end) of row y from the retained frame
+    void writeRun(int begin, int y, int end) {
+        bool lower = y >= _scanRows;
+        uint16_t *row = _stream.data() + (y % _scanRows) * _rowWords;
+        uint16_t mask = lower ? BIT_R2 | BIT_G2 | BIT_B2 : BIT_R1 | BIT_G1 | BIT_B1;
+        uint16_t rBit = lower ? BIT_R2 : BIT_R1;
+        uint16_t gBit = lower ? BIT_G2 : BIT_G1;
+        uint16_t bBit = lower ? BIT_B2 : BIT_B1;
+
+        const DisplayColor *colors = _frame.data() + y * _totalWidth;
+        for (int x = begin; x < end; ++x) {
+            const DisplayColor &c = colors[x];
+            writePlaneBits(row, x, mask, _lut[c.r], _lut[c.g], _lut[c.b], rBit,
+                           gBit, bBit);
+        }
+    }
+
+    void writePlaneBits(uint16_t *row, int x, uint16_t mask, uint16_t r,
+                        uint16_t g, uint16_t b, uint16_t rBit, uint16_t gBit,
+                        uint16_t bBit) {
+        for (int plane = 0; plane < _config.depth; ++plane) {
+            uint16_t bits = (((r >> plane) & 1) ? rBit : 0) |
+                            (((g >> plane) & 1) ? gBit : 0) |
+                            (((b >> plane) & 1) ? bBit : 0);
+            uint16_t *word = row + _planeOffset[plane] + x;
+            for (int rep = 0; rep < _repeats[plane]; ++rep) {
+                *word = (*word & ~mask) | bits;
+                word += _totalWidth;
+            }
+        }
+    }
+
+  public:
+    explicit BasicHub75Encoder(const Config &config)
+        : _config(config), _totalWidth(config.width * config.chain),
+          _scanRows(config.height / 2),
+          _frame(static_cast<size_t>(_totalWidth) * config.height),
+          _rowColors(_totalWidth) {
+        _config.depth = std::clamp(_config.depth, 1, MAX_DEPTH);
+        if (_config.transition < 0)
+            _config.transition = std::max(0, _config.depth - 4);
+        _config.transition = std::min(_config.transition, _config.depth - 1);
+
+        size_t copies = 0;
+        for (int plane = 0; plane < _config.depth; ++plane) {
+            _repeats[plane] = plane < _config.transition
+                                  ? 1
+                                  : 1 << (plane - _config.transition);
+            _planeOffset[plane] = copies * _totalWidth;
+            copies += _repeats[plane];
+        }
+        _rowWords = copies * _totalWidth;
+        _stream.assign(_rowWords * _scanRows, 0);
+
+        _schedule.reserve(copies * _scanRows);
+        for (int row = 0; row < _scanRows; ++row) {
+            for (int plane = 0; plane < _config.depth; ++plane) {
+                for (int rep = 0; rep < _repeats[plane]; ++rep)
+                    _schedule.push_back({row, plane});
+            }
+        }
+
+        setGamma(_config.gamma);
+        applyControl();
+    }
+
+    int width() const { return _totalWidth; }
+    int height() const { return _config.height; }
+    int depth() const { return _config.depth; }
+
+    const uint16_t *stream() const { return _stream.data(); }
+    size_t streamWords() const { return _stream.size(); }
+    size_t streamBytes() const { return _stream.size() * sizeof(uint16_t); }
+
+    // Plane rows shifted out per frame
+    size_t copiesPerFrame() const { return _schedule.size(); }
+
+    /**
+     * @brief Rebuild the gamma table and re-encode the current frame with it
+     */
+    void setGamma(float gamma) {
+        _config.gamma = gamma;
+        int max = (1 << _config.depth) - 1;
+        for (int i = 0; i < 256; ++i) {
+            float v = std::pow(i / 255.0f, gamma) * max;
+            _lut[i] = static_cast<uint16_t>(v + 0.5f);
+        }
+        for (int y = 0; y < _config.height; ++y)
+            writeRun(0, y, _totalWidth);
+    }
+
+    void setBrightness(uint8_t brightness) {
+        _brightness = brightness;
+        applyControl();
+    }
+
+    /**
+     * @brief Rewrite address, latch and output enable bits of the stream
+     *
+     * A copy shows the plane latched at the end of the previous copy, so its
+     * address and output window follow that plane rather than its own data.
+     */
+    void applyControl() {
+        size_t count = _schedule.size();
+        uint16_t blank = BIT_OE | _config.oeMirror;
+        for (size_t i = 0; i < count; ++i) {
+            const Copy &shown = _schedule[(i + count - 1) % count];
+            uint16_t base = static_cast<uint16_t>(shown.row << ADDR_SHIFT) &
+                            ~_config.oeMirror;
+            int window = outputWindow(shown.plane);
+
+            uint16_t *word = _stream.data() + i * _totalWidth;
+            for (int x = 0; x < _totalWidth; ++x) {
+                uint16_t control = base | (x >= window ? blank : 0);
+                if (x == _totalWidth - 1)
+                    control |= BIT_LAT;
+                word[x] = (word[x] & COLOR_MASK) | control;
+            }
+        }
+    }
+
+    void clear() {
+        for (uint16_t &word : _stream)
+            word &= ~COLOR_MASK;
+        std::fill(_frame.begin(), _frame.end(), DisplayColor{});
+    }
+
+    /**
+     * @brief Encode a run of pixels of one row
+     */
+    void encodeRun(int x, int y, const DisplayColor *colors, int count) {
+        if (y < 0 || y >= _config.height)
+            return;
+        int begin = std::max(x, 0);
+        int end = std::min(x + count, _totalWidth);
+        if (begin >= end)
+            return;
+        std::copy(colors + (begin - x), colors + (end - x),
+                  _frame.begin() + y * _totalWidth + begin);
+        writeRun(begin, y, end);
+    }
+
+    void setPixel(int x, int y, DisplayColor color) {
+        encodeRun(x, y, &color, 1);
+    }
+
+    /**
+     * @brief Encode a tightly packed frame of width() x height() pixels
+     * @return false for an unknown format
+     */
+    bool encode(const uint8_t *data, size_t size, int format) {
+        size_t pixelSize = packedColorSize(format);
+        if (pixelSize == 0)
+            return false;
+        size_t stride = pixelSize * _totalWidth;
+        int rows = std::min<size_t>(size / stride, _config.height);
+        for (int y = 0; y < rows; ++y) {
+            DisplayUtils::unpackRun(data + y * stride, _totalWidth, format,
+                                    _rowColors.data());
+            encodeRun(0, y, _rowColors.data(), _totalWidth);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Encode a region, data points at its top left pixel
+     */
+    bool encodeRegion(const uint8_t *data, size_t stride, int format,
+                      const FrameRegion &region) {
+        int width = std::min(region.width, _totalWidth);
+        for (int y = 0; y < region.height; ++y) {
+            if (!DisplayUtils::unpackRun(data + y * stride, width, format,
+                                         _rowColors.data()))
+                return false;
+            encodeRun(region.x, region.y + y, _rowColors.data(), width);
+        }
+        return true;
+    }
+};
+
+using Hub75Encoder = BasicHub75Encoder<>;
@@ -1,7 +1,9 @@
 #pragma once
 #include "displayTypes.h"
+#include "frameDelta.h"
 #include <cstddef>
 #include <cstdint>
+#include <span>
 
 class IDisplayHolder {
   public:
@@ -12,9 +14,44 @@ class IDisplayHolder {
     virtual void setBrightness(uint8_t brightness) = 0;
     virtual bool isInitialized() const = 0;
 
+    // Framebuffer layout the panel consumes without conversion
+    virtual DisplayLayout nativeLayout() const = 0;
+
+    // Whether a setBuffer call can be copied or DMA'd straight through
+    bool isNative(int format, size_t size) const {
+        DisplayLayout layout = nativeLayout();
+        return format == layout.format &&
+               size >= layout.stride * layout.height &&
+               layout.stride ==
+                   packedColorSize(format) * layout.width;
+    }
+
+    // Implementations pass native buffers through and convert the rest with
+    // DisplayUtils::convertFrame
     virtual void setBuffer(const uint8_t *rawData, size_t size, int format,
                            bool clearPrevious) = 0;
 
+    // Partial update of a region, data points at its top left pixel and
+    // stride is the byte distance between its rows
+    virtual void setRegion(const uint8_t *data, size_t stride, int format,
+                           const FrameRegion &region) = 0;
+
+    // All changed regions of one frame, frame points at its top left pixel.
+    // Panels that can send the regions as one update override this
+    virtual void setRegions(const uint8_t *frame, size_t stride, int format,
+                            std::span<const FrameRegion> regions) {
+        size_t pixelSize = packedColorSize(format);
+        for (const FrameRegion &r : regions)
+            setRegion(frame + r.y * stride + r.x * pixelSize, stride, format,
+                      r);
+    }
+
     virtual void setBufferFromRaw(const std::vector<DisplayPixel> &pixels,
                                   bool clearPrevious) = 0;
+
+    // Sparse update from packed records, see
+    // DisplayUtils::forEachPackedPixel, the records are only valid during
+    // the call
+    virtual void setPixels(const uint32_t *records, size_t count,
+                           PixelRecordLayout layout, bool clearPrevious) = 0;
 };
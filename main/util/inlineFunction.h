@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 32> class InlineFunction;
+
+/**
+ * Move-only callable wrapper with small buffer storage.
+ *
+ * Callables up to Capacity bytes live inside the object, so wrapping a lambda
+ * with a few captures does not allocate. Larger ones fall back to the heap.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+    struct Ops {
+        R (*invoke)(void *, Args &&...);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *);
+        bool trivial; // destroying runs no code
+    };
+
+    template <typename F> struct InlineOps {
+        static R invoke(void *s, Args &&...args) {
+            return (*static_cast<F *>(s))(std::forward<Args>(args)...);
+        }
+        static void move(void *dst, void *src) {
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        }
+        static void destroy(void *s) { static_cast<F *>(s)->~F(); }
+        static constexpr Ops ops = {invoke, move, destroy,
+                                    std::is_trivially_destructible_v<F>};
+    };
+
+    template <typename F> struct HeapOps {
+        static R invoke(void *s, Args &&...args) {
+            return (**static_cast<F **>(s))(std::forward<Args>(args)...);
+        }
+        static void move(void *dst, void *src) {
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+        }
+        static void destroy(void *s) { delete *static_cast<F **>(s); }
+        static constexpr Ops ops = {invoke, move, destroy, false};
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[Capacity];
+    const Ops *_ops = nullptr;
+
+  public:
+    template <typename F>
+    static constexpr bool storedInline =
+        sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+    InlineFunction() = default;
+    InlineFunction(std::nullptr_t) {}
+
+    template <typename F, typename D = std::decay_t<F>,
+              typename = std::enable_if_t<
+                  !std::is_same_v<D, InlineFunction> &&
+                  std::is_invocable_r_v<R, D &, Args...>>>
+    InlineFunction(F &&func) {
+        if constexpr (storedInline<D>) {
+            new (_storage) D(std::forward<F>(func));
+            _ops = &InlineOps<D>::ops;
+        } else {
+            *reinterpret_cast<D **>(_storage) = new D(std::forward<F>(func));
+            _ops = &HeapOps<D>::ops;
+        }
+    }
+
+    InlineFunction(InlineFunction &&other) noexcept : _ops(other._ops) {
+        if (_ops) {
+            _ops->move(_storage, other._storage);
+            other._ops = nullptr;
+        }
+    }
+
+    InlineFunction &operator=(InlineFunction &&other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other._ops) {
+                other._ops->move(_storage, other._storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction &) = delete;
+    InlineFunction &operator=(const InlineFunction &) = delete;
+
+    ~InlineFunction() { reset(); }
+
+    void reset() {
+        if (_ops) {
+            _ops->destroy(_storage);
+            _ops = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+    // Whether reset() frees nothing and runs no destructor
+    bool trivial() const { return !_ops || _ops->trivial; }
+
+    // Address of the code calling the stored callable, differs between types
+    uintptr_t target() const {
+        return _ops ? reinterpret_cast<uintptr_t>(_ops->invoke) : 0;
+    }
+
+    R operator()(Args... args) {
+        return _ops->invoke(_storage, std::forward<Args>(args)...);
+    }
+};
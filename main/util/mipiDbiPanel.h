@@ -0,0 +1,303 @@
+#pragma once
+#include "displayConvert.h"
+#include "frameDelta.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace mipi {
+static constexpr uint8_t SWRESET = 0x01;
+static constexpr uint8_t SLPOUT = 0x11;
+static constexpr uint8_t NORON = 0x13;
+static constexpr uint8_t INVOFF = 0x20;
+static constexpr uint8_t INVON = 0x21;
+static constexpr uint8_t DISPON = 0x29;
+static constexpr uint8_t CASET = 0x2A;
+static constexpr uint8_t RASET = 0x2B;
+static constexpr uint8_t RAMWR = 0x2C;
+static constexpr uint8_t TEON = 0x35;
+static constexpr uint8_t RAMWRC = 0x3C; // continue the last memory write
+static constexpr uint8_t MADCTL = 0x36;
+static constexpr uint8_t COLMOD = 0x3A;
+
+static constexpr uint8_t MADCTL_MY = 0x80;
+static constexpr uint8_t MADCTL_MX = 0x40;
+static constexpr uint8_t MADCTL_MV = 0x20;
+static constexpr uint8_t MADCTL_BGR = 0x08;
+
+// Pixel format of the panel RAM, RGB565 sent high byte first
+static constexpr int PIXEL_FORMAT = 8;
+} // namespace mipi
+
+enum class MipiDbiController { ST7789, ILI9341 };
+
+struct MipiDbiConfig {
+    MipiDbiController controller = MipiDbiController::ST7789;
+    int width = 240; // at rotation 0
+    int height = 320;
+    int rotation = 0;
+    int colOffset = 0;
+    int rowOffset = 0;
+    bool invert = false;
+    bool bgr = false;
+    bool tearingEffect = false; // pulse the TE line at vertical blanking
+};
+
+/**
+ * Command sequencing and windowing of MIPI-DBI (ST7789, ILI9341) panels.
+ *
+ * Bus is anything providing:
+ *   void command(uint8_t cmd, const uint8_t *params, size_t count);
+ *   uint8_t *acquire(size_t &capacity); // free pixel buffer
+ *   void submit(uint8_t *buffer, size_t size); // pixel data, queued
+ *   void waitIdle();
+ *   void delayMs(int ms);
+ * and has to keep commands and pixel data in submission order. The panel has
+ * no framebuffer, regions are converted straight into the bus buffers.
+ */
+template <typename Bus> class MipiDbiPanel {
+    Bus &_bus;
+    MipiDbiConfig _config;
+    int _width;
+    int _height;
+
+    // Last address window, CASET and RASET are skipped when unchanged
+    uint16_t _window[4] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+
+    uint8_t madctl() const {
+        uint8_t value;
+        if (_config.controller == MipiDbiController::ILI9341) {
+            static constexpr uint8_t ROTATIONS[] = {
+                mipi::MADCTL_MX, mipi::MADCTL_MV, mipi::MADCTL_MY,
+                mipi::MADCTL_MX | mipi::MADCTL_MY | mipi::MADCTL_MV};
+            value = ROTATIONS[_config.rotation & 3];
+        } else {
+            static constexpr uint8_t ROTATIONS[] = {
+                0, mipi::MADCTL_MX | mipi::MADCTL_MV,
+                mipi::MADCTL_MX | mipi::MADCTL_MY,
+                mipi::MADCTL_MY | mipi::MADCTL_MV};
+            value = ROTATIONS[_config.rotation & 3];
+        }
+        return _config.bgr ? value | mipi::MADCTL_BGR : value;
+    }
+
+    void send(uint8_t cmd, std::initializer_list<uint8_t> params = {}) {
+        _bus.command(cmd, params.begin(), params.size());
+    }
+
+    void sendRange(uint8_t cmd, uint16_t start, uint16_t end) {
+        const uint8_t params[] = {
+            static_cast<uint8_t>(start >> 8), static_cast<uint8_t>(start),
+            static_cast<uint8_t>(end >> 8), static_cast<uint8_t>(end)};
+        _bus.command(cmd, params, sizeof(params));
+    }
+
+  public:
+    MipiDbiPanel(Bus &bus, const MipiDbiConfig &config)
+        : _bus(bus), _config(config),
+          _width(config.rotation & 1 ? config.height : config.width),
+          _height(config.rotation & 1 ? config.width : config.height) {}
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+
+    // Clip a region to the panel, false if nothing is left
+    bool clip(FrameRegion &region) const {
+        int x1 = std::min(region.x + region.width, _width);
+        int y1 = std::min(region.y + region.height, _height);
+        region.x = std::max(region.x, 0);
+        region.y = std::max(region.y, 0);
+        region.width = x1 - region.x;
+        region.height = y1 - region.y;
+        return region.width > 0 && region.height > 0;
+    }
+
+    void init() {
+        send(mipi::SWRESET);
+        _bus.delayMs(150);
+
+        if (_config.controller == MipiDbiController::ILI9341) {
+            send(0xCF, {0x00, 0xC1, 0x30});
+            send(0xED, {0x64, 0x03, 0x12, 0x81});
+            send(0xE8, {0x85, 0x00, 0x78});
+            send(0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02});
+            send(0xF7, {0x20});
+            send(0xEA, {0x00, 0x00});
+            send(0xC0, {0x23});       // power control 1
+            send(0xC1, {0x10});       // power control 2
+            send(0xC5, {0x3E, 0x28}); // VCOM control 1
+            send(0xC7, {0x86});       // VCOM control 2
+            send(0xB1, {0x00, 0x18}); // frame rate 79 Hz
+            send(0xB6, {0x08, 0x82, 0x27});
+        }
+
+        send(mipi::COLMOD, {0x55});
+        _bus.delayMs(10);
+        send(mipi::MADCTL, {madctl()});
+        send(_config.invert ? mipi::INVON : mipi::INVOFF);
+        if (_config.tearingEffect)
+            send(mipi::TEON, {0x00}); // vertical blanking only
+        send(mipi::SLPOUT);
+        _bus.delayMs(120);
+        send(mipi::NORON);
+        send(mipi::DISPON);
+        _bus.delayMs(20);
+
+        std::fill(std::begin(_window), std::end(_window), 0xFFFF);
+    }
+
+    /**
+     * @brief Set the address window and start a memory write
+     */
+    void setWindow(int x, int y, int width, int height) {
+        uint16_t x0 = x + _config.colOffset;
+        uint16_t x1 = x0 + width - 1;
+        uint16_t y0 = y + _config.rowOffset;
+        uint16_t y1 = y0 + height - 1;
+
+        if (_window[0] != x0 || _window[1] != x1) {
+            sendRange(mipi::CASET, x0, x1);
+            _window[0] = x0;
+            _window[1] = x1;
+        }
+        if (_window[2] != y0 || _window[3] != y1) {
+            sendRange(mipi::RASET, y0, y1);
+            _window[2] = y0;
+            _window[3] = y1;
+        }
+        send(mipi::RAMWR);
+    }
+
+    /**
+     * @brief Write a region, data points at its top left pixel
+     * @return false for an unknown format
+     */
+    bool writeRegion(const uint8_t *data, size_t stride, int format,
+                     FrameRegion region,
+                     const DisplayUtils::ColorLut *lut = nullptr) {
+        size_t srcPixel = packedColorSize(format);
+        if (srcPixel == 0)
+            return false;
+
+        // Clipping moves the top left corner, keep data pointing at it
+        FrameRegion clipped = region;
+        if (!clip(clipped))
+            return true;
+        data += (clipped.y - region.y) * stride +
+                (clipped.x - region.x) * srcPixel;
+
+        setWindow(clipped.x, clipped.y, clipped.width, clipped.height);
+
+        constexpr size_t DST_PIXEL = 2;
+        size_t capacity = 0;
+        uint8_t *buffer = _bus.acquire(capacity);
+        size_t used = 0;
+
+        for (int y = 0; y < clipped.height; ++y) {
+            const uint8_t *row = data + y * stride;
+            int done = 0;
+            while (done < clipped.width) {
+                if (capacity - used < DST_PIXEL) {
+                    _bus.submit(buffer, used);
+                    buffer = _bus.acquire(capacity);
+                    used = 0;
+                }
+                int n = std::min<int>(clipped.width - done,
+                                      (capacity - used) / DST_PIXEL);
+                DisplayLayout run{n, 1, mipi::PIXEL_FORMAT, n * DST_PIXEL};
+                DisplayUtils::convertFrame(row + done * srcPixel, n * srcPixel,
+                                           format, run, buffer + used, lut);
+                used += n * DST_PIXEL;
+                done += n;
+            }
+        }
+        if (used > 0)
+            _bus.submit(buffer, used);
+        return true;
+    }
+
+    /**
+     * @brief Write the changed rectangles of a frame
+     */
+    bool writeRegions(const uint8_t *frame, size_t stride, int format,
+                      std::span<const FrameRegion> regions,
+                      const DisplayUtils::ColorLut *lut = nullptr) {
+        size_t srcPixel = packedColorSize(format);
+        for (const FrameRegion &r : regions) {
+            if (!writeRegion(frame + r.y * stride + r.x * srcPixel, stride,
+                             format, r, lut))
+                return false;
+        }
+        return true;
+    }
+
+    void fill(FrameRegion region, DisplayColor color) {
+        if (!clip(region))
+            return;
+        setWindow(region.x, region.y, region.width, region.height);
+
+        uint8_t pixel[2];
+        DisplayUtils::packColor(pixel, mipi::PIXEL_FORMAT, color);
+        size_t remaining = static_cast<size_t>(region.width) * region.height;
+        while (remaining > 0) {
+            size_t capacity;
+            uint8_t *buffer = _bus.acquire(capacity);
+            size_t n = std::min(remaining, capacity / 2);
+            for (size_t i = 0; i < n; ++i) {
+                buffer[i * 2] = pixel[0];
+                buffer[i * 2 + 1] = pixel[1];
+            }
+            _bus.submit(buffer, n * 2);
+            remaining -= n;
+        }
+    }
+};
+
+/**
+ * Bus recording every operation, for checking command sequences off-device.
+ */
+class MipiDbiRecorder {
+  public:
+    enum class Kind { Command, Data, Delay };
+
+    struct Op {
+        Kind kind;
+        uint8_t cmd;
+        std::vector<uint8_t> bytes;
+        int delayMs;
+    };
+
+    std::vector<Op> ops;
+    size_t bufferSize;
+
+  private:
+    std::vector<std::vector<uint8_t>> _buffers;
+    size_t _next = 0;
+
+  public:
+    explicit MipiDbiRecorder(size_t bufferSize = 4096, size_t buffers = 2)
+        : bufferSize(bufferSize),
+          _buffers(buffers, std::vector<uint8_t>(bufferSize)) {}
+
+    void command(uint8_t cmd, const uint8_t *params, size_t count) {
+        ops.push_back({Kind::Command, cmd, {params, params + count}, 0});
+    }
+
+    uint8_t *acquire(size_t &capacity) {
+        capacity = bufferSize;
+        uint8_t *buffer = _buffers[_next].data();
+        _next = (_next + 1) % _buffers.size();
+        return buffer;
+    }
+
+    void submit(uint8_t *buffer, size_t size) {
+        ops.push_back({Kind::Data, 0, {buffer, buffer + size}, 0});
+    }
+
+    void waitIdle() {}
+
+    void delayMs(int ms) { ops.push_back({Kind::Delay, 0, {}, ms}); }
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+
+/**
+ * Fixed-capacity particle store kept as a struct of arrays.
+ *
+ * Live particles always occupy indices [0, count()), retiring one moves the last
+ * particle into its slot, so every field can be read back as one dense array.
+ */
+class ParticleSystem {
+public:
+    enum class Bounds { None, Wrap, Clamp, Kill };
+
+    enum class Field { X, Y, VX, VY, AX, AY, Life, Size, Color };
+
+    struct Params {
+        float x = 0;
+        float y = 0;
+        float vx = 0;
+        float vy = 0;
+        float ax = 0;
+        float ay = 0;
+        // Seconds to live, zero or less lives until killed
+        float life = 0;
+        uint32_t color = 0xFFFFFF;
+        uint8_t size = 1;
+
+        // Uniform random spread added to the velocity components and life
+        float velocityJitter = 0;
+        float lifeJitter = 0;
+    };
+
+private:
+    size_t m_capacity;
+    size_t m_count = 0;
+
+    std::vector<float> m_x, m_y, m_vx, m_vy, m_ax, m_ay, m_life;
+    std::vector<uint32_t> m_color;
+    std::vector<uint8_t> m_size;
+
+    Bounds m_bounds = Bounds::None;
+    float m_minX = 0, m_minY = 0, m_maxX = 0, m_maxY = 0;
+
+    float m_fixedDt = 1.0f / 60;
+    float m_accumulator = 0;
+    uint32_t m_rng = 0x2545F491;
+
+    // Uniform in [-1, 1)
+    float random() {
+        m_rng ^= m_rng << 13;
+        m_rng ^= m_rng >> 17;
+        m_rng ^= m_rng << 5;
+        return static_cast<float>(m_rng >> 8) / static_cast<float>(1 << 23) - 1.0f;
+    }
+
+    void move(size_t from, size_t to) {
+        m_x[to] = m_x[from];
+        m_y[to] = m_y[from];
+        m_vx[to] = m_vx[from];
+        m_vy[to] = m_vy[from];
+        m_ax[to] = m_ax[from];
+        m_ay[to] = m_ay[from];
+        m_life[to] = m_life[from];
+        m_color[to] = m_color[from];
+        m_size[to] = m_size[from];
+    }
+
+    static float wrap(float v, float lo, float hi) {
+        float span = hi - lo;
+        if (span <= 0)
+            return lo;
+        v = std::fmod(v - lo, span);
+        return (v < 0 ? v + span : v) + lo;
+    }
+
+public:
+    explicit ParticleSystem(size_t capacity):
+        m_capacity(capacity),
+        m_x(capacity), m_y(capacity), m_vx(capacity), m_vy(capacity), m_ax(capacity), m_ay(capacity),
+        m_life(capacity), m_color(capacity), m_size(capacity)
+    {}
+
+    size_t capacity() const { return m_capacity; }
+    size_t count() const { return m_count; }
+
+    /**
+     * @brief Set what happens to particles leaving the rectangle, inverted edges are swapped
+     */
+    void setBounds(Bounds mode, float minX, float minY, float maxX, float maxY) {
+        m_bounds = mode;
+        std::tie(m_minX, m_maxX) = std::minmax(minX, maxX);
+        std::tie(m_minY, m_maxY) = std::minmax(minY, maxY);
+    }
+
+    void setFixedStep(float dt) {
+        if (dt > 0)
+            m_fixedDt = dt;
+    }
+
+    void seed(uint32_t seed) {
+        m_rng = seed != 0 ? seed : 0x2545F491;
+    }
+
+    /**
+     * @brief Add particles
+     * @return Index of the first new particle, or -1 if the store is full
+     */
+    int emit(const Params& p, size_t n = 1) {
+        n = std::min(n, m_capacity - m_count);
+        if (n == 0)
+            return -1;
+
+        size_t first = m_count;
+        for (size_t i = first; i < first + n; ++i) {
+            float life = p.life > 0 ? p.life + p.lifeJitter * random() : std::numeric_limits<float>::infinity();
+            m_x[i] = p.x;
+            m_y[i] = p.y;
+            m_vx[i] = p.vx + p.velocityJitter * random();
+            m_vy[i] = p.vy + p.velocityJitter * random();
+            m_ax[i] = p.ax;
+            m_ay[i] = p.ay;
+            m_life[i] = life;
+            m_color[i] = p.color;
+            m_size[i] = p.size;
+        }
+        m_count += n;
+        return static_cast<int>(first);
+    }
+
+    void kill(size_t index) {
+        if (index >= m_count)
+            return;
+        m_count--;
+        if (index != m_count) {
+            move(m_count, index);
+        }
+    }
+
+    void clear() {
+        m_count = 0;
+        m_accumulator = 0;
+    }
+
+    /**
+     * @brief Integrate one step of dt seconds, then apply bounds and retire expired particles
+     */
+    void step(float dt) {
+        size_t n = m_count;
+
+        // Semi-implicit Euler, each field is a separate tight loop
+        for (size_t i = 0; i < n; ++i) {
+            m_vx[i] += m_ax[i] * dt;
+            m_vy[i] += m_ay[i] * dt;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            m_x[i] += m_vx[i] * dt;
+            m_y[i] += m_vy[i] * dt;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            m_life[i] -= dt;
+        }
+
+        switch (m_bounds) {
+        case Bounds::Wrap:
+            for (size_t i = 0; i < n; ++i) {
+                if (m_x[i] < m_minX || m_x[i] >= m_maxX)
+                    m_x[i] = wrap(m_x[i], m_minX, m_maxX);
+                if (m_y[i] < m_minY || m_y[i] >= m_maxY)
+                    m_y[i] = wrap(m_y[i], m_minY, m_maxY);
+            }
+            break;
+        case Bounds::Clamp:
+            for (size_t i = 0; i < n; ++i) {
+                m_x[i] = std::clamp(m_x[i], m_minX, m_maxX);
+                m_y[i] = std::clamp(m_y[i], m_minY, m_maxY);
+            }
+            break;
+        case Bounds::Kill:
+            for (size_t i = 0; i < n; ++i) {
+                if (m_x[i] < m_minX || m_x[i] >= m_maxX || m_y[i] < m_minY || m_y[i] >= m_maxY)
+                    m_life[i] = 0;
+            }
+            break;
+        case Bounds::None:
+            break;
+        }
+
+        // Walk backwards so a moved-in particle has already been checked
+        for (size_t i = m_count; i-- > 0;) {
+            if (m_life[i] <= 0)
+                kill(i);
+        }
+    }
+
+    /**
+     * @brief Advance by elapsed seconds in fixed steps
+     * @param maxSteps Upper bound of steps, leftover time is dropped to avoid a spiral of death
+     * @return Number of steps taken
+     */
+    int update(float elapsed, int maxSteps = 8) {
+        m_accumulator += elapsed;
+        int steps = 0;
+        while (m_accumulator >= m_fixedDt && steps < maxSteps) {
+            step(m_fixedDt);
+            m_accumulator -= m_fixedDt;
+            steps++;
+        }
+        if (steps == maxSteps) {
+            m_accumulator = 0;
+        }
+        return steps;
+    }
+
+    void setPosition(size_t i, float x, float y) {
+        if (i < m_count) {
+            m_x[i] = x;
+            m_y[i] = y;
+        }
+    }
+
+    void setVelocity(size_t i, float vx, float vy) {
+        if (i < m_count) {
+            m_vx[i] = vx;
+            m_vy[i] = vy;
+        }
+    }
+
+    /**
+     * @brief Copy one field of the live particles as 32-bit values
+     * @return Number of values written
+     */
+    size_t read(Field field, void* out, size_t maxValues) const {
+        size_t n = std::min(m_count, maxValues);
+        auto copyFloats = [&](const std::vector<float>& v) {
+            std::copy_n(v.begin(), n, static_cast<float*>(out));
+        };
+
+        switch (field) {
+        case Field::X: copyFloats(m_x); break;
+        case Field::Y: copyFloats(m_y); break;
+        case Field::VX: copyFloats(m_vx); break;
+        case Field::VY: copyFloats(m_vy); break;
+        case Field::AX: copyFloats(m_ax); break;
+        case Field::AY: copyFloats(m_ay); break;
+        case Field::Life: copyFloats(m_life); break;
+        case Field::Color: std::copy_n(m_color.begin(), n, static_cast<uint32_t*>(out)); break;
+        case Field::Size: std::copy_n(m_size.begin(), n, static_cast<uint32_t*>(out)); break;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Visit live particles as (x, y, color, size) with integer pixel coordinates
+     *
+     * Particles whose position is not finite or does not fit an int are skipped.
+     */
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        // Both limits are exact in float, NaN fails every comparison
+        constexpr float lo = static_cast<float>(std::numeric_limits<int>::min());
+        constexpr float hi = -lo;
+        for (size_t i = 0; i < m_count; ++i) {
+            float x = std::floor(m_x[i]);
+            float y = std::floor(m_y[i]);
+            if (!(x >= lo && x < hi && y >= lo && y < hi))
+                continue;
+            fn(static_cast<int>(x), static_cast<int>(y), m_color[i], m_size[i]);
+        }
+    }
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_timer.h"
+
+// Set to 0 to compile the render instrumentation out entirely
+#ifndef RENDER_STATS_ENABLED
+#define RENDER_STATS_ENABLED 1
+#endif
+
+
+/**
+ * Per-frame stage timers and counters with rolling min/avg/max over the last Window frames.
+ *
+ * Snapshot layout (uint32 entries):
+ *   [0]                        number of frames since reset
+ *   [1 + 4 * stage + 0..3]     last, min, avg and max microseconds of each stage
+ *   [1 + 4 * Stages + counter] value of each counter in the last frame
+ *
+ * Only committed frames are reported, an open frame shows up after endFrame().
+ */
+template<size_t Stages, size_t Counters, size_t Window = 32>
+class RenderStats {
+public:
+    static constexpr bool enabled = RENDER_STATS_ENABLED;
+    static constexpr size_t STAGE_FIELDS = 4;
+    static constexpr size_t SIZE = 1 + Stages * STAGE_FIELDS + Counters;
+
+    class Scope {
+        RenderStats* _stats;
+        size_t _stage;
+        int64_t _start;
+    public:
+        Scope(RenderStats* stats, size_t stage) : _stats(stats), _stage(stage), _start(0) {
+            if constexpr (enabled) {
+                _start = esp_timer_get_time();
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() {
+            if constexpr (enabled) {
+                _stats->_current[_stage] += static_cast<uint32_t>(esp_timer_get_time() - _start);
+            }
+        }
+    };
+
+private:
+    std::array<uint32_t, Stages> _current{};
+    std::array<uint32_t, Counters> _counters{};
+    std::array<std::array<uint32_t, Window>, Stages> _history{};
+    std::array<uint32_t, Stages> _last{};
+    std::array<uint32_t, Counters> _lastCounters{};
+    uint32_t _frames = 0;
+    bool _open = false;
+
+public:
+    /**
+     * @brief Start a new frame, clearing the per-frame timers and counters
+     */
+    void beginFrame() {
+        if constexpr (enabled) {
+            _current.fill(0);
+            _counters.fill(0);
+            _open = true;
+        }
+    }
+
+    /**
+     * @brief Commit the current frame into the rolling window
+     */
+    void endFrame() {
+        if constexpr (enabled) {
+            size_t slot = _frames % Window;
+            for (size_t i = 0; i < Stages; ++i) {
+                _history[i][slot] = _current[i];
+                _last[i] = _current[i];
+            }
+            _lastCounters = _counters;
+            _frames++;
+            _open = false;
+        }
+    }
+
+    bool isOpen() const {
+        return _open;
+    }
+
+    [[nodiscard]] Scope measure(size_t stage) {
+        return Scope(this, stage);
+    }
+
+    void count(size_t counter, uint32_t n = 1) {
+        if constexpr (enabled) {
+            _counters[counter] += n;
+        }
+    }
+
+    void reset() {
+        _current.fill(0);
+        _counters.fill(0);
+        _last.fill(0);
+        _lastCounters.fill(0);
+        _frames = 0;
+        _open = false;
+    }
+
+    /**
+     * @brief Write the statistics to out, which must hold SIZE entries
+     */
+    void snapshot(uint32_t* out) const {
+        std::fill(out, out + SIZE, 0);
+        if constexpr (!enabled) {
+            return;
+        }
+
+        out[0] = _frames;
+        size_t samples = std::min<size_t>(_frames, Window);
+        for (size_t i = 0; i < Stages; ++i) {
+            uint32_t* stage = out + 1 + i * STAGE_FIELDS;
+            stage[0] = _last[i];
+            if (samples == 0) {
+                continue;
+            }
+
+            uint32_t min = UINT32_MAX;
+            uint32_t max = 0;
+            uint64_t sum = 0;
+            for (size_t s = 0; s < samples; ++s) {
+                uint32_t v = _history[i][s];
+                min = std::min(min, v);
+                max = std::max(max, v);
+                sum += v;
+            }
+            stage[1] = min;
+            stage[2] = static_cast<uint32_t>(sum / samples);
+            stage[3] = max;
+        }
+        std::copy(_lastCounters.begin(), _lastCounters.end(), out + 1 + Stages * STAGE_FIELDS);
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <jac/features/types/streams.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Sink for live statistics, bound to a device-link channel in main.cpp.
+ * Each record is a single text line "<source> <v0> <v1> ...".
+ */
+class StatsChannel {
+    static inline std::unique_ptr<jac::Writable> _out;
+
+public:
+    static void bind(std::unique_ptr<jac::Writable> out) {
+        _out = std::move(out);
+    }
+
+    static bool bound() {
+        return _out != nullptr;
+    }
+
+    static void publish(std::string_view source, std::span<const uint32_t> values) {
+        if (!_out) {
+            return;
+        }
+
+        std::string line(source);
+        line.reserve(line.size() + values.size() * 6 + 1);
+        for (auto v : values) {
+            line += ' ';
+            line += std::to_string(v);
+        }
+        line += '\n';
+        _out->write(line);
+    }
+};
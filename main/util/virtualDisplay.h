@@ -0,0 +1,296 @@
+#pragma once
+#include "displayConvert.h"
+#include "iDisplayHolder.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Display without hardware that keeps its framebuffer in memory.
+ *
+ * Every upload is timed per call kind and, for setBuffer, per input format.
+ * Presented frames can be kept in a ring of snapshots or dumped as PPM files.
+ * Only standard C++ is used so it builds on the host as well.
+ */
+class VirtualDisplay : public IDisplayHolder {
+  public:
+    enum class Call { Buffer, Raw, Pixels, Region, COUNT };
+
+    struct CallStats {
+        uint32_t calls = 0;
+        uint64_t pixels = 0;
+        uint64_t totalUs = 0;
+        uint64_t lastUs = 0;
+        uint64_t maxUs = 0;
+
+        double avgUs() const {
+            return calls > 0 ? static_cast<double>(totalUs) / calls : 0.0;
+        }
+    };
+
+    static constexpr int MAX_FORMAT = 16;
+
+  private:
+    DisplayLayout _layout;
+    std::vector<uint8_t> _frame;
+    DisplayUtils::ColorLut _lut;
+    uint8_t _brightness = 255;
+    float _gamma = 1.0f;
+    bool _initialized = false;
+
+    std::array<CallStats, static_cast<size_t>(Call::COUNT)> _calls{};
+    std::array<CallStats, MAX_FORMAT> _formats{};
+    uint32_t _frameCount = 0;
+
+    std::vector<std::vector<uint8_t>> _ring;
+    size_t _ringHead = 0;
+    size_t _ringSize = 0;
+    std::string _dumpPattern;
+
+    class Timer {
+        std::chrono::steady_clock::time_point _start =
+            std::chrono::steady_clock::now();
+
+      public:
+        uint64_t elapsedUs() const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - _start)
+                .count();
+        }
+    };
+
+    static void record(CallStats &stats, uint64_t us, size_t pixels) {
+        stats.calls++;
+        stats.pixels += pixels;
+        stats.totalUs += us;
+        stats.lastUs = us;
+        stats.maxUs = std::max(stats.maxUs, us);
+    }
+
+    uint8_t *pixelAt(int x, int y) {
+        return _frame.data() + y * _layout.stride +
+               x * packedColorSize(_layout.format);
+    }
+
+    void putPixel(int x, int y, DisplayColor color) {
+        if (!_lut.identity) {
+            color.r = _lut.table[color.r];
+            color.g = _lut.table[color.g];
+            color.b = _lut.table[color.b];
+        }
+        DisplayUtils::packColor(pixelAt(x, y), _layout.format, color);
+    }
+
+    void present(Call call, uint64_t us, size_t pixels) {
+        record(_calls[static_cast<size_t>(call)], us, pixels);
+        _frameCount++;
+
+        if (!_ring.empty()) {
+            _ring[_ringHead] = _frame;
+            _ringHead = (_ringHead + 1) % _ring.size();
+            _ringSize = std::min(_ringSize + 1, _ring.size());
+        }
+        if (!_dumpPattern.empty()) {
+            char path[256];
+            std::snprintf(path, sizeof(path), _dumpPattern.c_str(),
+                          static_cast<unsigned>(_frameCount));
+            writePpm(path);
+        }
+    }
+
+  public:
+    VirtualDisplay(int width, int height, int format = 9)
+        : _layout{width, height, format,
+                  packedColorSize(format) * width},
+          _frame(_layout.stride * height) {}
+
+    void start() override { _initialized = true; }
+
+    void clear() override { std::fill(_frame.begin(), _frame.end(), 0); }
+
+    void setBrightness(uint8_t brightness) override {
+        _brightness = brightness;
+        _lut.build(_brightness, _gamma);
+    }
+
+    void setGamma(float gamma) {
+        _gamma = gamma;
+        _lut.build(_brightness, _gamma);
+    }
+
+    bool isInitialized() const override { return _initialized; }
+
+    DisplayLayout nativeLayout() const override { return _layout; }
+
+    void setBuffer(const uint8_t *rawData, size_t size, int format,
+                   bool clearPrevious) override {
+        Timer timer;
+        if (clearPrevious)
+            clear();
+        if (isNative(format, size) && _lut.identity) {
+            std::copy_n(rawData, _frame.size(), _frame.begin());
+        } else {
+            DisplayUtils::convertFrame(rawData, size, format, _layout,
+                                       _frame.data(), &_lut);
+        }
+        uint64_t us = timer.elapsedUs();
+
+        size_t pixelSize = packedColorSize(format);
+        size_t pixels = pixelSize > 0 ? size / pixelSize : 0;
+        if (format >= 0 && format < MAX_FORMAT)
+            record(_formats[format], us, pixels);
+        present(Call::Buffer, us, pixels);
+    }
+
+    void setRegion(const uint8_t *data, size_t stride, int format,
+                   const FrameRegion &region) override {
+        Timer timer;
+        DisplayLayout row{region.width, 1, _layout.format, _layout.stride};
+        size_t rowBytes = packedColorSize(format) * region.width;
+        for (int y = 0; y < region.height; ++y) {
+            DisplayUtils::convertFrame(data + y * stride, rowBytes, format, row,
+                                       pixelAt(region.x, region.y + y), &_lut);
+        }
+        present(Call::Region, timer.elapsedUs(),
+                static_cast<size_t>(region.width) * region.height);
+    }
+
+    void setBufferFromRaw(const std::vector<DisplayPixel> &pixels,
+                          bool clearPrevious) override {
+        Timer timer;
+        if (clearPrevious)
+            clear();
+        for (const DisplayPixel &p : pixels) {
+            if (p.x >= 0 && p.x < _layout.width && p.y >= 0 &&
+                p.y < _layout.height)
+                putPixel(p.x, p.y, p.color);
+        }
+        present(Call::Raw, timer.elapsedUs(), pixels.size());
+    }
+
+    void setPixels(const uint32_t *records, size_t count,
+                   PixelRecordLayout layout, bool clearPrevious) override {
+        Timer timer;
+        if (clearPrevious)
+            clear();
+        DisplayUtils::forEachPackedPixel(
+            records, count, layout, _layout.width, _layout.height,
+            [this](int x, int y, DisplayColor color) {
+                putPixel(x, y, color);
+            });
+        present(Call::Pixels, timer.elapsedUs(), count);
+    }
+
+    // Framebuffer in the native layout
+    const std::vector<uint8_t> &frame() const { return _frame; }
+
+    uint32_t frameCount() const { return _frameCount; }
+
+    // FNV-1a of the framebuffer, for comparing runs
+    uint32_t checksum() const {
+        uint32_t hash = 2166136261u;
+        for (uint8_t b : _frame) {
+            hash = (hash ^ b) * 16777619u;
+        }
+        return hash;
+    }
+
+    const CallStats &stats(Call call) const {
+        return _calls[static_cast<size_t>(call)];
+    }
+
+    const CallStats &formatStats(int format) const {
+        static const CallStats empty{};
+        return format >= 0 && format < MAX_FORMAT ? _formats[format] : empty;
+    }
+
+    void resetStats() {
+        _calls = {};
+        _formats = {};
+    }
+
+    /**
+     * @brief Keep snapshots of the last frames, zero disables capturing
+     */
+    void setCaptureRing(size_t frames) {
+        _ring.assign(frames, std::vector<uint8_t>(_frame.size()));
+        _ringHead = 0;
+        _ringSize = 0;
+    }
+
+    size_t capturedFrames() const { return _ringSize; }
+
+    // Snapshot by age, 0 is the most recent frame
+    const std::vector<uint8_t> &capturedFrame(size_t age) const {
+        size_t index = (_ringHead + _ring.size() - 1 - age) % _ring.size();
+        return _ring[index];
+    }
+
+    /**
+     * @brief Dump every presented frame, the pattern gets the frame number
+     *        as in printf, e.g. "frame_%05u.ppm", empty disables dumping
+     */
+    void setDumpPattern(std::string pattern) {
+        _dumpPattern = std::move(pattern);
+    }
+
+    bool writePpm(const char *path) const {
+        return writePpm(path, _frame.data(), _layout);
+    }
+
+    /**
+     * @brief Write a frame in any supported layout as a binary PPM
+     * @return false if the file could not be written
+     */
+    static bool writePpm(const char *path, const uint8_t *data,
+                         const DisplayLayout &layout) {
+        FILE *file = std::fopen(path, "wb");
+        if (!file)
+            return false;
+
+        std::fprintf(file, "P6\n%d %d\n255\n", layout.width, layout.height);
+        std::vector<DisplayColor> colors(layout.width);
+        std::vector<uint8_t> rgb(layout.width * 3);
+        bool ok = true;
+        for (int y = 0; y < layout.height && ok; ++y) {
+            DisplayUtils::unpackRun(data + y * layout.stride, layout.width,
+                                    layout.format, colors.data());
+            DisplayUtils::packRun(colors.data(), layout.width, 9, rgb.data());
+            ok = std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        }
+        return std::fclose(file) == 0 && ok;
+    }
+
+    /**
+     * @brief Push frames of every supported format through setBuffer
+     *
+     * The timings end up in formatStats, the frames are a moving gradient so
+     * every conversion sees changing data.
+     */
+    void benchmarkFormats(int frames) {
+        static constexpr int FORMATS[] = {3, 4, 5, 6, 7, 8, 9, 10, 12};
+        std::vector<DisplayColor> colors(_layout.width);
+        for (int format : FORMATS) {
+            size_t pixelSize = packedColorSize(format);
+            size_t stride = pixelSize * _layout.width;
+            std::vector<uint8_t> buffer(stride * _layout.height);
+            for (int f = 0; f < frames; ++f) {
+                for (int y = 0; y < _layout.height; ++y) {
+                    for (int x = 0; x < _layout.width; ++x) {
+                        colors[x] = {static_cast<uint8_t>(x * 4 + f),
+                                     static_cast<uint8_t>(y * 4),
+                                     static_cast<uint8_t>(x + y + f), 255};
+                    }
+                    DisplayUtils::packRun(colors.data(), _layout.width, format,
+                                          buffer.data() + y * stride);
+                }
+                setBuffer(buffer.data(), buffer.size(), format, false);
+            }
+        }
+    }
+};
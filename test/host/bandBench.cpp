@@ -0,0 +1,73 @@
+// Speedup of drawing every other band on a BandWorker, with a synthetic per-pixel
+// workload standing in for the rasterizer. Usage:
+//   band_bench [width] [height] [band height] [frames]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bandWorker.h"
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the optimizer from dropping the measured work
+volatile float sink;
+
+double renderFrames(BandWorker* worker, int width, int height, int bandHeight, int frames) {
+    std::vector<float> grids[2];
+    for (auto& grid : grids) {
+        grid.resize(static_cast<size_t>(width) * bandHeight);
+    }
+
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        float sum = 0;
+        forEachBandPair(worker, height, bandHeight,
+            [&](int slot, int y, int rows) {
+                for (int row = 0; row < rows; ++row) {
+                    for (int x = 0; x < width; ++x) {
+                        float v = std::sin(x * 0.1f + frame) * std::cos((y + row) * 0.1f);
+                        grids[slot][row * width + x] = std::sqrt(v * v + 1.0f);
+                    }
+                }
+            },
+            [&](int slot, int, int rows) {
+                sum += grids[slot][(rows - 1) * width];
+            });
+        sink = sum;
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 320;
+    int height = argc > 2 ? std::atoi(argv[2]) : 240;
+    int bandHeight = argc > 3 ? std::atoi(argv[3]) : 16;
+    int frames = argc > 4 ? std::atoi(argv[4]) : 200;
+    if (width <= 0 || height <= 0 || bandHeight <= 0 || frames <= 0) {
+        std::fprintf(stderr, "usage: %s [width] [height] [band height] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    // Warm up caches and the clock before either run is measured
+    renderFrames(nullptr, width, height, bandHeight, frames);
+
+    double sequential = renderFrames(nullptr, width, height, bandHeight, frames);
+    BandWorker worker;
+    double parallel = renderFrames(&worker, width, height, bandHeight, frames);
+
+    std::printf("%dx%d, %d-row bands, %u hardware threads\n", width, height, bandHeight,
+                std::thread::hardware_concurrency());
+    std::printf("sequential %8.2f ms/frame\n", sequential);
+    std::printf("parallel   %8.2f ms/frame\n", parallel);
+    std::printf("speedup    %8.2fx\n", sequential / parallel);
+    return 0;
+}
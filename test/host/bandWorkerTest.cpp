@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "bandWorker.h"
+
+
+namespace {
+
+// Frame drawn band by band through two band-sized grids, like the renderer's two band renderers
+struct BandFrame {
+    int width;
+    int height;
+    int bandHeight;
+    std::vector<uint32_t> grids[2];
+    std::vector<uint32_t> frame;
+    std::vector<int> order;
+    std::thread::id slotThread[2];
+
+    BandFrame(int width, int height, int bandHeight)
+        : width(width), height(height), bandHeight(bandHeight),
+          frame(static_cast<size_t>(width) * height, 0) {
+        for (auto& grid : grids) {
+            grid.assign(static_cast<size_t>(width) * bandHeight, 0);
+        }
+    }
+
+    static uint32_t pixel(int x, int y) {
+        return static_cast<uint32_t>(x * 2654435761u) ^ static_cast<uint32_t>(y * 40503u);
+    }
+
+    void render(BandWorker* worker) {
+        forEachBandPair(worker, height, bandHeight,
+            [this](int slot, int y, int rows) {
+                slotThread[slot] = std::this_thread::get_id();
+                for (int row = 0; row < rows; ++row) {
+                    for (int x = 0; x < width; ++x) {
+                        grids[slot][row * width + x] = pixel(x, y + row);
+                    }
+                }
+            },
+            [this](int slot, int y, int rows) {
+                order.push_back(y);
+                std::copy(grids[slot].begin(), grids[slot].begin() + rows * width, frame.begin() + y * width);
+            });
+    }
+};
+
+void expectSameAsSequential(int height, int bandHeight) {
+    BandFrame sequential(16, height, bandHeight);
+    sequential.render(nullptr);
+
+    BandWorker worker;
+    BandFrame parallel(16, height, bandHeight);
+    parallel.render(&worker);
+
+    EXPECT_EQ(parallel.frame, sequential.frame);
+    EXPECT_EQ(parallel.order, sequential.order);
+    for (int y = 0; y < height; ++y) {
+        ASSERT_EQ(sequential.frame[y * 16 + 3], BandFrame::pixel(3, y)) << y;
+    }
+}
+
+} // namespace
+
+
+TEST(BandWorker, UnbandedFrame) {
+    expectSameAsSequential(24, 24);
+}
+
+TEST(BandWorker, EvenBandCount) {
+    expectSameAsSequential(32, 8);
+}
+
+TEST(BandWorker, OddBandCount) {
+    expectSameAsSequential(40, 8);
+}
+
+TEST(BandWorker, ShortLastBand) {
+    expectSameAsSequential(37, 8);
+}
+
+TEST(BandWorker, OddBandsRunOnTheWorker) {
+    BandWorker worker;
+    BandFrame frame(4, 16, 4);
+    frame.render(&worker);
+    EXPECT_EQ(frame.order, (std::vector<int>{ 0, 4, 8, 12 }));
+    EXPECT_EQ(frame.slotThread[0], std::this_thread::get_id());
+    EXPECT_NE(frame.slotThread[1], std::this_thread::get_id());
+}
+
+TEST(BandWorker, WorkerErrorIsRethrown) {
+    BandWorker worker;
+    int delivered = 0;
+    auto draw = [](int slot, int, int) {
+        if (slot == 1) {
+            throw std::runtime_error("band");
+        }
+    };
+    EXPECT_THROW(forEachBandPair(&worker, 16, 4, draw, [&](int, int, int) { delivered++; }), std::runtime_error);
+    EXPECT_EQ(delivered, 0);
+
+    // The worker stays usable after a failed job
+    worker.run([]() {});
+    EXPECT_NO_THROW(worker.wait());
+}
@@ -0,0 +1,115 @@
+// Throughput of the event queue building blocks, numbers are host timings
+// and only meaningful relative to each other.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "eventRing.h"
+#include "inlineFunction.h"
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+void measure(const char* name, size_t ops, F&& body) {
+    auto start = Clock::now();
+    body();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    std::printf("%-40s %10.1f ns/op\n", name, ns / ops);
+}
+
+// Keeps the optimizer from dropping the measured work
+volatile uint64_t sink;
+
+} // namespace
+
+
+int main() {
+    constexpr size_t OPS = 2'000'000;
+
+    measure("EventRing push+pop, one thread", OPS, []() {
+        EventRing<uint64_t> ring(256);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < OPS; ++i) {
+            ring.tryPush(uint64_t(i));
+            uint64_t value;
+            ring.tryPop(value);
+            sum += value;
+        }
+        sink = sum;
+    });
+
+    for (int producers : { 1, 2, 4 }) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "EventRing %d producer(s), one consumer", producers);
+        measure(name, OPS, [producers]() {
+            EventRing<uint64_t> ring(256);
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; ++p) {
+                threads.emplace_back([&ring, producers]() {
+                    for (size_t i = 0; i < OPS / producers; ++i) {
+                        while (!ring.tryPush(uint64_t(i))) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            uint64_t sum = 0;
+            size_t received = 0;
+            size_t expected = OPS / producers * producers;
+            while (received < expected) {
+                uint64_t value;
+                if (ring.tryPop(value)) {
+                    sum += value;
+                    received++;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            sink = sum;
+        });
+    }
+
+    uint64_t a = 1, b = 2, c = 3;
+    measure("InlineFunction inline: create+move+call", OPS, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < OPS; ++i) {
+            InlineFunction<uint64_t(), 32> f([a, b, c, i]() { return a + b + c + i; });
+            InlineFunction<uint64_t(), 32> moved(std::move(f));
+            sum += moved();
+        }
+        sink = sum;
+    });
+
+    measure("InlineFunction heap: create+move+call", OPS, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < OPS; ++i) {
+            uint64_t d[5] = { a, b, c, i, 0 };
+            InlineFunction<uint64_t(), 32> f([d]() { return d[0] + d[1] + d[2] + d[3]; });
+            InlineFunction<uint64_t(), 32> moved(std::move(f));
+            sum += moved();
+        }
+        sink = sum;
+    });
+
+    measure("std::function: create+move+call", OPS, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < OPS; ++i) {
+            std::function<uint64_t()> f([a, b, c, i]() { return a + b + c + i; });
+            std::function<uint64_t()> moved(std::move(f));
+            sum += moved();
+        }
+        sink = sum;
+    });
+
+    return 0;
+}
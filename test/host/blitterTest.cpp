@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "blitter.h"
+
+
+namespace {
+
+constexpr int GRAY8 = 5;
+constexpr int RGB888 = 9;
+
+// Gray image whose pixel values encode their position, never zero
+struct Image {
+    std::vector<uint8_t> pixels;
+    BlitImage image;
+
+    Image(int width, int height, int format = GRAY8, bool pattern = true)
+        : pixels(static_cast<size_t>(width) * height * packedColorSize(format)),
+          image{ pixels.data(), width, height, format } {
+        if (pattern) {
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                pixels[i] = static_cast<uint8_t>(i + 1);
+            }
+        }
+    }
+
+    uint8_t at(int x, int y) const {
+        return pixels[y * image.width + x];
+    }
+};
+
+} // namespace
+
+
+TEST(Blitter, PlainCopyIsClipped) {
+    Image src(4, 4);
+    Image dst(4, 4, GRAY8, false);
+    Blitter blitter;
+
+    BlitOptions opts;
+    opts.dx = 2;
+    opts.dy = -1;
+    EXPECT_EQ(blitter.blit(dst.image, src.image, opts), 6u);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            uint8_t expected = (x >= 2 && y < 3) ? src.at(x - 2, y + 1) : 0;
+            ASSERT_EQ(dst.at(x, y), expected) << x << "," << y;
+        }
+    }
+}
+
+TEST(Blitter, SourceRectangle) {
+    Image src(6, 6);
+    Image dst(6, 6, GRAY8, false);
+    Blitter blitter;
+
+    BlitOptions opts;
+    opts.sx = -1;
+    opts.sy = 4;
+    opts.sw = 3;
+    opts.sh = 5;
+    // The source is clipped to x 0..1, y 4..5
+    EXPECT_EQ(blitter.blit(dst.image, src.image, opts), 4u);
+    EXPECT_EQ(dst.at(0, 0), src.at(0, 4));
+    EXPECT_EQ(dst.at(1, 1), src.at(1, 5));
+    EXPECT_EQ(dst.at(2, 0), 0);
+}
+
+TEST(Blitter, ConvertsFormats) {
+    Image src(2, 1, RGB888, false);
+    DisplayUtils::packColor(src.pixels.data(), RGB888, DisplayColors::WHITE);
+    DisplayUtils::packColor(src.pixels.data() + 3, RGB888, DisplayColors::RED);
+    Image dst(2, 1, GRAY8, false);
+    Blitter blitter;
+
+    EXPECT_EQ(blitter.blit(dst.image, src.image, BlitOptions{}), 2u);
+    EXPECT_EQ(dst.at(0, 0), 255);
+    EXPECT_EQ(dst.at(1, 0), (255 * 77) >> 8);
+}
+
+TEST(Blitter, ColorKeySkipsPixels) {
+    Image src(3, 1, GRAY8, false);
+    src.pixels = { 10, 0, 30 };
+    Image dst(3, 1, GRAY8, false);
+    dst.pixels = { 1, 2, 3 };
+    Blitter blitter;
+
+    BlitOptions opts;
+    opts.useColorKey = true;
+    opts.colorKey = DisplayColors::BLACK;
+    EXPECT_EQ(blitter.blit(dst.image, src.image, opts), 2u);
+    EXPECT_EQ(dst.pixels, (std::vector<uint8_t>{ 10, 2, 30 }));
+}
+
+TEST(Blitter, ScalesByNearestNeighbour) {
+    Image src(2, 2);
+    Image dst(4, 4, GRAY8, false);
+    Blitter blitter;
+
+    BlitOptions opts;
+    opts.scale = 2;
+    EXPECT_EQ(blitter.blit(dst.image, src.image, opts), 16u);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            ASSERT_EQ(dst.at(x, y), src.at(x / 2, y / 2));
+        }
+    }
+
+    // An explicit destination size overrides the scale
+    Image small(1, 1, GRAY8, false);
+    opts.dw = 1;
+    opts.dh = 1;
+    EXPECT_EQ(blitter.blit(small.image, src.image, opts), 1u);
+    EXPECT_EQ(small.at(0, 0), src.at(0, 0));
+}
+
+TEST(Blitter, RotatesAndFlips) {
+    // 3x2 source
+    //   1 2 3
+    //   4 5 6
+    Image src(3, 2);
+    Blitter blitter;
+
+    struct Case {
+        int rotation;
+        bool flipX;
+        bool flipY;
+        int width;
+        std::vector<uint8_t> expected;
+    };
+    std::vector<Case> cases = {
+        { 1, false, false, 2, { 4, 1, 5, 2, 6, 3 } },
+        { 2, false, false, 3, { 6, 5, 4, 3, 2, 1 } },
+        { 3, false, false, 2, { 3, 6, 2, 5, 1, 4 } },
+        { -1, false, false, 2, { 3, 6, 2, 5, 1, 4 } },
+        { 0, true, false, 3, { 3, 2, 1, 6, 5, 4 } },
+        { 0, false, true, 3, { 4, 5, 6, 1, 2, 3 } },
+        { 1, true, false, 2, { 1, 4, 2, 5, 3, 6 } },
+    };
+    for (const auto& c : cases) {
+        Image dst(c.width, 6 / c.width, GRAY8, false);
+        BlitOptions opts;
+        opts.rotation = c.rotation;
+        opts.flipX = c.flipX;
+        opts.flipY = c.flipY;
+        EXPECT_EQ(blitter.blit(dst.image, src.image, opts), 6u);
+        EXPECT_EQ(dst.pixels, c.expected) << c.rotation << c.flipX << c.flipY;
+    }
+}
+
+TEST(Blitter, OverlappingPlainCopyWithinOneBuffer) {
+    for (int dy : { -2, -1, 1, 2 }) {
+        for (int dx : { -1, 0, 1 }) {
+            Image img(6, 6);
+            Image reference = img;
+            reference.image.data = reference.pixels.data();
+            Blitter blitter;
+
+            BlitOptions opts;
+            opts.sx = 1;
+            opts.sy = 1;
+            opts.sw = 4;
+            opts.sh = 4;
+            opts.dx = 1 + dx;
+            opts.dy = 1 + dy;
+            blitter.blit(img.image, img.image, opts);
+
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    int ty = 1 + dy + y;
+                    int tx = 1 + dx + x;
+                    if (tx >= 0 && ty >= 0 && tx < 6 && ty < 6) {
+                        ASSERT_EQ(img.at(tx, ty), reference.at(1 + x, 1 + y)) << dx << "," << dy;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(Blitter, OverlappingTransformWithinOneBuffer) {
+    Image img(4, 4);
+    Image reference = img;
+    reference.image.data = reference.pixels.data();
+    Blitter blitter;
+
+    BlitOptions opts;
+    opts.sw = 3;
+    opts.sh = 3;
+    opts.dx = 1;
+    opts.dy = 1;
+    opts.flipX = true;
+    blitter.blit(img.image, img.image, opts);
+
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 3; ++x) {
+            ASSERT_EQ(img.at(1 + x, 1 + y), reference.at(2 - x, y));
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "bounceBuffers.h"
+
+
+TEST(BouncePlan, WholeRowsWhenARowFits) {
+    // 64 byte buffers hold 32 RGB565 pixels, three rows of 10
+    BouncePlan plan(FrameRegion{ 4, 2, 10, 7 }, 2, 64);
+    EXPECT_EQ(plan.chunkPixels(), 30u);
+    EXPECT_EQ(plan.chunks(), 3u);
+
+    BouncePlan::Chunk chunk;
+    std::vector<std::tuple<int, int, size_t>> chunks;
+    while (plan.next(chunk)) {
+        chunks.emplace_back(chunk.x, chunk.y, chunk.pixels);
+    }
+    std::vector<std::tuple<int, int, size_t>> expected = {
+        { 4, 2, 30 }, { 4, 5, 30 }, { 4, 8, 10 },
+    };
+    EXPECT_EQ(chunks, expected);
+}
+
+TEST(BouncePlan, ChunksCrossRowsWhenARowDoesNotFit) {
+    BouncePlan plan(FrameRegion{ 0, 0, 50, 2 }, 2, 64);
+    EXPECT_EQ(plan.chunkPixels(), 32u);
+    EXPECT_EQ(plan.chunks(), 4u);
+
+    BouncePlan::Chunk chunk;
+    ASSERT_TRUE(plan.next(chunk));
+    ASSERT_TRUE(plan.next(chunk));
+    EXPECT_EQ(chunk.x, 32);
+    EXPECT_EQ(chunk.y, 0);
+    EXPECT_EQ(chunk.pixels, 32u);
+}
+
+TEST(BouncePlan, EmptyWindow) {
+    BouncePlan plan(FrameRegion{ 0, 0, 0, 5 }, 2, 64);
+    BouncePlan::Chunk chunk;
+    EXPECT_EQ(plan.chunks(), 0u);
+    EXPECT_FALSE(plan.next(chunk));
+}
+
+TEST(BouncePlan, GatherReadsTheWindowInRowMajorOrder) {
+    constexpr int FRAME_W = 16, FRAME_H = 8;
+    constexpr size_t PIXEL = 2;
+    std::vector<uint8_t> frame(FRAME_W * FRAME_H * PIXEL);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    FrameRegion window{ 3, 1, 9, 5 };
+    std::vector<uint8_t> expected;
+    for (int y = window.y; y < window.y + window.height; ++y) {
+        auto row = frame.begin() + (y * FRAME_W + window.x) * PIXEL;
+        expected.insert(expected.end(), row, row + window.width * PIXEL);
+    }
+
+    // Every buffer size from under a pixel to over the whole window
+    for (size_t bufferBytes = 1; bufferBytes <= expected.size() + 4; ++bufferBytes) {
+        BouncePlan plan(window, PIXEL, bufferBytes);
+        std::vector<uint8_t> buffer(std::max(bufferBytes, PIXEL));
+        std::vector<uint8_t> gathered;
+        BouncePlan::Chunk chunk;
+        size_t chunks = 0;
+        while (plan.next(chunk)) {
+            size_t bytes = plan.gather(frame.data(), FRAME_W * PIXEL, PIXEL, chunk, buffer.data());
+            ASSERT_EQ(bytes, chunk.pixels * PIXEL);
+            ASSERT_LE(bytes, buffer.size());
+            gathered.insert(gathered.end(), buffer.begin(), buffer.begin() + bytes);
+            chunks++;
+        }
+        EXPECT_EQ(chunks, plan.chunks()) << bufferBytes;
+        ASSERT_EQ(gathered, expected) << bufferBytes;
+    }
+}
+
+TEST(BounceRing, HandsOutBuffersInOrder) {
+    BounceRing ring(3);
+    EXPECT_TRUE(ring.idle());
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(ring.acquire(), i);
+        ring.submit();
+    }
+    EXPECT_EQ(ring.inFlight(), 3u);
+    EXPECT_EQ(ring.acquire(), -1);
+
+    ring.complete();
+    EXPECT_EQ(ring.inFlight(), 2u);
+    EXPECT_EQ(ring.acquire(), 0);
+    ring.submit();
+    EXPECT_EQ(ring.acquire(), -1);
+
+    ring.complete();
+    ring.complete();
+    ring.complete();
+    EXPECT_TRUE(ring.idle());
+    EXPECT_EQ(ring.acquire(), 1);
+
+    ring.submit();
+    ring.reset();
+    EXPECT_TRUE(ring.idle());
+    EXPECT_EQ(ring.acquire(), 0);
+}
+
+TEST(BounceRing, StaysConsistentOverManyTransfers) {
+    BounceRing ring(2);
+    for (int i = 0; i < 100000; ++i) {
+        int buffer = ring.acquire();
+        ASSERT_EQ(buffer, i % 2);
+        ring.submit();
+        if (i % 2 == 1) {
+            ring.complete();
+            ring.complete();
+        }
+    }
+    EXPECT_TRUE(ring.idle());
+}
@@ -0,0 +1,82 @@
+// Drives VirtualDisplay through every input format and the sparse update
+// paths, printing the conversion cost of each. Usage:
+//   display_bench [width] [height] [frames] [dump pattern, e.g. "frame_%05u.ppm"]
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "virtualDisplay.h"
+
+
+namespace {
+
+void print(const char* name, const VirtualDisplay::CallStats& stats) {
+    if (stats.calls == 0) {
+        return;
+    }
+    double mpps = stats.totalUs > 0 ? static_cast<double>(stats.pixels) / stats.totalUs : 0.0;
+    std::printf("%-12s %6u calls %10.1f us avg %8llu us max %8.2f Mpx/s\n", name, stats.calls, stats.avgUs(),
+                static_cast<unsigned long long>(stats.maxUs), mpps);
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 64;
+    int height = argc > 2 ? std::atoi(argv[2]) : 32;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 100;
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        std::fprintf(stderr, "usage: %s [width] [height] [frames] [dump pattern]\n", argv[0]);
+        return 1;
+    }
+
+    // Native RGB565 like most SPI and i80 panels
+    VirtualDisplay display(width, height, 7);
+    display.start();
+
+    std::printf("setBuffer, %dx%d, %d frames per format\n", width, height, frames);
+    display.benchmarkFormats(frames);
+    static constexpr int FORMATS[] = { 3, 4, 5, 6, 7, 8, 9, 10, 12 };
+    for (int format : FORMATS) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "format %d", format);
+        print(name, display.formatStats(format));
+    }
+
+    display.resetStats();
+    display.setBrightness(128);
+    display.benchmarkFormats(frames);
+    std::printf("\nsetBuffer through a brightness LUT\n");
+    print("format 9", display.formatStats(9));
+
+    // Sparse updates touching a tenth of the pixels
+    std::mt19937 rng(1);
+    size_t count = static_cast<size_t>(width) * height / 10 + 1;
+    std::vector<uint32_t> records(count * 3);
+    std::vector<DisplayPixel> pixels(count);
+    for (size_t i = 0; i < count; ++i) {
+        int x = static_cast<int>(rng() % width);
+        int y = static_cast<int>(rng() % height);
+        uint32_t rgb = rng() & 0xFFFFFF;
+        records[i * 3] = x;
+        records[i * 3 + 1] = y;
+        records[i * 3 + 2] = rgb;
+        pixels[i] = DisplayPixel(x, y, DisplayColor{ static_cast<uint8_t>(rgb >> 16), static_cast<uint8_t>(rgb >> 8), static_cast<uint8_t>(rgb), 255 });
+    }
+
+    display.resetStats();
+    if (argc > 4) {
+        display.setDumpPattern(argv[4]);
+    }
+    for (int f = 0; f < frames; ++f) {
+        display.setPixels(records.data(), count, PixelRecordLayout::XY, false);
+        display.setBufferFromRaw(pixels, false);
+    }
+    std::printf("\nsparse updates, %zu pixels\n", count);
+    print("setPixels", display.stats(VirtualDisplay::Call::Pixels));
+    print("fromRaw", display.stats(VirtualDisplay::Call::Raw));
+    std::printf("\nchecksum %08x\n", display.checksum());
+    return 0;
+}
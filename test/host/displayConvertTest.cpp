@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "displayConvert.h"
+
+
+namespace {
+
+using DisplayUtils::ColorLut;
+
+const int FORMATS[] = { 3, 4, 5, 6, 7, 8, 9, 10, 12 };
+
+// Wider than the conversion chunk so the chunk loop is crossed
+constexpr int WIDTH = 70;
+constexpr int HEIGHT = 3;
+constexpr uint8_t UNTOUCHED = 0xA5;
+
+std::vector<uint8_t> pattern(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    return bytes;
+}
+
+ColorLut dimmed() {
+    ColorLut lut;
+    lut.build(200, 2.2f);
+    return lut;
+}
+
+// Per-pixel reference built on unpackColor and packColor
+void convertPixel(const uint8_t* src, int srcFormat, uint8_t* dst, int dstFormat, const ColorLut* lut) {
+    if (srcFormat == dstFormat && !lut) {
+        std::memcpy(dst, src, packedColorSize(srcFormat));
+        return;
+    }
+    DisplayColor c;
+    DisplayUtils::unpackColor(src, srcFormat, c);
+    if (lut) {
+        c.r = lut->table[c.r];
+        c.g = lut->table[c.g];
+        c.b = lut->table[c.b];
+    }
+    DisplayUtils::packColor(dst, dstFormat, c);
+}
+
+// Expected frame for `pixels` source pixels written into `layout`
+std::vector<uint8_t> reference(const std::vector<uint8_t>& src, int format, const DisplayLayout& layout,
+                               size_t pixels, const ColorLut* lut) {
+    size_t srcPixel = packedColorSize(format);
+    size_t dstPixel = packedColorSize(layout.format);
+    std::vector<uint8_t> dst(layout.stride * layout.height, UNTOUCHED);
+    for (size_t i = 0; i < pixels; ++i) {
+        size_t x = i % layout.width;
+        size_t y = i / layout.width;
+        convertPixel(src.data() + i * srcPixel, format, dst.data() + y * layout.stride + x * dstPixel,
+                     layout.format, lut);
+    }
+    return dst;
+}
+
+std::string pairName(int from, int to, bool lut) {
+    return std::to_string(from) + " -> " + std::to_string(to) + (lut ? " with LUT" : "");
+}
+
+void expectFrame(size_t padding, size_t pixels) {
+    const ColorLut lut = dimmed();
+    for (int from : FORMATS) {
+        for (int to : FORMATS) {
+            for (const ColorLut* table : { static_cast<const ColorLut*>(nullptr), &lut }) {
+                SCOPED_TRACE(pairName(from, to, table));
+                size_t dstPixel = packedColorSize(to);
+                DisplayLayout layout{ WIDTH, HEIGHT, to, WIDTH * dstPixel + padding };
+                auto src = pattern(pixels * packedColorSize(from));
+
+                std::vector<uint8_t> dst(layout.stride * HEIGHT, UNTOUCHED);
+                ASSERT_TRUE(DisplayUtils::convertFrame(src.data(), src.size(), from, layout, dst.data(), table));
+                ASSERT_EQ(dst, reference(src, from, layout, pixels, table));
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+TEST(DisplayConvert, UnpackRunMatchesUnpackColor) {
+    const ColorLut lut = dimmed();
+    for (int format : FORMATS) {
+        for (const ColorLut* table : { static_cast<const ColorLut*>(nullptr), &lut }) {
+            SCOPED_TRACE(pairName(format, format, table));
+            size_t pixel = packedColorSize(format);
+            auto src = pattern(WIDTH * pixel);
+
+            std::vector<DisplayColor> run(WIDTH);
+            ASSERT_TRUE(DisplayUtils::unpackRun(src.data(), WIDTH, format, run.data(), table));
+            for (int i = 0; i < WIDTH; ++i) {
+                DisplayColor expected;
+                DisplayUtils::unpackColor(src.data() + i * pixel, format, expected);
+                if (table) {
+                    expected.r = table->table[expected.r];
+                    expected.g = table->table[expected.g];
+                    expected.b = table->table[expected.b];
+                }
+                ASSERT_EQ(run[i], expected) << "pixel " << i;
+            }
+        }
+    }
+}
+
+TEST(DisplayConvert, PackRunMatchesPackColor) {
+    std::vector<DisplayColor> colors(WIDTH);
+    auto bytes = pattern(WIDTH * 4);
+    for (int i = 0; i < WIDTH; ++i) {
+        colors[i] = { bytes[i * 4], bytes[i * 4 + 1], bytes[i * 4 + 2], bytes[i * 4 + 3] };
+    }
+    for (int format : FORMATS) {
+        SCOPED_TRACE(format);
+        size_t pixel = packedColorSize(format);
+        std::vector<uint8_t> run(WIDTH * pixel, UNTOUCHED);
+        std::vector<uint8_t> expected(WIDTH * pixel, UNTOUCHED);
+
+        ASSERT_TRUE(DisplayUtils::packRun(colors.data(), WIDTH, format, run.data()));
+        for (int i = 0; i < WIDTH; ++i) {
+            DisplayUtils::packColor(expected.data() + i * pixel, format, colors[i]);
+        }
+        ASSERT_EQ(run, expected);
+    }
+}
+
+TEST(DisplayConvert, EveryFormatPairTightStride) {
+    expectFrame(0, WIDTH * HEIGHT);
+}
+
+TEST(DisplayConvert, EveryFormatPairPaddedStride) {
+    expectFrame(5, WIDTH * HEIGHT);
+}
+
+TEST(DisplayConvert, EveryFormatPairPartialLastRow) {
+    expectFrame(5, WIDTH * (HEIGHT - 1) + 5);
+}
+
+TEST(DisplayConvert, IdentityLutIsACopy) {
+    ColorLut identity;
+    DisplayLayout layout{ WIDTH, HEIGHT, 10, WIDTH * 4 + 8 };
+    auto src = pattern(WIDTH * HEIGHT * 4);
+
+    std::vector<uint8_t> dst(layout.stride * HEIGHT, UNTOUCHED);
+    ASSERT_TRUE(DisplayUtils::convertFrame(src.data(), src.size(), 10, layout, dst.data(), &identity));
+    EXPECT_EQ(dst, reference(src, 10, layout, WIDTH * HEIGHT, nullptr));
+}
+
+TEST(DisplayConvert, UnknownFormatIsRejected) {
+    DisplayLayout layout{ WIDTH, HEIGHT, 9, WIDTH * 3 };
+    std::vector<uint8_t> src(WIDTH * HEIGHT * 3);
+    std::vector<uint8_t> dst(layout.stride * HEIGHT);
+    std::vector<DisplayColor> colors(WIDTH);
+
+    EXPECT_FALSE(DisplayUtils::convertFrame(src.data(), src.size(), 11, layout, dst.data()));
+    layout.format = 11;
+    EXPECT_FALSE(DisplayUtils::convertFrame(src.data(), src.size(), 9, layout, dst.data()));
+    EXPECT_FALSE(DisplayUtils::unpackRun(src.data(), WIDTH, 11, colors.data()));
+    EXPECT_FALSE(DisplayUtils::packRun(colors.data(), WIDTH, 11, dst.data()));
+}
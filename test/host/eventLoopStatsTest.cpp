@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+#include "eventLoopStats.h"
+
+
+namespace {
+
+using Stats = EventLoopStats<2, 3, 2>;
+
+std::array<uint32_t, Stats::SIZE> snapshot(const Stats& stats) {
+    std::array<uint32_t, Stats::SIZE> out;
+    stats.snapshot(out.data());
+    return out;
+}
+
+} // namespace
+
+
+TEST(EventLoopStats, Layout) {
+    EXPECT_EQ(Stats::SOURCE_OFFSET, 1 + 2 * Stats::LANE_FIELDS);
+    EXPECT_EQ(Stats::SLOW_OFFSET, Stats::SOURCE_OFFSET + 3 * Stats::SOURCE_FIELDS);
+    EXPECT_EQ(Stats::SIZE, Stats::SLOW_OFFSET + 2 * Stats::SLOW_FIELDS);
+}
+
+TEST(EventLoopStats, SourcesSharingALaneAreKeptApart) {
+    Stats stats;
+    stats.waited(0, 3, 0);
+    stats.ran(0, 100, 0, 0x10, 0);
+    stats.waited(0, 40, 2);
+    stats.ran(0, 5, 0, 0x20, 2);
+    stats.waited(0, 7);
+    stats.ran(0, 1, 0, 0x30);
+
+    auto out = snapshot(stats);
+    EXPECT_EQ(out[0], 3u);
+    EXPECT_EQ(out[1], 3u); // all three counted for the lane
+
+    const uint32_t* first = out.data() + Stats::SOURCE_OFFSET;
+    EXPECT_EQ(first[0], 1u);
+    EXPECT_EQ(first[1], 3u);
+    EXPECT_EQ(first[2], 100u);
+    EXPECT_EQ(first[3 + Stats::Histogram::bucket(3)], 1u);
+    EXPECT_EQ(first[3 + Stats::BUCKETS + Stats::Histogram::bucket(100)], 1u);
+
+    const uint32_t* unused = out.data() + Stats::SOURCE_OFFSET + Stats::SOURCE_FIELDS;
+    EXPECT_EQ(unused[0], 0u);
+
+    const uint32_t* third = out.data() + Stats::SOURCE_OFFSET + 2 * Stats::SOURCE_FIELDS;
+    EXPECT_EQ(third[0], 1u);
+    EXPECT_EQ(third[1], 40u);
+    EXPECT_EQ(third[2], 5u);
+}
+
+TEST(EventLoopStats, SourcesPastTheLimitOnlyCountForTheirLane) {
+    Stats stats;
+    stats.waited(1, 9, 3);
+    stats.ran(1, 9, 0, 0, 3);
+
+    auto out = snapshot(stats);
+    EXPECT_EQ(out[1 + Stats::LANE_FIELDS], 1u);
+    for (size_t i = Stats::SOURCE_OFFSET; i < Stats::SLOW_OFFSET; ++i) {
+        ASSERT_EQ(out[i], 0u) << i;
+    }
+}
+
+TEST(EventLoopStats, ResetClearsSources) {
+    Stats stats;
+    stats.waited(0, 3, 1);
+    stats.ran(0, 3, 0, 0, 1);
+    stats.reset();
+
+    auto out = snapshot(stats);
+    for (uint32_t value : out) {
+        ASSERT_EQ(value, 0u);
+    }
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eventRing.h"
+
+
+TEST(EventRing, CapacityIsRoundedUp) {
+    EventRing<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRing, FullAndEmpty) {
+    EventRing<int> ring(4);
+    int value = -1;
+    EXPECT_FALSE(ring.tryPop(value));
+    EXPECT_EQ(value, -1);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPush(int(i)));
+    }
+    EXPECT_EQ(ring.size(), 4u);
+    EXPECT_FALSE(ring.tryPush(4));
+    EXPECT_FALSE(ring.tryEmplace(4));
+    EXPECT_EQ(ring.size(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.tryPop(value));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRing, ClaimedSlotIsNotPoppedBeforeItIsPublished) {
+    // Blocks the producer between claiming the slot and publishing it
+    struct Gated {
+        int value = 0;
+        Gated() = default;
+        Gated(std::atomic<bool>* open, int value) : value(value) {
+            while (!open->load()) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    EventRing<Gated> ring(4);
+    std::atomic<bool> open = false;
+    std::thread producer([&]() {
+        ring.tryEmplace(&open, 7);
+    });
+    while (ring.size() == 0) {
+        std::this_thread::yield();
+    }
+
+    // Counted already, but not poppable until the producer is done
+    Gated out;
+    EXPECT_FALSE(ring.empty());
+    EXPECT_FALSE(ring.tryPop(out));
+
+    open = true;
+    producer.join();
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out.value, 7);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRing, WrapsAround) {
+    EventRing<int> ring(4);
+    int next = 0;
+    int expected = 0;
+    // Many laps with a varying fill level, so every slot is reused at every offset
+    for (int lap = 0; lap < 100; ++lap) {
+        int fill = 1 + lap % 4;
+        for (int i = 0; i < fill; ++i) {
+            ASSERT_TRUE(ring.tryPush(int(next++)));
+        }
+        for (int i = 0; i < fill; ++i) {
+            int value;
+            ASSERT_TRUE(ring.tryPop(value));
+            ASSERT_EQ(value, expected++);
+        }
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRing, DestroysElements) {
+    auto counted = std::make_shared<int>(0);
+    {
+        EventRing<std::shared_ptr<int>> ring(4);
+        ring.tryPush(std::shared_ptr<int>(counted));
+        ring.tryEmplace(counted);
+        EXPECT_EQ(counted.use_count(), 3);
+
+        std::shared_ptr<int> out;
+        ASSERT_TRUE(ring.tryPop(out));
+        out.reset();
+        EXPECT_EQ(counted.use_count(), 2);
+    }
+    EXPECT_EQ(counted.use_count(), 1);
+}
+
+TEST(EventRing, MultiProducerKeepsPerProducerOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    EventRing<uint32_t> ring(64);
+
+    std::atomic<bool> start = false;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&, p]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            for (uint32_t i = 0; i < PER_PRODUCER; ++i) {
+                uint32_t value = (static_cast<uint32_t>(p) << 24) | i;
+                while (!ring.tryPush(uint32_t(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    std::vector<uint32_t> received;
+    received.reserve(PRODUCERS * PER_PRODUCER);
+    start = true;
+    while (received.size() < PRODUCERS * PER_PRODUCER) {
+        uint32_t value;
+        if (!ring.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t producer = value >> 24;
+        ASSERT_LT(producer, static_cast<uint32_t>(PRODUCERS));
+        ASSERT_EQ(value & 0xFFFFFF, next[producer]);
+        next[producer]++;
+        received.push_back(value);
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(ring.empty());
+    std::sort(received.begin(), received.end());
+    EXPECT_EQ(std::adjacent_find(received.begin(), received.end()), received.end());
+}
+
+TEST(EventRing, MultiConsumerTakesEachElementOnce) {
+    constexpr int CONSUMERS = 3;
+    constexpr uint32_t COUNT = 50000;
+    EventRing<uint32_t> ring(32);
+
+    std::atomic<uint32_t> taken = 0;
+    std::vector<std::vector<uint32_t>> results(CONSUMERS);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&, c]() {
+            uint32_t value;
+            while (taken < COUNT) {
+                if (ring.tryPop(value)) {
+                    // A single producer, so every consumer sees increasing values
+                    if (!results[c].empty()) {
+                        EXPECT_GT(value, results[c].back());
+                    }
+                    results[c].push_back(value);
+                    taken++;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        while (!ring.tryPush(uint32_t(i))) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+
+    std::vector<uint32_t> all;
+    for (auto& result : results) {
+        all.insert(all.end(), result.begin(), result.end());
+    }
+    ASSERT_EQ(all.size(), COUNT);
+    std::sort(all.begin(), all.end());
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        ASSERT_EQ(all[i], i);
+    }
+}
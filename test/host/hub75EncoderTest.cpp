@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "hub75Encoder.h"
+
+
+namespace {
+
+// Plane rows of one scan row in stream order, mirroring the encoder's schedule
+std::vector<int> planeCopies(int depth, int transition) {
+    std::vector<int> copies;
+    for (int plane = 0; plane < depth; ++plane) {
+        int repeats = plane < transition ? 1 : 1 << (plane - transition);
+        copies.insert(copies.end(), repeats, plane);
+    }
+    return copies;
+}
+
+Hub75Config smallPanel() {
+    Hub75Config config;
+    config.width = 8;
+    config.height = 4;
+    config.depth = 8;
+    config.gamma = 1.0f;
+    return config;
+}
+
+} // namespace
+
+
+TEST(Hub75Encoder, StreamLayout) {
+    Hub75Config config = smallPanel();
+    config.chain = 2;
+    Hub75Encoder encoder(config);
+
+    auto copies = planeCopies(8, 4);
+    EXPECT_EQ(encoder.width(), 16);
+    EXPECT_EQ(encoder.copiesPerFrame(), copies.size() * 2);
+    EXPECT_EQ(encoder.streamWords(), copies.size() * 2 * 16);
+    EXPECT_EQ(encoder.streamBytes(), encoder.streamWords() * 2);
+}
+
+TEST(Hub75Encoder, DepthAndTransitionAreClamped) {
+    Hub75Config config = smallPanel();
+    config.depth = 20;
+    config.transition = 50;
+    Hub75Encoder encoder(config);
+    EXPECT_EQ(encoder.depth(), Hub75Encoder::MAX_DEPTH);
+
+    // Only the last plane is repeated, and only once
+    size_t copies = planeCopies(Hub75Encoder::MAX_DEPTH, Hub75Encoder::MAX_DEPTH - 1).size();
+    EXPECT_EQ(encoder.copiesPerFrame(), copies * 2);
+}
+
+TEST(Hub75Encoder, ControlBitsFollowThePreviousCopy) {
+    Hub75Config config = smallPanel();
+    config.oeMirror = 1 << 15;
+    Hub75Encoder encoder(config);
+
+    auto copies = planeCopies(8, 4);
+    size_t count = encoder.copiesPerFrame();
+    const uint16_t* stream = encoder.stream();
+    for (size_t i = 0; i < count; ++i) {
+        // The address and window belong to the plane latched at the end of the previous copy
+        size_t shown = (i + count - 1) % count;
+        int row = static_cast<int>(shown / copies.size());
+        int plane = copies[shown % copies.size()];
+        int window = plane < 4 ? 8 >> (4 - plane) : 7;
+
+        for (int x = 0; x < 8; ++x) {
+            uint16_t word = stream[i * 8 + x];
+            EXPECT_EQ((word >> Hub75Encoder::ADDR_SHIFT) & 0x1F, row) << i << ":" << x;
+            EXPECT_EQ((word & Hub75Encoder::BIT_LAT) != 0, x == 7) << i << ":" << x;
+            bool blanked = x >= window;
+            EXPECT_EQ((word & Hub75Encoder::BIT_OE) != 0, blanked) << i << ":" << x;
+            EXPECT_EQ((word & config.oeMirror) != 0, blanked) << i << ":" << x;
+            EXPECT_EQ(word & Hub75Encoder::COLOR_MASK, 0) << i << ":" << x;
+        }
+    }
+}
+
+TEST(Hub75Encoder, ZeroBrightnessBlanksEverything) {
+    Hub75Encoder encoder(smallPanel());
+    encoder.setPixel(0, 0, DisplayColors::WHITE);
+    encoder.setBrightness(0);
+
+    for (size_t i = 0; i < encoder.streamWords(); ++i) {
+        ASSERT_NE(encoder.stream()[i] & Hub75Encoder::BIT_OE, 0) << i;
+    }
+    // Colors are kept, only the output window changes
+    EXPECT_NE(encoder.stream()[0] & Hub75Encoder::BIT_R1, 0);
+}
+
+TEST(Hub75Encoder, PixelBitsLandInTheirPlanes) {
+    Hub75Encoder encoder(smallPanel());
+    // Upper half drives R1/G1/B1, the lower half of the same scan row R2/G2/B2
+    encoder.setPixel(3, 1, DisplayColor{ 0x81, 0x00, 0x02, 255 });
+    encoder.setPixel(5, 3, DisplayColor{ 0x00, 0x40, 0x00, 255 });
+
+    auto copies = planeCopies(8, 4);
+    const uint16_t* row = encoder.stream() + copies.size() * 8; // scan row 1
+    for (size_t copy = 0; copy < copies.size(); ++copy) {
+        int plane = copies[copy];
+        uint16_t upper = row[copy * 8 + 3] & Hub75Encoder::COLOR_MASK;
+        uint16_t expected = (plane == 0 || plane == 7 ? Hub75Encoder::BIT_R1 : 0) | (plane == 1 ? Hub75Encoder::BIT_B1 : 0);
+        EXPECT_EQ(upper, expected) << "plane " << plane;
+
+        uint16_t lower = row[copy * 8 + 5] & Hub75Encoder::COLOR_MASK;
+        EXPECT_EQ(lower, plane == 6 ? Hub75Encoder::BIT_G2 : 0) << "plane " << plane;
+    }
+
+    // Scan row 0 is untouched
+    for (size_t i = 0; i < copies.size() * 8; ++i) {
+        ASSERT_EQ(encoder.stream()[i] & Hub75Encoder::COLOR_MASK, 0);
+    }
+}
+
+TEST(Hub75Encoder, EncodeMatchesSetPixel) {
+    Hub75Encoder frame(smallPanel());
+    Hub75Encoder pixels(smallPanel());
+
+    std::vector<uint8_t> rgb(8 * 4 * 3);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            DisplayColor color{ static_cast<uint8_t>(x * 31), static_cast<uint8_t>(y * 60), static_cast<uint8_t>(x ^ y), 255 };
+            DisplayUtils::packColor(rgb.data() + (y * 8 + x) * 3, 9, color);
+            pixels.setPixel(x, y, color);
+        }
+    }
+    ASSERT_TRUE(frame.encode(rgb.data(), rgb.size(), 9));
+    EXPECT_FALSE(frame.encode(rgb.data(), rgb.size(), 42));
+    EXPECT_TRUE(std::equal(frame.stream(), frame.stream() + frame.streamWords(), pixels.stream()));
+
+    // A region update of the same data leaves the stream unchanged
+    FrameRegion region{ 2, 1, 4, 2 };
+    ASSERT_TRUE(frame.encodeRegion(rgb.data() + (1 * 8 + 2) * 3, 8 * 3, 9, region));
+    EXPECT_TRUE(std::equal(frame.stream(), frame.stream() + frame.streamWords(), pixels.stream()));
+
+    frame.clear();
+    for (size_t i = 0; i < frame.streamWords(); ++i) {
+        ASSERT_EQ(frame.stream()[i] & Hub75Encoder::COLOR_MASK, 0);
+        ASSERT_EQ(frame.stream()[i] & ~Hub75Encoder::COLOR_MASK, pixels.stream()[i] & ~Hub75Encoder::COLOR_MASK);
+    }
+}
+
+TEST(Hub75Encoder, GammaMapsThroughTheTable) {
+    Hub75Config config = smallPanel();
+    config.depth = 4;
+    config.gamma = 2.0f;
+    Hub75Encoder encoder(config);
+
+    // 128/255 squared is a quarter, times 15 rounds to 4, which is plane 2 only
+    encoder.setPixel(0, 0, DisplayColor{ 128, 0, 0, 255 });
+    auto copies = planeCopies(4, 0);
+    for (size_t copy = 0; copy < copies.size(); ++copy) {
+        EXPECT_EQ((encoder.stream()[copy * 8] & Hub75Encoder::BIT_R1) != 0, copies[copy] == 2) << copy;
+    }
+}
+
+TEST(Hub75Encoder, SetGammaReencodesTheFrame) {
+    Hub75Config config = smallPanel();
+    Hub75Encoder encoder(config);
+    config.gamma = 2.0f;
+    Hub75Encoder expected(config);
+
+    std::vector<uint8_t> frame(8 * 4 * 3);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<uint8_t>(i * 37);
+    }
+    encoder.encode(frame.data(), frame.size(), 9);
+    expected.encode(frame.data(), frame.size(), 9);
+
+    encoder.setGamma(2.0f);
+    for (size_t i = 0; i < encoder.streamWords(); ++i) {
+        ASSERT_EQ(encoder.stream()[i], expected.stream()[i]) << i;
+    }
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "inlineFunction.h"
+
+
+namespace {
+
+using Function = InlineFunction<int(int), 32>;
+
+struct Small {
+    int offset;
+    int operator()(int x) const { return x + offset; }
+};
+
+struct Large {
+    std::array<int, 16> values;
+    int operator()(int x) const { return x + values[15]; }
+};
+
+// Copying is fine, but a throwing move must not be placed inline
+struct ThrowingMove {
+    int value = 3;
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false) : value(other.value) {}
+    int operator()(int x) const { return x * value; }
+};
+
+} // namespace
+
+
+TEST(InlineFunction, StoragePolicy) {
+    EXPECT_TRUE(Function::storedInline<Small>);
+    EXPECT_TRUE(Function::storedInline<int(*)(int)>);
+    EXPECT_FALSE(Function::storedInline<Large>);
+    EXPECT_FALSE(Function::storedInline<ThrowingMove>);
+}
+
+TEST(InlineFunction, EmptyByDefault) {
+    Function empty;
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty.target(), 0u);
+
+    Function null(nullptr);
+    EXPECT_FALSE(null);
+}
+
+TEST(InlineFunction, CallsInlineAndHeapCallables) {
+    Function small(Small{ 5 });
+    EXPECT_EQ(small(1), 6);
+
+    Large large{};
+    large.values[15] = 100;
+    Function heap(large);
+    EXPECT_EQ(heap(1), 101);
+
+    Function throwing(ThrowingMove{});
+    EXPECT_EQ(throwing(2), 6);
+
+    Function pointer(+[](int x) { return -x; });
+    EXPECT_EQ(pointer(4), -4);
+}
+
+TEST(InlineFunction, TrivialOnlyWithoutDestructor) {
+    EXPECT_TRUE(Function().trivial());
+    EXPECT_TRUE(Function(Small{ 1 }).trivial());
+    EXPECT_TRUE(Function(+[](int x) { return x; }).trivial());
+
+    auto counted = std::make_shared<int>(0);
+    EXPECT_FALSE(Function([counted](int x) { return x; }).trivial());
+    Large large{};
+    EXPECT_FALSE(Function(large).trivial());
+}
+
+TEST(InlineFunction, TargetDiffersBetweenTypes) {
+    Function a(Small{ 1 });
+    Function b(Small{ 2 });
+    Function c([](int x) { return x; });
+    EXPECT_NE(a.target(), 0u);
+    EXPECT_EQ(a.target(), b.target());
+    EXPECT_NE(a.target(), c.target());
+}
+
+TEST(InlineFunction, MoveTransfersOwnership) {
+    auto counted = std::make_shared<int>(7);
+    for (bool large : { false, true }) {
+        std::array<char, 64> padding{};
+        Function f;
+        if (large) {
+            f = Function([counted, padding](int x) { return x + *counted + padding[0]; });
+        }
+        else {
+            f = Function([counted](int x) { return x + *counted; });
+        }
+        EXPECT_EQ(counted.use_count(), 2);
+
+        Function moved(std::move(f));
+        EXPECT_FALSE(f);  // NOLINT(bugprone-use-after-move)
+        EXPECT_EQ(moved(1), 8);
+        EXPECT_EQ(counted.use_count(), 2);
+
+        Function assigned;
+        assigned = std::move(moved);
+        EXPECT_FALSE(moved);  // NOLINT(bugprone-use-after-move)
+        EXPECT_EQ(assigned(2), 9);
+
+        assigned.reset();
+        EXPECT_FALSE(assigned);
+        EXPECT_EQ(counted.use_count(), 1);
+    }
+}
+
+TEST(InlineFunction, AssignmentDestroysPrevious) {
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    Function f([first](int x) { return x + *first; });
+    f = Function([second](int x) { return x + *second; });
+    EXPECT_EQ(first.use_count(), 1);
+    EXPECT_EQ(second.use_count(), 2);
+    EXPECT_EQ(f(0), 2);
+}
+
+TEST(InlineFunction, ForwardsMoveOnlyArguments) {
+    InlineFunction<std::string(std::unique_ptr<std::string>)> f([](std::unique_ptr<std::string> s) {
+        return *s + "!";
+    });
+    EXPECT_EQ(f(std::make_unique<std::string>("hi")), "hi!");
+}
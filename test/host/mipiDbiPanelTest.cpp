@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mipiDbiPanel.h"
+
+
+namespace {
+
+using Kind = MipiDbiRecorder::Kind;
+
+std::vector<uint8_t> commands(const MipiDbiRecorder& bus) {
+    std::vector<uint8_t> result;
+    for (const auto& op : bus.ops) {
+        if (op.kind == Kind::Command) {
+            result.push_back(op.cmd);
+        }
+    }
+    return result;
+}
+
+std::vector<uint8_t> data(const MipiDbiRecorder& bus) {
+    std::vector<uint8_t> result;
+    for (const auto& op : bus.ops) {
+        if (op.kind == Kind::Data) {
+            result.insert(result.end(), op.bytes.begin(), op.bytes.end());
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+
+TEST(MipiDbiPanel, St7789InitSequence) {
+    MipiDbiRecorder bus;
+    MipiDbiConfig config;
+    config.rotation = 1;
+    config.invert = true;
+    config.tearingEffect = true;
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, config);
+    panel.init();
+
+    EXPECT_EQ(panel.width(), 320);
+    EXPECT_EQ(panel.height(), 240);
+
+    std::vector<uint8_t> expected = {
+        mipi::SWRESET, mipi::COLMOD, mipi::MADCTL, mipi::INVON, mipi::TEON, mipi::SLPOUT, mipi::NORON, mipi::DISPON,
+    };
+    EXPECT_EQ(commands(bus), expected);
+
+    ASSERT_EQ(bus.ops[1].kind, Kind::Delay);
+    EXPECT_EQ(bus.ops[1].delayMs, 150);
+    EXPECT_EQ(bus.ops[2].bytes, std::vector<uint8_t>{ 0x55 });
+    EXPECT_EQ(bus.ops[4].bytes, std::vector<uint8_t>{ mipi::MADCTL_MX | mipi::MADCTL_MV });
+}
+
+TEST(MipiDbiPanel, Ili9341SendsPowerSetup) {
+    MipiDbiRecorder bus;
+    MipiDbiConfig config;
+    config.controller = MipiDbiController::ILI9341;
+    config.bgr = true;
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, config);
+    panel.init();
+
+    auto sent = commands(bus);
+    ASSERT_GT(sent.size(), 8u);
+    EXPECT_EQ(sent[0], mipi::SWRESET);
+    EXPECT_EQ(sent[1], 0xCF);
+    EXPECT_EQ(sent.back(), mipi::DISPON);
+    for (const auto& op : bus.ops) {
+        if (op.kind == Kind::Command && op.cmd == mipi::MADCTL) {
+            EXPECT_EQ(op.bytes, std::vector<uint8_t>{ mipi::MADCTL_MX | mipi::MADCTL_BGR });
+        }
+    }
+}
+
+TEST(MipiDbiPanel, WindowSkipsUnchangedRanges) {
+    MipiDbiRecorder bus;
+    MipiDbiConfig config;
+    config.colOffset = 35;
+    config.rowOffset = 20;
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, config);
+    panel.init();
+    bus.ops.clear();
+
+    panel.setWindow(0, 0, 10, 5);
+    panel.setWindow(0, 0, 10, 5);
+    panel.setWindow(0, 5, 10, 5);
+    std::vector<uint8_t> expected = {
+        mipi::CASET, mipi::RASET, mipi::RAMWR,
+        mipi::RAMWR,
+        mipi::RASET, mipi::RAMWR,
+    };
+    EXPECT_EQ(commands(bus), expected);
+
+    // Offsets are added, ranges are inclusive and sent high byte first
+    EXPECT_EQ(bus.ops[0].bytes, (std::vector<uint8_t>{ 0, 35, 0, 44 }));
+    EXPECT_EQ(bus.ops[1].bytes, (std::vector<uint8_t>{ 0, 20, 0, 24 }));
+    EXPECT_EQ(bus.ops[4].bytes, (std::vector<uint8_t>{ 0, 25, 0, 29 }));
+
+    // init forgets the window, the controller was reset
+    panel.init();
+    bus.ops.clear();
+    panel.setWindow(0, 5, 10, 5);
+    EXPECT_EQ(commands(bus), (std::vector<uint8_t>{ mipi::CASET, mipi::RASET, mipi::RAMWR }));
+}
+
+TEST(MipiDbiPanel, RegionIsConvertedAndChunked) {
+    // Buffers of 7 pixels and a bit, so chunks end mid row
+    MipiDbiRecorder bus(15, 2);
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, MipiDbiConfig{});
+
+    constexpr int W = 5, H = 3;
+    std::vector<uint8_t> rgb(W * H * 3);
+    std::vector<uint8_t> expected;
+    for (int i = 0; i < W * H; ++i) {
+        DisplayColor color{ static_cast<uint8_t>(i * 16), static_cast<uint8_t>(255 - i * 8), static_cast<uint8_t>(i), 255 };
+        DisplayUtils::packColor(rgb.data() + i * 3, 9, color);
+        uint8_t be[2];
+        DisplayUtils::packColor(be, mipi::PIXEL_FORMAT, color);
+        expected.insert(expected.end(), be, be + 2);
+    }
+
+    ASSERT_TRUE(panel.writeRegion(rgb.data(), W * 3, 9, FrameRegion{ 10, 20, W, H }));
+    EXPECT_EQ(commands(bus), (std::vector<uint8_t>{ mipi::CASET, mipi::RASET, mipi::RAMWR }));
+    EXPECT_EQ(data(bus), expected);
+    for (const auto& op : bus.ops) {
+        if (op.kind == Kind::Data) {
+            EXPECT_LE(op.bytes.size(), 14u);
+            EXPECT_EQ(op.bytes.size() % 2, 0u);
+        }
+    }
+
+    EXPECT_FALSE(panel.writeRegion(rgb.data(), W * 3, 42, FrameRegion{ 0, 0, W, H }));
+}
+
+TEST(MipiDbiPanel, RegionIsClipped) {
+    MipiDbiRecorder bus;
+    MipiDbiConfig config;
+    config.width = 8;
+    config.height = 8;
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, config);
+
+    // 4x4 region hanging over the top left corner by one pixel each way
+    std::vector<uint8_t> gray(16);
+    for (int i = 0; i < 16; ++i) {
+        gray[i] = static_cast<uint8_t>(i * 16);
+    }
+    ASSERT_TRUE(panel.writeRegion(gray.data(), 4, 5, FrameRegion{ -1, -1, 4, 4 }));
+
+    EXPECT_EQ(bus.ops[0].bytes, (std::vector<uint8_t>{ 0, 0, 0, 2 }));
+    EXPECT_EQ(bus.ops[1].bytes, (std::vector<uint8_t>{ 0, 0, 0, 2 }));
+    auto sent = data(bus);
+    ASSERT_EQ(sent.size(), 9u * 2);
+    // First pixel sent is source (1, 1)
+    DisplayColor first;
+    DisplayUtils::unpackColor(sent.data(), mipi::PIXEL_FORMAT, first);
+    DisplayColor expected;
+    DisplayUtils::unpackColor(&gray[5], 5, expected);
+    uint8_t a[2], b[2];
+    DisplayUtils::packColor(a, mipi::PIXEL_FORMAT, first);
+    DisplayUtils::packColor(b, mipi::PIXEL_FORMAT, expected);
+    EXPECT_EQ(a[0], b[0]);
+    EXPECT_EQ(a[1], b[1]);
+
+    bus.ops.clear();
+    ASSERT_TRUE(panel.writeRegion(gray.data(), 4, 5, FrameRegion{ 8, 0, 4, 4 }));
+    EXPECT_TRUE(bus.ops.empty());
+}
+
+TEST(MipiDbiPanel, FillRepeatsOnePixel) {
+    MipiDbiRecorder bus(16, 2);
+    MipiDbiPanel<MipiDbiRecorder> panel(bus, MipiDbiConfig{});
+    panel.fill(FrameRegion{ 0, 0, 3, 5 }, DisplayColors::RED);
+
+    auto sent = data(bus);
+    ASSERT_EQ(sent.size(), 15u * 2);
+    for (size_t i = 0; i < sent.size(); i += 2) {
+        EXPECT_EQ(sent[i], 0xF8);
+        EXPECT_EQ(sent[i + 1], 0x00);
+    }
+}
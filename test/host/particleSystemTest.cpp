@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "particleSystem.h"
+
+
+namespace {
+
+struct Visited {
+    int x;
+    int y;
+};
+
+std::vector<Visited> visit(const ParticleSystem& system) {
+    std::vector<Visited> out;
+    system.forEach([&](int x, int y, uint32_t, uint8_t) {
+        out.push_back({ x, y });
+    });
+    return out;
+}
+
+} // namespace
+
+
+TEST(ParticleSystem, InvertedBoundsAreSwapped) {
+    ParticleSystem system(2);
+    system.setBounds(ParticleSystem::Bounds::Clamp, 10, 20, 0, 5);
+    system.emit({ .x = -3, .y = 30 });
+    system.emit({ .x = 4, .y = 7 });
+    system.step(0);
+
+    float x[2], y[2];
+    system.read(ParticleSystem::Field::X, x, 2);
+    system.read(ParticleSystem::Field::Y, y, 2);
+    EXPECT_EQ(x[0], 0);
+    EXPECT_EQ(y[0], 20);
+    EXPECT_EQ(x[1], 4);
+    EXPECT_EQ(y[1], 7);
+}
+
+TEST(ParticleSystem, InvertedBoundsKillOutside) {
+    ParticleSystem system(2);
+    system.setBounds(ParticleSystem::Bounds::Kill, 10, 10, 0, 0);
+    system.emit({ .x = 5, .y = 5 });
+    system.emit({ .x = 15, .y = 5 });
+    system.step(0);
+
+    ASSERT_EQ(system.count(), 1u);
+    auto visited = visit(system);
+    EXPECT_EQ(visited[0].x, 5);
+}
+
+TEST(ParticleSystem, ForEachFloorsCoordinates) {
+    ParticleSystem system(2);
+    system.emit({ .x = 1.7f, .y = -0.5f });
+    system.emit({ .x = -2147483648.0f, .y = 2147483520.0f });
+
+    auto visited = visit(system);
+    ASSERT_EQ(visited.size(), 2u);
+    EXPECT_EQ(visited[0].x, 1);
+    EXPECT_EQ(visited[0].y, -1);
+    EXPECT_EQ(visited[1].x, std::numeric_limits<int>::min());
+    EXPECT_EQ(visited[1].y, 2147483520);
+}
+
+TEST(ParticleSystem, ForEachSkipsUnrepresentableCoordinates) {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    ParticleSystem system(6);
+    system.emit({ .x = std::nanf(""), .y = 0 });
+    system.emit({ .x = 0, .y = inf });
+    system.emit({ .x = -inf, .y = 0 });
+    system.emit({ .x = 2147483648.0f, .y = 0 });
+    system.emit({ .x = 0, .y = -1e10f });
+    system.emit({ .x = 3, .y = 4 });
+
+    auto visited = visit(system);
+    ASSERT_EQ(visited.size(), 1u);
+    EXPECT_EQ(visited[0].x, 3);
+    EXPECT_EQ(visited[0].y, 4);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "virtualDisplay.h"
+
+
+namespace {
+
+constexpr int RGB888 = 9;
+constexpr int RGB565_LE = 7;
+
+std::vector<uint8_t> gradient(int width, int height, int format) {
+    size_t pixelSize = packedColorSize(format);
+    std::vector<uint8_t> buffer(pixelSize * width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            DisplayColor color{ static_cast<uint8_t>(x * 16), static_cast<uint8_t>(y * 32), static_cast<uint8_t>(x + y), 255 };
+            DisplayUtils::packColor(buffer.data() + (y * width + x) * pixelSize, format, color);
+        }
+    }
+    return buffer;
+}
+
+} // namespace
+
+
+TEST(VirtualDisplay, NativeBufferIsCopied) {
+    VirtualDisplay display(8, 4, RGB888);
+    auto buffer = gradient(8, 4, RGB888);
+    display.setBuffer(buffer.data(), buffer.size(), RGB888, false);
+
+    EXPECT_EQ(display.frame(), buffer);
+    EXPECT_EQ(display.frameCount(), 1u);
+    EXPECT_EQ(display.stats(VirtualDisplay::Call::Buffer).calls, 1u);
+    EXPECT_EQ(display.stats(VirtualDisplay::Call::Buffer).pixels, 32u);
+    EXPECT_EQ(display.formatStats(RGB888).calls, 1u);
+}
+
+TEST(VirtualDisplay, ForeignBufferIsConverted) {
+    VirtualDisplay display(8, 4, RGB565_LE);
+    auto source = gradient(8, 4, RGB888);
+    display.setBuffer(source.data(), source.size(), RGB888, false);
+
+    // Converting through DisplayColor gives the same bytes as packing the gradient directly
+    EXPECT_EQ(display.frame(), gradient(8, 4, RGB565_LE));
+    EXPECT_EQ(display.formatStats(RGB888).calls, 1u);
+    EXPECT_EQ(display.formatStats(RGB565_LE).calls, 0u);
+}
+
+TEST(VirtualDisplay, SparseUpdates) {
+    VirtualDisplay display(4, 4, RGB888);
+    uint32_t records[] = {
+        1, 2, 0xFF0000,
+        9, 9, 0x00FF00, // outside, skipped
+        3, 0, 0x0000FF,
+    };
+    display.setPixels(records, 3, PixelRecordLayout::XY, true);
+
+    const auto& frame = display.frame();
+    size_t red = (2 * 4 + 1) * 3;
+    size_t blue = 3 * 3;
+    EXPECT_EQ(frame[red], 255);
+    EXPECT_EQ(frame[red + 1], 0);
+    EXPECT_EQ(frame[blue + 2], 255);
+    EXPECT_EQ(display.stats(VirtualDisplay::Call::Pixels).pixels, 3u);
+
+    display.setBufferFromRaw({ DisplayPixel(0, 0, DisplayColors::WHITE) }, true);
+    EXPECT_EQ(display.frame()[0], 255);
+    EXPECT_EQ(display.frame()[red], 0);
+}
+
+TEST(VirtualDisplay, RegionUpdate) {
+    VirtualDisplay display(8, 8, RGB888);
+    auto source = gradient(8, 8, RGB888);
+    FrameRegion region{ 2, 3, 4, 2 };
+    size_t stride = 8 * 3;
+    display.setRegion(source.data() + region.y * stride + region.x * 3, stride, RGB888, region);
+
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            bool inside = x >= 2 && x < 6 && y >= 3 && y < 5;
+            size_t offset = y * stride + x * 3;
+            for (int c = 0; c < 3; ++c) {
+                ASSERT_EQ(display.frame()[offset + c], inside ? source[offset + c] : 0) << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(VirtualDisplay, CaptureRingKeepsNewestFrames) {
+    VirtualDisplay display(2, 2, RGB888);
+    display.setCaptureRing(3);
+
+    std::vector<uint32_t> checksums;
+    for (int i = 0; i < 5; ++i) {
+        std::vector<uint8_t> buffer(2 * 2 * 3, static_cast<uint8_t>(i));
+        display.setBuffer(buffer.data(), buffer.size(), RGB888, false);
+        checksums.push_back(display.checksum());
+    }
+
+    ASSERT_EQ(display.capturedFrames(), 3u);
+    for (size_t age = 0; age < 3; ++age) {
+        EXPECT_EQ(display.capturedFrame(age)[0], 4 - age);
+    }
+    EXPECT_NE(checksums[3], checksums[4]);
+}
+
+TEST(VirtualDisplay, WritesPpm) {
+    VirtualDisplay display(3, 2, RGB565_LE);
+    auto buffer = gradient(3, 2, RGB565_LE);
+    display.setBuffer(buffer.data(), buffer.size(), RGB565_LE, false);
+
+    std::string path = ::testing::TempDir() + "virtual_display.ppm";
+    ASSERT_TRUE(display.writePpm(path.c_str()));
+
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string header = "P6\n3 2\n255\n";
+    ASSERT_EQ(contents.size(), header.size() + 3 * 2 * 3);
+    EXPECT_EQ(contents.substr(0, header.size()), header);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,55 @@
+declare module "blit" {
+    import { Format } from "renderer";
+
+    export interface BlitImage {
+        buffer: ArrayBuffer;
+        width: number;
+        height: number;
+        /**
+         * Pixel format of the buffer, RGBA_8888 by default.
+         */
+        format?: Format;
+    }
+
+    export interface BlitOptions {
+        /** Left edge of the source rectangle. */
+        sx?: number;
+        /** Top edge of the source rectangle. */
+        sy?: number;
+        /** Width of the source rectangle, the whole source by default. */
+        sw?: number;
+        /** Height of the source rectangle, the whole source by default. */
+        sh?: number;
+
+        /** Destination x coordinate. */
+        x?: number;
+        /** Destination y coordinate. */
+        y?: number;
+        /** Destination width, nearest-neighbour scaled. Defaults to the source width times scale. */
+        width?: number;
+        /** Destination height, nearest-neighbour scaled. Defaults to the source height times scale. */
+        height?: number;
+        /** Integer scale used when no destination size is given. */
+        scale?: number;
+
+        /** Clockwise rotation in 90 degree steps. */
+        rotation?: number;
+        /** Mirror horizontally, applied after rotation. */
+        flipX?: boolean;
+        /** Mirror vertically, applied after rotation. */
+        flipY?: boolean;
+
+        /** Packed 24-bit RGB color of source pixels that are not copied. */
+        colorKey?: number;
+    }
+
+    /**
+     * Copy a rectangle between two buffers, converting the pixel format when they differ.
+     * The result is clipped to the destination.
+     * @param dst The destination image.
+     * @param src The source image.
+     * @param options The source rectangle, placement and transformation.
+     * @returns The number of destination pixels written.
+     */
+    function blit(dst: BlitImage, src: BlitImage, options?: BlitOptions): number;
+}
@@ -0,0 +1,134 @@
+declare module "draw" {
+    import { Color } from "shapes";
+    import { Font, Format } from "renderer";
+
+    /**
+     * Immediate-mode drawing directly into a packed framebuffer.
+     * Every call writes into the buffer right away and is clipped to the clip rectangle.
+     */
+    export class Canvas {
+        /**
+         * Create a canvas over an existing buffer.
+         * @param buffer The framebuffer, at least width * height * bytes per pixel long.
+         * @param width The framebuffer width in pixels.
+         * @param height The framebuffer height in pixels.
+         * @param format The pixel format of the buffer, RGBA_8888 by default.
+         */
+        constructor(buffer: ArrayBuffer, width: number, height: number, format?: Format);
+
+        /**
+         * Fill the clip rectangle with a color.
+         * @param color The fill color.
+         */
+        clear(color: Color): void;
+
+        /**
+         * Set a single pixel.
+         * @param x The x coordinate.
+         * @param y The y coordinate.
+         * @param color The pixel color.
+         */
+        pixel(x: number, y: number, color: Color): void;
+
+        /**
+         * Fill a rectangle.
+         * @param x The left edge.
+         * @param y The top edge.
+         * @param width The rectangle width.
+         * @param height The rectangle height.
+         * @param color The fill color.
+         */
+        fillRect(x: number, y: number, width: number, height: number, color: Color): void;
+
+        /**
+         * Draw a one pixel wide rectangle outline.
+         * @param x The left edge.
+         * @param y The top edge.
+         * @param width The rectangle width.
+         * @param height The rectangle height.
+         * @param color The outline color.
+         */
+        rect(x: number, y: number, width: number, height: number, color: Color): void;
+
+        /**
+         * Draw a horizontal line.
+         * @param x The starting x coordinate.
+         * @param y The y coordinate.
+         * @param length The line length in pixels.
+         * @param color The line color.
+         */
+        hline(x: number, y: number, length: number, color: Color): void;
+
+        /**
+         * Draw a vertical line.
+         * @param x The x coordinate.
+         * @param y The starting y coordinate.
+         * @param length The line length in pixels.
+         * @param color The line color.
+         */
+        vline(x: number, y: number, length: number, color: Color): void;
+
+        /**
+         * Draw a line between two points, both ends included.
+         * @param x0 The starting x coordinate.
+         * @param y0 The starting y coordinate.
+         * @param x1 The ending x coordinate.
+         * @param y1 The ending y coordinate.
+         * @param color The line color.
+         */
+        line(x0: number, y0: number, x1: number, y1: number, color: Color): void;
+
+        /**
+         * Draw a circle.
+         * @param x The center x coordinate.
+         * @param y The center y coordinate.
+         * @param radius The circle radius.
+         * @param color The circle color.
+         * @param fill Whether to fill the circle.
+         */
+        circle(x: number, y: number, radius: number, color: Color, fill?: boolean): void;
+
+        /**
+         * Copy a rectangle from a buffer in the same format as the canvas.
+         * @param src The source pixels.
+         * @param srcWidth The source width in pixels.
+         * @param srcHeight The source height in pixels.
+         * @param x The destination x coordinate.
+         * @param y The destination y coordinate.
+         * @param sx The left edge of the source rectangle, 0 by default.
+         * @param sy The top edge of the source rectangle, 0 by default.
+         * @param sw The width of the source rectangle, the whole source by default.
+         * @param sh The height of the source rectangle, the whole source by default.
+         */
+        blit(src: ArrayBuffer, srcWidth: number, srcHeight: number, x: number, y: number, sx?: number, sy?: number, sw?: number, sh?: number): void;
+
+        /**
+         * Draw text.
+         * @param text The text to draw.
+         * @param x The starting x coordinate.
+         * @param y The starting y coordinate.
+         * @param font The font to use, the default font when undefined.
+         * @param color The text color.
+         * @param wrap Whether to wrap lines to the canvas width.
+         */
+        text(text: string, x: number, y: number, font: Font | undefined, color: Color, wrap?: boolean): void;
+
+        /**
+         * Restrict all drawing to a rectangle.
+         * @param x The left edge.
+         * @param y The top edge.
+         * @param width The clip width.
+         * @param height The clip height.
+         */
+        setClip(x: number, y: number, width: number, height: number): void;
+
+        /**
+         * Allow drawing to the whole canvas again.
+         */
+        resetClip(): void;
+
+        getWidth(): number;
+        getHeight(): number;
+        getFormat(): Format;
+    }
+}
@@ -0,0 +1,50 @@
+declare module "eventloop" {
+    /**
+     * Get latency, run time and queue depth statistics of the event loop since the last reset.
+     * View the result as a Uint32Array and index it with EventStat. Every lane block holds the
+     * events run, the lane's high-water mark, the max wait and max run time in microseconds,
+     * followed by BUCKETS wait time buckets and BUCKETS run time buckets. Bucket 0 counts
+     * times below 1 us, bucket i times from 2^(i-1) to 2^i us and the last one everything longer.
+     * Every source block holds the events run, max wait and max run time of one event source
+     * named by getStatSources(), followed by its wait and run time buckets. The slow list holds
+     * the longest callbacks, each as run time in microseconds, lane index, start time in
+     * milliseconds since boot and the code address of the callback.
+     * @param buffer Optional buffer of at least EventStat.SIZE * 4 bytes to fill instead of allocating.
+     * @returns The filled buffer.
+     */
+    function getStats(buffer?: ArrayBuffer): ArrayBuffer;
+
+    /**
+     * Clear all collected statistics.
+     */
+    function resetStats(): void;
+
+    /**
+     * Names of the event sources with their own statistics, like "gpio", "motor" or "radio".
+     * Entry i describes the source block at EventStat.SOURCES + i * EventStat.SOURCE_FIELDS.
+     */
+    function getStatSources(): string[];
+
+    /**
+     * Publish the statistics on the device-link stats channel.
+     * @param intervalMs Minimum time between two records, 0 stops streaming.
+     */
+    function streamStats(intervalMs: number): void;
+
+    // Indices into the Uint32Array view of getStats()
+    export enum EventStat {
+        EVENTS = 0,
+        REALTIME = 1,
+        TIMER = 37,
+        NORMAL = 73,
+        BULK = 109,
+        LANE_FIELDS = 36,
+        BUCKETS = 16,
+        SOURCES = 145,
+        SOURCE_FIELDS = 35,
+        SOURCE_COUNT = 8,
+        SLOW = 425,
+        SLOW_FIELDS = 4,
+        SIZE = 457,
+    }
+}
@@ -0,0 +1,71 @@
+declare module "frame" {
+    interface FrameSchedulerOptions {
+        /** Target frames per second, 30 by default. */
+        fps?: number;
+        /**
+         * What to do when a frame finishes after the next frame was due.
+         * "skip" waits for the next free slot and counts the missed ones as dropped.
+         * "catch-up" runs the missed frames back to back, up to maxCatchUp of them.
+         * Defaults to "skip".
+         */
+        policy?: "skip" | "catch-up";
+        /** Missed frames run by the "catch-up" policy before the schedule is restarted. Defaults to 3. */
+        maxCatchUp?: number;
+    }
+
+    interface FrameSchedulerStats {
+        frames: number;
+        dropped: number;
+        lastJitterUs: number;
+        maxJitterUs: number;
+        avgJitterUs: number;
+        lastFrameUs: number;
+        maxFrameUs: number;
+    }
+
+    /**
+     * Frame callback.
+     * @param timestamp Start of the frame in milliseconds, with microsecond resolution.
+     * @param delta Milliseconds since the start of the previous frame, 0 for the first frame.
+     * @returns Optionally a promise, the next frame is not scheduled before it settles.
+     */
+    type FrameCallback = (timestamp: number, delta: number) => void | Promise<unknown>;
+
+    class FrameScheduler {
+        /**
+         * Create a scheduler that runs a frame callback at a target rate.
+         * A frame is only scheduled after the previous one completed.
+         * @param options Scheduler configuration.
+         */
+        constructor(options?: FrameSchedulerOptions);
+
+        /**
+         * Start calling the callback once per frame.
+         * @param callback The frame callback.
+         */
+        start(callback: FrameCallback): void;
+
+        /**
+         * Stop scheduling frames. A frame that is already running completes normally.
+         */
+        stop(): void;
+
+        isRunning(): boolean;
+
+        /**
+         * Change the target rate.
+         * @param fps Target frames per second.
+         */
+        setFps(fps: number): void;
+
+        /**
+         * Get jitter, frame time and dropped frame statistics.
+         */
+        getStats(): FrameSchedulerStats;
+
+        /**
+         * Reset the statistics.
+         */
+        resetStats(): void;
+    }
+}
@@ -8,7 +8,15 @@ declare module "gpio" {
     };
 
     interface EventInfo {
+        /**
+         * Time of the edge, taken in the interrupt.
+         */
         timestamp: Timestamp;
+
+        /**
+         * Level of the pin read right after the edge (0 or 1).
+         */
+        level: number;
     }
 
     /**
@@ -40,10 +48,42 @@ declare module "gpio" {
      */
     function on(event: "rising" | "falling" | "change", pin: number, callback: (info: EventInfo) => void): void;
 
+    interface BatchOptions {
+        /**
+         * Deliver the edges in batches instead of one callback per edge.
+         */
+        batched: true;
+
+        /**
+         * Maximum number of callbacks per second (default 50).
+         */
+        maxRate?: number;
+    }
+
+    /**
+     * Set a batched event handler for the given pin. Edges are collected natively and
+     * delivered at most maxRate times per second. Only one batched handler per pin is allowed.
+     * @param event The event to handle.
+     * @param pin The pin to handle the event for.
+     * @param callback Called with (timestamp, level) pairs, the timestamp in microseconds
+     *                 since boot taken in the interrupt, and the number of edges lost
+     *                 since the previous call.
+     * @param options Batching options.
+     */
+    function on(event: "rising" | "falling" | "change", pin: number, callback: (edges: Float64Array, dropped: number) => void, options: BatchOptions): void;
+
     /**
      * Remove event handler for the given pin.
      * @param event The event to remove.
      * @param pin The pin to remove the event handler for.
      */
     function off(event: "rising" | "falling" | "change", pin: number): void;
+
+    /**
+     * Get the number of edges lost because the edge queue was full. Batched handlers
+     * receive their own count with every call instead.
+     * @param pin The pin to get the count for.
+     * @returns The number of edges lost since the first event handler of the pin was set.
+     */
+    function droppedEdges(pin: number): number;
 }
@@ -2,13 +2,72 @@ declare module "hub75" {
     type Pixel = [number, number, number, number, number, number];
     type Pixels = Pixel[];
 
+    /**
+     * Layout of packed pixel records, colors are 0xRRGGBB
+     * - "index": [y * width + x, color]
+     * - "xy": [x, y, color]
+     */
+    type PixelRecordLayout = "index" | "xy";
+
+    interface DisplayLayout {
+        width: number;
+        height: number;
+        /** Pixel format the panel consumes without conversion */
+        format: number;
+        /** Bytes per row */
+        stride: number;
+    }
+
+    interface Hub75Pins {
+        r1?: number; g1?: number; b1?: number;
+        r2?: number; g2?: number; b2?: number;
+        a?: number; b?: number; c?: number; d?: number;
+        /** Required for panels taller than 32 rows */
+        e?: number;
+        lat?: number; oe?: number; clk?: number;
+    }
+
+    interface Hub75Options {
+        /** Bit planes per channel, 1 to 12, default 8 */
+        depth?: number;
+        /** Default 2.2 */
+        gamma?: number;
+        /** Shift clock, default 10 MHz */
+        clockHz?: number;
+        pins?: Hub75Pins;
+    }
+
+    /**
+     * HUB75 panel chain driven natively over DMA. Only one instance can exist at a time.
+     * Available on targets with an i80 LCD peripheral (ESP32, ESP32-S3), not on ESP32-C3.
+     * Chained panels are placed left to right in the frame.
+     */
     class Hub75 {
-        constructor(panelWidth?: number, panelHeight?: number, chainLength?: number);
+        constructor(panelWidth?: number, panelHeight?: number, chainLength?: number, options?: Hub75Options);
 
+        /**
+         * Buffers in the native format and stride are passed through without conversion
+         */
+        getLayout(): DisplayLayout;
         setBuffer(buffer: ArrayBuffer, size?: number, format?: number, clearPrev?: boolean): void;
+        /**
+         * Keep a shadow of the last full-frame setBuffer and send only the changed
+         * regions. A full frame is sent when more than threshold (default 0.5) of
+         * the pixels changed, or when the format changes.
+         */
+        setDeltaMode(enabled: boolean, threshold?: number): void;
         setBufferRaw(pixels: Pixels, format?: number, clearPrevious?: boolean): void;
+        /**
+         * Sparse update from packed records, read in place without copying.
+         * Records outside of the panel are skipped.
+         */
+        setPixels(records: Uint32Array | ArrayBuffer, layout?: PixelRecordLayout, clearPrevious?: boolean): void;
         clear(): void;
         setBrightness(brightness: number): void;
         isInitialized(): boolean;
+        /** Change the gamma curve, the frame currently shown is re-encoded with it */
+        setGamma(gamma: number): void;
+        /** Stop refreshing the panel */
+        close(): void;
     }
 }
@@ -0,0 +1,63 @@
+declare module "i80tft" {
+    type Pixel = [number, number, number, number, number, number];
+    type Pixels = Pixel[];
+    type PixelRecordLayout = "index" | "xy";
+
+    interface DisplayLayout {
+        width: number;
+        height: number;
+        /** Pixel format of the framebuffer, RGB565 big-endian on 8-bit buses, little-endian on 16-bit */
+        format: number;
+        /** Bytes per row */
+        stride: number;
+    }
+
+    interface I80TftOptions {
+        /** Default "st7789" */
+        controller?: "st7789" | "ili9341";
+        /** Size at rotation 0, default 240x320 */
+        width?: number;
+        height?: number;
+        /** 0 to 3, quarter turns */
+        rotation?: number;
+        /** Offset of the visible area in the controller RAM */
+        colOffset?: number;
+        rowOffset?: number;
+        invert?: boolean;
+        bgr?: boolean;
+
+        /** 8 or 16 data pins, D0 first */
+        data: number[];
+        wr: number;
+        dc: number;
+        cs?: number;
+        /** Held high, reads are not used */
+        rd?: number;
+        rst?: number;
+        /** Backlight, switched off at brightness 0 */
+        bl?: number;
+        /** Tearing effect output of the panel, updates start at vertical blanking */
+        te?: number;
+        /** Default 20 MHz */
+        clockHz?: number;
+        /** Size of each internal DMA bounce buffer in bytes, default 16384 */
+        bounceSize?: number;
+    }
+
+    /**
+     * MIPI-DBI panel (ST7789, ILI9341) on a parallel i80 bus. The framebuffer
+     * lives in PSRAM and only the updated window is sent. Available on ESP32-S3 only.
+     */
+    class I80Tft {
+        constructor(options: I80TftOptions);
+
+        getLayout(): DisplayLayout;
+        setBuffer(buffer: ArrayBuffer, size?: number, format?: number, clearPrev?: boolean): void;
+        setDeltaMode(enabled: boolean, threshold?: number): void;
+        setBufferRaw(pixels: Pixels, format?: number, clearPrevious?: boolean): void;
+        setPixels(records: Uint32Array | ArrayBuffer, layout?: PixelRecordLayout, clearPrevious?: boolean): void;
+        clear(): void;
+        setBrightness(brightness: number): void;
+        isInitialized(): boolean;
+    }
+}
@@ -0,0 +1,92 @@
+declare module "presenter" {
+    import { SPI } from "spi";
+
+    interface FramePresenterOptions {
+        /** Chip-select pin. */
+        cs: number;
+        /** Frame width in pixels. */
+        width: number;
+        /** Frame height in pixels. */
+        height: number;
+        /** Pixel format of the frames, RGBA_8888 by default. */
+        format?: number;
+        /** Number of frame buffers, 2 to 4. Defaults to 2. */
+        buffers?: number;
+        /** Whether to use quad SPI mode. */
+        qio?: boolean;
+        /**
+         * Framing sent around each frame. "hub75-bridge" prepends the sync
+         * words and modeset header expected by the RP2040 HUB75 bridge.
+         */
+        framing?: "raw" | "hub75-bridge";
+        /** Brightness sent in the hub75-bridge modeset header. */
+        brightness?: number;
+        /** Upper limit of transmitted frames per second. */
+        fps?: number;
+        /** Drop queued frames that did not start transmitting when a newer one is presented. Defaults to true. */
+        dropStale?: boolean;
+    }
+
+    interface FramePresenterStats {
+        presented: number;
+        transmitted: number;
+        dropped: number;
+        errors: number;
+        lastTxUs: number;
+        maxTxUs: number;
+        avgTxUs: number;
+        lastIntervalUs: number;
+        maxIntervalUs: number;
+    }
+
+    class FramePresenter {
+        /**
+         * Create a presenter transmitting frames over an already configured SPI bus
+         * from a separate task. The presenter owns the bus while it is open.
+         * @param spi The SPI bus to send frames on.
+         * @param options Presenter configuration.
+         */
+        constructor(spi: SPI, options: FramePresenterOptions);
+
+        /**
+         * Get a free back buffer to render into.
+         * @returns A promise resolved once a buffer is no longer in flight.
+         */
+        acquire(): Promise<ArrayBuffer>;
+
+        /**
+         * Queue an acquired buffer for transmission. The buffer must not be
+         * touched until it is returned by acquire() again.
+         * @param buffer The buffer returned by acquire().
+         * @param size Number of bytes to send, the whole buffer by default.
+         */
+        present(buffer: ArrayBuffer, size?: number): void;
+
+        /**
+         * Return an acquired buffer without presenting it.
+         * @param buffer The buffer returned by acquire().
+         */
+        release(buffer: ArrayBuffer): void;
+
+        /**
+         * Set the brightness sent in the hub75-bridge modeset header.
+         * @param brightness The brightness (0-255).
+         */
+        setBrightness(brightness: number): void;
+
+        /**
+         * Get frame pacing and drop statistics.
+         */
+        getStats(): FramePresenterStats;
+
+        /**
+         * Reset the statistics.
+         */
+        resetStats(): void;
+
+        /**
+         * Stop the transmit task. Pending acquire() promises are rejected.
+         */
+        close(): void;
+    }
+}
@@ -48,5 +48,41 @@ declare module "raycaster" {
             weaponFrame: number,
             format: number,
         ): number;
+
+        /**
+         * Get timing and counter statistics of the last rendered frame.
+         * View the result as a Uint32Array and index it with RaycasterStat; each stage holds the
+         * last, min, avg and max time in microseconds over the last 32 frames.
+         * Floor and ceiling are drawn in the same column pass as walls, so they are timed under WALLS.
+         * @param buffer Optional buffer of at least RaycasterStat.SIZE * 4 bytes to fill instead of allocating.
+         * @returns The filled buffer.
+         */
+        getStats(buffer?: ArrayBuffer): ArrayBuffer;
+
+        /**
+         * Clear all collected statistics.
+         */
+        resetStats(): void;
+
+        /**
+         * Publish the statistics of every rendered frame on the device-link stats channel.
+         * @param enable Whether to stream the statistics.
+         */
+        streamStats(enable: boolean): void;
+    }
+
+    // Indices into the Uint32Array view of Raycaster.getStats(). Stage entries are followed by min, avg and max.
+    export enum RaycasterStat {
+        FRAMES = 0,
+        WALLS = 1,
+        SPRITES = 5,
+        WEAPON = 9,
+        TOTAL = 13,
+        WALL_PIXELS = 17,
+        FLOOR_PIXELS = 18,
+        SPRITE_COUNT = 19,
+        SPRITE_PIXELS = 20,
+        WEAPON_PIXELS = 21,
+        SIZE = 22,
     }
 }
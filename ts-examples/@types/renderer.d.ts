@@ -1,5 +1,5 @@
 declare module "shapes" {
-    import { Texture } from "renderer";
+    import { Format, Texture } from "renderer";
     // Packed 24-bit RGB, e.g. 0xff0000 for red.
     export type Color = number;
 
@@ -301,10 +301,222 @@ declare module "shapes" {
         setColor(color: Color): void;
         getColor(): Color;
     }
+
+    export interface StaticLayerParams {
+        /** Width of the cached layer in pixels, may exceed the renderer width for scrolling. */
+        width: number;
+        /** Height of the cached layer in pixels. */
+        height: number;
+        /** Repeat the layer when scrolled past its edges, false by default. */
+        wrap?: boolean;
+        /** Keep pixels below the layer where no shape was drawn, false by default. Opaque layers are a plain copy. */
+        transparent?: boolean;
+    }
+
+    /**
+     * Shapes rasterized once into a cached buffer and copied into every frame below all other content.
+     * Attach it with Renderer.addLayer. The cache is rebuilt when a shape added to the layer is changed;
+     * changes to shapes nested inside an added Collection need an explicit invalidate().
+     */
+    export class StaticLayer {
+        constructor(params: StaticLayerParams);
+
+        add(shape: Shape): void;
+        remove(shape: Shape): void;
+        clear(): void;
+
+        /**
+         * Rebuild the cache before the next render.
+         */
+        invalidate(): void;
+
+        /**
+         * Set the layer pixel shown at the top-left corner of the frame.
+         */
+        setScroll(x: number, y: number): void;
+
+        /**
+         * Move the scroll offset, wrapped to the layer size when wrapping is enabled.
+         */
+        scroll(dx: number, dy: number): void;
+
+        getScrollX(): number;
+        getScrollY(): number;
+
+        setVisible(visible: boolean): void;
+    }
+
+    export interface TileMapParams {
+        x?: number;
+        y?: number;
+        columns: number;
+        rows: number;
+        tileWidth: number;
+        tileHeight: number;
+    }
+
+    /**
+     * A grid of tiles drawn as one object. Attach it with Renderer.addTileMap; it is drawn below all shapes.
+     */
+    export class TileMap {
+        constructor(params: TileMapParams);
+
+        /**
+         * Set the tile index of one cell.
+         * @param column The cell column.
+         * @param row The cell row.
+         * @param tile The tile index.
+         */
+        setCell(column: number, row: number, tile: number): void;
+
+        /**
+         * Get the tile index of one cell.
+         * @returns The tile index, -1 outside the map.
+         */
+        getCell(column: number, row: number): number;
+
+        /**
+         * Set every cell to the same tile.
+         * @param tile The tile index.
+         */
+        fill(tile: number): void;
+
+        /**
+         * Copy all cells at once, row by row, without reallocating.
+         * @param cells The tile indices.
+         */
+        setCells(cells: Uint8Array | Uint16Array): void;
+
+        /**
+         * Use solid colors as the tileset, indexed by tile.
+         * @param colors The color of each tile.
+         */
+        setTileColors(colors: Color[]): void;
+
+        /**
+         * Use an image as the tileset. Tiles are cut row by row in tileWidth x tileHeight steps.
+         * @param buffer The atlas pixels.
+         * @param width The atlas width in pixels.
+         * @param height The atlas height in pixels.
+         * @param format The atlas pixel format, RGBA_8888 by default.
+         */
+        setTileAtlas(buffer: ArrayBuffer, width: number, height: number, format?: Format): void;
+
+        /**
+         * Set a tile index that is not drawn, leaving the background visible.
+         * @param tile The tile index, -1 to draw every tile.
+         */
+        setEmptyTile(tile: number): void;
+
+        /**
+         * Set the position of the top-left corner.
+         */
+        setPosition(x: number, y: number): void;
+
+        setVisible(visible: boolean): void;
+    }
+
+    export interface ParticleSystemParams {
+        /** Maximum number of live particles. */
+        capacity: number;
+        /** How each particle is drawn, "point" by default. Square and circle use the particle size. */
+        shape?: "point" | "square" | "circle";
+        /** Length of one update step in seconds, 1/60 by default. */
+        fixedStep?: number;
+    }
+
+    export interface ParticleEmitParams {
+        x?: number;
+        y?: number;
+        /** Velocity in pixels per second. */
+        vx?: number;
+        vy?: number;
+        /** Acceleration in pixels per second squared. */
+        ax?: number;
+        ay?: number;
+        /** Seconds to live, 0 to live until killed. */
+        life?: number;
+        /** Packed 24-bit RGB color, white by default. */
+        color?: number;
+        /** Size in pixels, 1 by default. */
+        size?: number;
+        /** Random spread added to each velocity component. */
+        velocityJitter?: number;
+        /** Random spread added to life. */
+        lifeJitter?: number;
+    }
+
+    export type ParticleField = "x" | "y" | "vx" | "vy" | "ax" | "ay" | "life" | "size" | "color";
+
+    /**
+     * Particles integrated natively. Attach it with Renderer.addParticles; it is drawn above all shapes.
+     * Live particles always occupy indices 0 to getCount() - 1, killing one moves the last particle into its slot.
+     */
+    export class ParticleSystem {
+        constructor(params: ParticleSystemParams);
+
+        /**
+         * Add particles.
+         * @param params The initial state of the particles.
+         * @param count The number of particles, 1 by default.
+         * @returns The index of the first new particle, -1 if the system is full.
+         */
+        emit(params: ParticleEmitParams, count?: number): number;
+
+        kill(index: number): void;
+        clear(): void;
+
+        /**
+         * Integrate a single step.
+         * @param dt The step length in seconds.
+         */
+        step(dt: number): void;
+
+        /**
+         * Advance by elapsed time in fixed steps.
+         * @param elapsed Seconds since the last update.
+         * @param maxSteps Upper bound of steps taken, 8 by default. Leftover time is dropped.
+         * @returns The number of steps taken.
+         */
+        update(elapsed: number, maxSteps?: number): number;
+
+        /**
+         * Set what happens to particles leaving a rectangle.
+         * @param mode "wrap" to the opposite edge, "clamp" to the edge, "kill" the particle or "none".
+         * A negative width or height extends the rectangle left or up.
+         * @throws RangeError if the rectangle is not finite.
+         */
+        setBounds(mode: "none" | "wrap" | "clamp" | "kill", x: number, y: number, width: number, height: number): void;
+
+        setShape(shape: "point" | "square" | "circle"): void;
+
+        /**
+         * Seed the generator used for jitter.
+         */
+        seed(seed: number): void;
+
+        setPosition(index: number, x: number, y: number): void;
+        setVelocity(index: number, vx: number, vy: number): void;
+
+        getCount(): number;
+        getCapacity(): number;
+
+        /**
+         * Read one field of every live particle. View the result as Float32Array,
+         * or Uint32Array for "color" and "size".
+         * @returns A new buffer with getCount() values.
+         */
+        read(field: ParticleField): ArrayBuffer;
+        /**
+         * Read one field into an existing buffer without allocating.
+         * @returns The number of values written.
+         */
+        read(field: ParticleField, buffer: ArrayBuffer): number;
+    }
 }
 
 declare module "renderer" {
-    import { Collection, Color } from "shapes";
+    import { Collection, Color, ParticleSystem, StaticLayer, TileMap } from "shapes";
 
     export class Texture {
         constructor();
@@ -365,7 +577,95 @@ declare module "renderer" {
     }
 
     export class Renderer {
-        constructor(width: number, height: number);
+        /**
+         * Create a renderer.
+         * @param width The output width in pixels.
+         * @param height The output height in pixels.
+         * @param bandHeight Optional number of rows rasterized at once. When smaller than height, only a
+         * width x bandHeight grid is kept in memory and frames up to 2048x2048 are allowed.
+         * @param palette Optional palette that keeps the frame as one byte per pixel. Pass true for a fixed
+         * RGB 3:3:2 palette or up to 256 colors. Rasterization then runs in bands of 16 rows by default,
+         * each pixel is mapped to the nearest palette entry and antialiased edges blend towards black.
+         */
+        constructor(width: number, height: number, bandHeight?: number, palette?: boolean | Color[]);
+
+        /**
+         * Replace the palette of an indexed renderer.
+         * @param colors Up to 256 colors, omit for the fixed RGB 3:3:2 palette.
+         */
+        setPalette(colors?: Color[]): void;
+
+        /**
+         * @returns Whether the renderer was created with a palette.
+         */
+        isIndexed(): boolean;
+
+        /**
+         * Rasterize every other band on a worker pinned to the second core, while this thread
+         * rasterizes the rest. Layers, tile maps and particles of both bands are drawn in
+         * parallel, shapes one band at a time. Costs one more band grid. A renderer without
+         * bands is split into two halves, so rotation then requires a palette.
+         * Bands are delivered in order on the calling thread once both bands of a pair are done.
+         * @param enable Whether to use the worker.
+         */
+        setParallel(enable: boolean): void;
+
+        isParallel(): boolean;
+
+        /**
+         * Get the number of rows rasterized at once.
+         * @returns The band height, equal to the renderer height when band mode is off.
+         */
+        getBandHeight(): number;
+
+        /**
+         * Composite a cached layer below the tile maps and shapes of every rendered scene.
+         * Layers are drawn in the order they were added.
+         * @param layer The layer to add.
+         */
+        addLayer(layer: StaticLayer): void;
+
+        /**
+         * Stop drawing a cached layer.
+         * @param layer The layer to remove.
+         */
+        removeLayer(layer: StaticLayer): void;
+
+        /**
+         * Draw a tile map below the shapes of every rendered scene.
+         * @param tileMap The tile map to add.
+         */
+        addTileMap(tileMap: TileMap): void;
+
+        /**
+         * Stop drawing a tile map.
+         * @param tileMap The tile map to remove.
+         */
+        removeTileMap(tileMap: TileMap): void;
+
+        /**
+         * Draw a particle system above the shapes of every rendered scene.
+         * @param particles The particle system to add.
+         */
+        addParticles(particles: ParticleSystem): void;
+
+        /**
+         * Stop drawing a particle system.
+         * @param particles The particle system to remove.
+         */
+        removeParticles(particles: ParticleSystem): void;
+
+        /**
+         * Render a scene band by band and hand each packed strip to the callback.
+         * The strip buffer is reused for every band, so the callback must consume it before returning.
+         * @param scene The collection to render.
+         * @param strip Buffer for one band, at least width * bandHeight * bytes per pixel long.
+         * @param callback Called with the strip, its first row, row count and the number of valid bytes.
+         * @param antialias Whether to enable antialiasing.
+         * @param format The output pixel format.
+         * @returns The total number of bytes produced.
+         */
+        renderBands(scene: Collection, strip: ArrayBuffer, callback: (strip: ArrayBuffer, y: number, rows: number, size: number) => void, antialias?: boolean, format?: Format): number;
 
         /**
          * Render a scene into the provided buffer.
@@ -373,7 +673,7 @@ declare module "renderer" {
          * @param buffer The output pixel buffer.
          * @param antialias Whether to enable antialiasing.
          * @param format The output pixel format.
-         * @param rotation Rotates the whole image by 90 degree increments.
+         * @param rotation Rotates the whole image by 90 degree increments. Not supported in band mode unless indexed.
          * @returns The number of bytes written.
          */
         render(scene: Collection, buffer: ArrayBuffer, antialias?: boolean, format?: Format, rotation?: number): number;
@@ -392,6 +692,42 @@ declare module "renderer" {
          * @returns The number of bytes written.
          */
         drawText(buffer: ArrayBuffer, text: string, x: number, y: number, font: Font, color: Color, wrap: boolean, format?: Format, rotation?: number): number;
+
+        /**
+         * Get timing and counter statistics of the last completed frame. A frame spans from one
+         * render() or renderBands() call to the next, including any drawText() in between.
+         * View the result as a Uint32Array and index it with RenderStat; each stage holds the
+         * last, min, avg and max time in microseconds over the last 32 frames.
+         * @param buffer Optional buffer of at least RenderStat.SIZE * 4 bytes to fill instead of allocating.
+         * @returns The filled buffer.
+         */
+        getStats(buffer?: ArrayBuffer): ArrayBuffer;
+
+        /**
+         * Clear all collected statistics.
+         */
+        resetStats(): void;
+
+        /**
+         * Publish the statistics of every completed frame on the device-link stats channel.
+         * @param enable Whether to stream the statistics.
+         */
+        streamStats(enable: boolean): void;
+    }
+
+    // Indices into the Uint32Array view of Renderer.getStats(). Stage entries are followed by min, avg and max.
+    export enum RenderStat {
+        FRAMES = 0,
+        CLEAR = 1,
+        RASTERIZE = 5,
+        PACK = 9,
+        TEXT = 13,
+        TOTAL = 17,
+        BANDS = 21,
+        PACKED_PIXELS = 22,
+        TEXT_PIXELS = 23,
+        LAYER_REBUILDS = 24,
+        SIZE = 25,
     }
 
     // https://419.ecma-international.org/3.0/index.html#-15-display-class-pattern-pixel-format-values
@@ -0,0 +1,58 @@
+declare module "tft" {
+    type Pixel = [number, number, number, number, number, number];
+    type Pixels = Pixel[];
+    type PixelRecordLayout = "index" | "xy";
+
+    interface DisplayLayout {
+        width: number;
+        height: number;
+        /** Pixel format the panel consumes without conversion, RGB565 big-endian */
+        format: number;
+        /** Bytes per row */
+        stride: number;
+    }
+
+    interface TftOptions {
+        /** Default "st7789" */
+        controller?: "st7789" | "ili9341";
+        /** Size at rotation 0, default 240x320 */
+        width?: number;
+        height?: number;
+        /** 0 to 3, quarter turns */
+        rotation?: number;
+        /** Offset of the visible area in the controller RAM */
+        colOffset?: number;
+        rowOffset?: number;
+        invert?: boolean;
+        bgr?: boolean;
+
+        /** SPI host, default SPI2 */
+        host?: number;
+        sck: number;
+        mosi: number;
+        cs: number;
+        dc: number;
+        rst?: number;
+        /** Backlight, switched off at brightness 0 */
+        bl?: number;
+        /** Default 40 MHz */
+        baud?: number;
+    }
+
+    /**
+     * MIPI-DBI SPI panel (ST7789, ILI9341) driven natively with queued DMA.
+     * Delta mode sends only the changed rectangles through address windows.
+     */
+    class Tft {
+        constructor(options: TftOptions);
+
+        getLayout(): DisplayLayout;
+        setBuffer(buffer: ArrayBuffer, size?: number, format?: number, clearPrev?: boolean): void;
+        setDeltaMode(enabled: boolean, threshold?: number): void;
+        setBufferRaw(pixels: Pixels, format?: number, clearPrevious?: boolean): void;
+        setPixels(records: Uint32Array | ArrayBuffer, layout?: PixelRecordLayout, clearPrevious?: boolean): void;
+        clear(): void;
+        setBrightness(brightness: number): void;
+        isInitialized(): boolean;
+    }
+}
@@ -0,0 +1,48 @@
+import { Format } from './constants.js';
+
+// Compares the nested array upload (setBufferRaw) with packed records (setPixels).
+// Works with any display binding, e.g. displayBench(new Tft({...}), 240, 320)
+
+type Pixel = [number, number, number, number, number, number];
+
+interface PixelSink {
+    setBufferRaw(pixels: Pixel[], format?: number, clearPrevious?: boolean): void;
+    setPixels(records: Uint32Array, layout?: "index" | "xy", clearPrevious?: boolean): void;
+}
+
+const ITERATIONS = 50;
+const PIXEL_COUNTS = [64, 512, 4096];
+
+function bench(name: string, pixels: number, upload: () => void) {
+    const start = Date.now();
+    for (let i = 0; i < ITERATIONS; i++) {
+        upload();
+    }
+    const perCall = (Date.now() - start) / ITERATIONS;
+    console.log(`${name} ${pixels} px: ${perCall.toFixed(2)} ms/frame`);
+}
+
+export function displayBench(display: PixelSink, width: number, height: number) {
+    for (const count of PIXEL_COUNTS) {
+        const nested: Pixel[] = [];
+        const indexed = new Uint32Array(count * 2);
+        const xy = new Uint32Array(count * 3);
+
+        for (let i = 0; i < count; i++) {
+            const x = (i * 7) % width;
+            const y = Math.floor(i / width) % height;
+            const color = (i * 0x010203) & 0xffffff;
+
+            nested.push([x, y, color >> 16, (color >> 8) & 0xff, color & 0xff, 0xff]);
+            indexed[i * 2] = y * width + x;
+            indexed[i * 2 + 1] = color;
+            xy[i * 3] = x;
+            xy[i * 3 + 1] = y;
+            xy[i * 3 + 2] = color;
+        }
+
+        bench("setBufferRaw", count, () => display.setBufferRaw(nested, Format.RGBA_8888, true));
+        bench("setPixels index", count, () => display.setPixels(indexed, "index", true));
+        bench("setPixels xy", count, () => display.setPixels(xy, "xy", true));
+    }
+}